@@ -10,6 +10,9 @@
 #include <math.h>
 #include <stdarg.h>
 #include <assert.h>
+#include "readSequence.h"
+#include "writeBehind.h"
+#include "nodePerf.h"
 
 #define CHECK_ALL_ITEMS(array, iter, status, label) { \
     status = VX_SUCCESS; \
@@ -61,6 +64,7 @@ vx_status vx_test_graph_accum(int argc, char *argv[]) {
   char filename[PATH_MAX];
   
   if (vxGetStatus((vx_reference)context) == VX_SUCCESS) {
+    struct node_perf_report *report = createNodePerfReport(context);
 
     vx_uint32 i = 0, w_in = 1080, h_in = 1920;  // index and input image size
     int scale = 4;  // image size scale
@@ -74,8 +78,12 @@ vx_status vx_test_graph_accum(int argc, char *argv[]) {
 
     int w = w_in/scale;  // scaled image width
     int h = h_in/scale;  // scaled image height
+
+    // Input frames are decoded ahead on a worker thread
+    sprintf(filename, "%s/%s/pgm/%s %%04d.pgm", viddir, basename, basename);
+    struct read_sequence *sequence = openReadSequence(context, filename, 1, 8, NULL);
     vx_image images[] = {
-      vxCreateImage(context, w_in, h_in, VX_DF_IMAGE_U8),  // 0. input
+      sequence ? getReadSequenceImage(sequence) : NULL,    // 0. input
       vxCreateImage(context, w, h, VX_DF_IMAGE_S16),       // 1. accum
       vxCreateImage(context, w, h, VX_DF_IMAGE_U8),        // 2. accum weighted
       vxCreateImage(context, w, h, VX_DF_IMAGE_S16),       // 3. accum squared
@@ -125,12 +133,12 @@ vx_status vx_test_graph_accum(int argc, char *argv[]) {
       vx_graph graph = vxCreateGraph(context);
       if (vxGetStatus((vx_reference)graph) == VX_SUCCESS) {
 	vx_node nodes[] = {
-	  vxScaleImageNode(graph, images[0], images[4], INTERP),
+	  addNodeToPerfReport(report, "bg", vxScaleImageNode(graph, images[0], images[4], INTERP)),
 	  //	  vxAccumulateImageNode(graph, images[4], images[1]),
-	  vxAccumulateWeightedImageNode(graph, images[4], scalars[0], images[2]),
+	  addNodeToPerfReport(report, "bg", vxAccumulateWeightedImageNode(graph, images[4], scalars[0], images[2])),
 	  //	  vxAccumulateSquareImageNode(graph, images[4], scalars[1], images[3]),
-	  vxAbsDiffNode(graph, images[2], images[4], images[5]),
-	  vxThresholdNode(graph, images[5], thresh2, images[14]),
+	  addNodeToPerfReport(report, "bg", vxAbsDiffNode(graph, images[2], images[4], images[5])),
+	  addNodeToPerfReport(report, "bg", vxThresholdNode(graph, images[5], thresh2, images[14])),
 	  //	  vxMedian3x3Node(graph, images[14], images[15]),
 
 	  //	  vxMultiplyNode(graph, images[5], images[9], scalars[2], VX_CONVERT_POLICY_SATURATE,
@@ -144,22 +152,26 @@ vx_status vx_test_graph_accum(int argc, char *argv[]) {
 	  /* vxDilate3x3Node(graph, images[11], images[12]), */
 	  /* vxErode3x3Node(graph, images[12], images[13]), */
 
-	  vxMedian3x3Node(graph, images[14], images[17]),
-	  vxDilate3x3Node(graph, images[17], images[18]),
-	  vxErode3x3Node(graph, images[18], images[19]),
+	  addNodeToPerfReport(report, "bg", vxMedian3x3Node(graph, images[14], images[17])),
+	  addNodeToPerfReport(report, "bg", vxDilate3x3Node(graph, images[17], images[18])),
+	  addNodeToPerfReport(report, "bg", vxErode3x3Node(graph, images[18], images[19])),
 	};
 	CHECK_ALL_ITEMS(nodes, i, status, exit);
 	if (status == VX_SUCCESS) {
 	  // Verify the graph
 	  status = vxVerifyGraph(graph);
 	  if (status == VX_SUCCESS) {
-	    // Start the processing loop
+	    // Start the processing loop, writing results on a background thread
+	    struct write_behind *sink = openWriteBehind(16, WRITE_BEHIND_BLOCK);
+	    if (!sink) {
+	      printf("Can't start the output writer!!!\n");
+	      status = VX_ERROR_NO_RESOURCES;
+	    }
 	    int framenum = 1;
 	    while (status == VX_SUCCESS) {
 
 	      // Read the input image
-	      sprintf(filename, "%s/%s/pgm/%s %04d.pgm", viddir, basename, basename, framenum);
-	      if (vxuFReadImage(context, filename, images[0]) != VX_SUCCESS) {
+	      if (readNextInSequence(sequence, NULL) != VX_SUCCESS) {
 		printf("Finished after %d frames\n", framenum-1);
 		break;
 	      }
@@ -177,6 +189,7 @@ vx_status vx_test_graph_accum(int argc, char *argv[]) {
 	      /* } */
 	      // GO!
 	      status = vxProcessGraph(graph);
+	      sampleNodePerfReport(report);
 
 	      // Write the output results
 	      //	      sprintf(filename, "%s/%s/out/o%saccu_16b %04d.pgm", viddir, basename, basename, framenum);
@@ -194,11 +207,12 @@ vx_status vx_test_graph_accum(int argc, char *argv[]) {
 	      //	      sprintf(filename, "%s/%s/out/o%sthrs_8b %04d.pgm", viddir, basename, basename, framenum);
 	      //	      vxuFWriteImage(context, images[13], filename);  // median
 	      sprintf(filename, "%s/%s/out/o%sthr2_8b %04d.pgm", viddir, basename, basename, framenum);
-	      vxuFWriteImage(context, images[14], filename);  // diff image
+	      writeImageBehind(sink, images[14], filename);  // diff image
 	      sprintf(filename, "%s/%s/out/o%smorp_8b %04d.pgm", viddir, basename, basename, framenum);
-	      vxuFWriteImage(context, images[18], filename);  // after morphology
+	      writeImageBehind(sink, images[18], filename);  // after morphology
 	      framenum++;
 	    }
+	    closeWriteBehind(&sink);
 	  }
 	  else {
 	    printf("Can't verify graph!!!\n");
@@ -220,6 +234,9 @@ vx_status vx_test_graph_accum(int argc, char *argv[]) {
     for (i = 0; i < dimof(scalars); i++) vxReleaseScalar(&scalars[i]);
 
   exit:
+    closeReadSequence(&sequence);
+    printNodePerfReport(report);
+    releaseNodePerfReport(&report);
     vxReleaseContext(&context);
   }
   return status;
@@ -10,23 +10,31 @@
 #include <math.h>
 #include <stdarg.h>
 #include <assert.h>
+#include "readSequence.h"
+#include "writeBehind.h"
+#include "nodePerf.h"
 
 #define PATH_MAX 4096
 
 char *viddir = "/mnt/c/Users/Frank/Documents/piper-video";
 char *basefname = "piper01";
 char filename[PATH_MAX];
+struct write_behind *sink;  // Writes output images on a background thread
 
-int myCaptureImage(vx_context context, vx_image image, int framenum) {
-  sprintf(filename, "%s/%s/pgm/%s %04d.pgm", viddir, basefname, basefname, framenum);
-  if (framenum == 1)
-    printf("Beginning processing %s/%s\n", viddir, basefname);
-  return vxuFReadImage(context, filename, image);
+struct read_sequence *myOpenCapture(vx_context context) {
+  // Frames are decoded ahead on a worker thread so the graph does not wait for the disk
+  sprintf(filename, "%s/%s/pgm/%s %%04d.pgm", viddir, basefname, basefname);
+  printf("Beginning processing %s/%s\n", viddir, basefname);
+  return openReadSequence(context, filename, 1, 8, NULL);
+}
+
+int myCaptureImage(struct read_sequence *sequence, int *framenum) {
+  return readNextInSequence(sequence, framenum);
 }
 
 int myDisplayImage(vx_context context, vx_image image, char *suffix, int framenum) {
   sprintf(filename, "%s/%s/out/%s_%s %04d.pgm", viddir, basefname, basefname, suffix, framenum);
-  vxuFWriteImage(context, image, filename);
+  return writeImageBehind(sink, image, filename);
 }
 
 int main(int argc, char *argv[])
@@ -44,9 +52,27 @@ int main(int argc, char *argv[])
 
   vxLoadKernels(context, "openvx-debug");  // For reading and writing images
 
+  struct node_perf_report *report = createNodePerfReport(context);
   vx_graph graph = vxCreateGraph(context);
 
-  vx_image input_image = vxCreateImage(context, w_in, h_in, VX_DF_IMAGE_U8);
+  sink = openWriteBehind(16, WRITE_BEHIND_BLOCK);
+  if (!sink) {
+    printf("Could not start the output writer\n");
+    vxReleaseGraph(&graph);
+    releaseNodePerfReport(&report);
+    vxReleaseContext(&context);
+    return -1;
+  }
+  struct read_sequence *sequence = myOpenCapture(context);
+  if (!sequence) {
+    printf("Could not open the input sequence\n");
+    vxReleaseGraph(&graph);
+    closeWriteBehind(&sink);
+    releaseNodePerfReport(&report);
+    vxReleaseContext(&context);
+    return -1;
+  }
+  vx_image input_image = getReadSequenceImage(sequence);
   vx_image curr_image = vxCreateImage(context, w, h, VX_DF_IMAGE_U8);
   vx_image diff_image = vxCreateVirtualImage(graph, w, h, VX_DF_IMAGE_U8);
   vx_image bg_image = vxCreateImage(context, w, h, VX_DF_IMAGE_U8);
@@ -56,14 +82,14 @@ int main(int argc, char *argv[])
 						     VX_DF_IMAGE_U8, VX_DF_IMAGE_U8);
   vxCopyThresholdValue(threshold, (vx_pixel_value_t*)&threshval, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
 
-  vx_node scale_node = vxScaleImageNode(graph, input_image, curr_image, VX_INTERPOLATION_AREA);
-  vx_node absdiff_node = vxAbsDiffNode(graph, bg_image, curr_image, diff_image);
-  vx_node thresh_node = vxThresholdNode(graph, diff_image, threshold, fg_image);
+  vx_node scale_node = addNodeToPerfReport(report, "bg", vxScaleImageNode(graph, input_image, curr_image, VX_INTERPOLATION_AREA));
+  vx_node absdiff_node = addNodeToPerfReport(report, "bg", vxAbsDiffNode(graph, bg_image, curr_image, diff_image));
+  vx_node thresh_node = addNodeToPerfReport(report, "bg", vxThresholdNode(graph, diff_image, threshold, fg_image));
 
   vxVerifyGraph(graph);
 
   int framenum = 1;
-  while (myCaptureImage(context, input_image, framenum) == VX_SUCCESS) {
+  while (myCaptureImage(sequence, NULL) == VX_SUCCESS) {
 
     // Initialize the background model
     if (framenum == 1) {
@@ -73,17 +99,28 @@ int main(int argc, char *argv[])
     fflush(stdout);
 	      
     vxProcessGraph(graph);
+    sampleNodePerfReport(report);
 
     myDisplayImage(context, fg_image, "fg", framenum);
     framenum++;
   }
   printf("Finished after %d frames\n", framenum-1);
 
+  vxReleaseImage(&input_image);
+  vxReleaseImage(&curr_image);
+  vxReleaseImage(&diff_image);
+  vxReleaseImage(&bg_image);
+  vxReleaseImage(&fg_image);
+  vxReleaseThreshold(&threshold);
   vxReleaseNode(&scale_node);
   vxReleaseNode(&absdiff_node);
   vxReleaseNode(&thresh_node);
   vxReleaseGraph(&graph);
+  closeReadSequence(&sequence);
+  closeWriteBehind(&sink);
   vxUnloadKernels(context, "openvx-debug");
+  printNodePerfReport(report);
+  releaseNodePerfReport(&report);
   vxReleaseContext(&context);
 
 }
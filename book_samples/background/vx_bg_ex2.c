@@ -10,23 +10,31 @@
 #include <math.h>
 #include <stdarg.h>
 #include <assert.h>
+#include "readSequence.h"
+#include "writeBehind.h"
+#include "nodePerf.h"
 
 #define PATH_MAX 4096
 
 char *viddir = "/mnt/c/Users/Frank/Documents/piper-video";
 char *basefname = "piper01";
 char filename[PATH_MAX];
+struct write_behind *sink;  // Writes output images on a background thread
 
-int myCaptureImage(vx_context context, vx_image image, int framenum) {
-  sprintf(filename, "%s/%s/pgm/%s %04d.pgm", viddir, basefname, basefname, framenum);
-  if (framenum == 1)
-    printf("Beginning processing %s/%s\n", viddir, basefname);
-  return vxuFReadImage(context, filename, image);
+struct read_sequence *myOpenCapture(vx_context context) {
+  // Frames are decoded ahead on a worker thread so the graph does not wait for the disk
+  sprintf(filename, "%s/%s/pgm/%s %%04d.pgm", viddir, basefname, basefname);
+  printf("Beginning processing %s/%s\n", viddir, basefname);
+  return openReadSequence(context, filename, 1, 8, NULL);
+}
+
+int myCaptureImage(struct read_sequence *sequence, int *framenum) {
+  return readNextInSequence(sequence, framenum);
 }
 
 int myDisplayImage(vx_context context, vx_image image, char *suffix, int framenum) {
   sprintf(filename, "%s/%s/out/%s_%s %04d.pgm", viddir, basefname, basefname, suffix, framenum);
-  vxuFWriteImage(context, image, filename);
+  return writeImageBehind(sink, image, filename);
 }
 
 int main(int argc, char *argv[])
@@ -44,9 +52,27 @@ int main(int argc, char *argv[])
 
   vxLoadKernels(context, "openvx-debug");  // For reading and writing images
 
+  struct node_perf_report *report = createNodePerfReport(context);
   vx_graph graph = vxCreateGraph(context);
 
-  vx_image input_image = vxCreateImage(context, w_in, h_in, VX_DF_IMAGE_U8);
+  sink = openWriteBehind(16, WRITE_BEHIND_BLOCK);
+  if (!sink) {
+    printf("Could not start the output writer\n");
+    vxReleaseGraph(&graph);
+    releaseNodePerfReport(&report);
+    vxReleaseContext(&context);
+    return -1;
+  }
+  struct read_sequence *sequence = myOpenCapture(context);
+  if (!sequence) {
+    printf("Could not open the input sequence\n");
+    vxReleaseGraph(&graph);
+    closeWriteBehind(&sink);
+    releaseNodePerfReport(&report);
+    vxReleaseContext(&context);
+    return -1;
+  }
+  vx_image input_image = getReadSequenceImage(sequence);
   vx_image curr_image = vxCreateImage(context, w, h, VX_DF_IMAGE_U8);
   vx_image diff_image = vxCreateVirtualImage(graph, w, h, VX_DF_IMAGE_U8);
   vx_image bg_image = vxCreateImage(context, w, h, VX_DF_IMAGE_U8);
@@ -58,22 +84,22 @@ int main(int argc, char *argv[])
 						     VX_DF_IMAGE_U8, VX_DF_IMAGE_U8);
   vxCopyThresholdValue(threshold, (vx_pixel_value_t*)&threshval, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
 
-  vx_node scale_node = vxScaleImageNode(graph, input_image, curr_image, VX_INTERPOLATION_AREA);
-  vx_node absdiff_node = vxAbsDiffNode(graph, bg_image, curr_image, diff_image);
-  vx_node thresh_node = vxThresholdNode(graph, diff_image, threshold, fg_image);
-  vx_node dilate_node = vxDilate3x3Node(graph, fg_image, dilated_image);
-  vx_node erode_node = vxErode3x3Node(graph, dilated_image, eroded_image);
+  vx_node scale_node = addNodeToPerfReport(report, "bg", vxScaleImageNode(graph, input_image, curr_image, VX_INTERPOLATION_AREA));
+  vx_node absdiff_node = addNodeToPerfReport(report, "bg", vxAbsDiffNode(graph, bg_image, curr_image, diff_image));
+  vx_node thresh_node = addNodeToPerfReport(report, "bg", vxThresholdNode(graph, diff_image, threshold, fg_image));
+  vx_node dilate_node = addNodeToPerfReport(report, "bg", vxDilate3x3Node(graph, fg_image, dilated_image));
+  vx_node erode_node = addNodeToPerfReport(report, "bg", vxErode3x3Node(graph, dilated_image, eroded_image));
 
   vx_float32 alphaval = 0.3f;
   if (argc > 2) alphaval = atof(argv[2]);
   printf("Alpha blend value is %f\n", alphaval);
   vx_scalar alpha = vxCreateScalar(context, VX_TYPE_FLOAT32, &alphaval);
-  vx_node accum_node = vxAccumulateWeightedImageNode(graph, curr_image, alpha, bg_image);
+  vx_node accum_node = addNodeToPerfReport(report, "bg", vxAccumulateWeightedImageNode(graph, curr_image, alpha, bg_image));
 	    
   vxVerifyGraph(graph);
 
   int framenum = 1;
-  while (myCaptureImage(context, input_image, framenum) == VX_SUCCESS) {
+  while (myCaptureImage(sequence, NULL) == VX_SUCCESS) {
 
     // Initialize the background model
     if (framenum == 1) {
@@ -83,6 +109,7 @@ int main(int argc, char *argv[])
     fflush(stdout);
 	      
     vxProcessGraph(graph);
+    sampleNodePerfReport(report);
 
     myDisplayImage(context, fg_image, "fg", framenum);
     myDisplayImage(context, dilated_image, "dil", framenum);
@@ -99,6 +126,7 @@ int main(int argc, char *argv[])
   vxReleaseImage(&dilated_image);
   vxReleaseImage(&eroded_image);
   vxReleaseScalar(&alpha);
+  vxReleaseThreshold(&threshold);
   vxReleaseNode(&erode_node);
   vxReleaseNode(&dilate_node);
   vxReleaseNode(&accum_node);
@@ -106,7 +134,11 @@ int main(int argc, char *argv[])
   vxReleaseNode(&absdiff_node);
   vxReleaseNode(&thresh_node);
   vxReleaseGraph(&graph);
+  closeReadSequence(&sequence);
+  closeWriteBehind(&sink);
   vxUnloadKernels(context, "openvx-debug");
+  printNodePerfReport(report);
+  releaseNodePerfReport(&report);
   vxReleaseContext(&context);
 
 }
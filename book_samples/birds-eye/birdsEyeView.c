@@ -40,6 +40,7 @@
 #include <string.h>
 #include "readImage.h"
 #include "writeImage.h"
+#include "nodePerf.h"
 
 #define ERROR_CHECK_STATUS( status ) { \
         vx_status status_ = (status); \
@@ -594,7 +595,7 @@ void log_callback(vx_context context, vx_reference ref,
 
 vx_graph makeBirdsEyeViewGraph(vx_context context, vx_image input,
   vx_image* binary, vx_array lines, vx_array vanishing_points, vx_matrix perspective,
-  vx_image birds_eye)
+  vx_image birds_eye, struct node_perf_report *report)
 {
 
     vx_graph graph = vxCreateGraph(context);
@@ -636,15 +637,15 @@ vx_graph makeBirdsEyeViewGraph(vx_context context, vx_image input,
     *binary = vxCreateImage(context, widthr, heightr, VX_DF_IMAGE_U8);
 
     /* extract grayscale channel */
-    vxColorConvertNode(graph, input, virt_nv12);
-    vxChannelExtractNode(graph, virt_nv12, VX_CHANNEL_Y, virt_y);
+    addNodeToPerfReport(report, "birdseye", vxColorConvertNode(graph, input, virt_nv12));
+    addNodeToPerfReport(report, "birdseye", vxChannelExtractNode(graph, virt_nv12, VX_CHANNEL_Y, virt_y));
 
     /* resize down */
-    vxScaleImageNode(graph, virt_y, virt_yr, VX_INTERPOLATION_BILINEAR);
+    addNodeToPerfReport(report, "birdseye", vxScaleImageNode(graph, virt_y, virt_yr, VX_INTERPOLATION_BILINEAR));
 
     /* compute gradient */
-    vxSobel3x3Node(graph, virt_yr, virt_s16[0], virt_s16[1]);
-    vxMagnitudeNode(graph, virt_s16[0], virt_s16[1], virt_s16[2]);
+    addNodeToPerfReport(report, "birdseye", vxSobel3x3Node(graph, virt_yr, virt_s16[0], virt_s16[1]));
+    addNodeToPerfReport(report, "birdseye", vxMagnitudeNode(graph, virt_s16[0], virt_s16[1], virt_s16[2]));
 
     /* setup threshold value */
     vx_threshold thresh = vxCreateThresholdForImage(context,
@@ -660,8 +661,8 @@ vx_graph makeBirdsEyeViewGraph(vx_context context, vx_image input,
       printf("Issue with thresh: %d\n", status);
     }
 
-    vx_node thresh_node = vxThresholdNode(graph, virt_s16[2], thresh,
-      binary_thresh);
+    vx_node thresh_node = addNodeToPerfReport(report, "birdseye", vxThresholdNode(graph, virt_s16[2], thresh,
+      binary_thresh));
     status = vxGetStatus((vx_reference)thresh_node);
     if(status != VX_SUCCESS)
     {
@@ -669,7 +670,7 @@ vx_graph makeBirdsEyeViewGraph(vx_context context, vx_image input,
     }
 
     /* dilate the threshold output */
-    vxDilate3x3Node(graph, binary_thresh, *binary);
+    addNodeToPerfReport(report, "birdseye", vxDilate3x3Node(graph, binary_thresh, *binary));
 
     vx_array _lines = vxCreateVirtualArray(graph, VX_TYPE_LINE_2D, max_num_lines);
 
@@ -685,12 +686,12 @@ vx_graph makeBirdsEyeViewGraph(vx_context context, vx_image input,
     hough_params.theta_max = 3.14;
     hough_params.theta_min = 0.0;
 
-    vxHoughLinesPNode(graph, *binary, &hough_params, _lines, num_lines);
+    addNodeToPerfReport(report, "birdseye", vxHoughLinesPNode(graph, *binary, &hough_params, _lines, num_lines));
 
-    userFilterLinesNode(graph, _lines, lines);
-    userFindVanishingPoint(graph, lines, vanishing_points);
+    addNodeToPerfReport(report, "birdseye", userFilterLinesNode(graph, _lines, lines));
+    addNodeToPerfReport(report, "birdseye", userFindVanishingPoint(graph, lines, vanishing_points));
 
-    userComputeBirdsEyeTransform(graph, vanishing_points, input, perspective);
+    addNodeToPerfReport(report, "birdseye", userComputeBirdsEyeTransform(graph, vanishing_points, input, perspective));
 
     /* Create the same processing subgraph for each channel */
     enum vx_channel_e channels[] = {VX_CHANNEL_R, VX_CHANNEL_G, VX_CHANNEL_B};
@@ -699,9 +700,9 @@ vx_graph makeBirdsEyeViewGraph(vx_context context, vx_image input,
     {
       /* First, extract input and logo R, G, and B channels to individual
       virtual images */
-      vxChannelExtractNode(graph, input, channels[i], virt_u8[i]);
+      addNodeToPerfReport(report, "birdseye", vxChannelExtractNode(graph, input, channels[i], virt_u8[i]));
 
-      vx_node warp_node = vxWarpPerspectiveNode(graph, virt_u8[i], perspective, VX_INTERPOLATION_BILINEAR, virt_u8[i + 3]);
+      vx_node warp_node = addNodeToPerfReport(report, "birdseye", vxWarpPerspectiveNode(graph, virt_u8[i], perspective, VX_INTERPOLATION_BILINEAR, virt_u8[i + 3]));
       ERROR_CHECK_OBJECT(warp_node);
 
       // set the border mode to constant with zero value
@@ -710,7 +711,7 @@ vx_graph makeBirdsEyeViewGraph(vx_context context, vx_image input,
       border_mode.constant_value.U8 = 0;
       vxSetNodeAttribute(warp_node, VX_NODE_BORDER, &border_mode, sizeof(border_mode));
     }
-    vxChannelCombineNode(graph, virt_u8[3], virt_u8[4], virt_u8[5], NULL, birds_eye);
+    addNodeToPerfReport(report, "birdseye", vxChannelCombineNode(graph, virt_u8[3], virt_u8[4], virt_u8[5], NULL, birds_eye));
 
     return graph;
 }
@@ -758,15 +759,19 @@ int main(int argc, char **argv)
     ERROR_CHECK_OBJECT(vanishing_points = vxCreateArray(context, VX_TYPE_COORDINATES2D, max_num_lines));
 
     vx_matrix perspective = vxCreateMatrix(context, VX_TYPE_FLOAT32, 3, 3);
+    struct node_perf_report *report = createNodePerfReport(context);
     vx_graph graph = makeBirdsEyeViewGraph(context, image, &binary, lines, vanishing_points,
-      perspective, output);
+      perspective, output, report);
 
     vxRegisterLogCallback(context, log_callback, vx_true_e);
 
     vxProcessGraph(graph);
+    sampleNodePerfReport(report);
 
     vxa_write_image(output, output_filename);
 
+    printNodePerfReport(report);
+    releaseNodePerfReport(&report);
     vxReleaseContext(&context);
     return(0);
 }
@@ -7,8 +7,9 @@ Read an image, change it, write it out.
 #include <stdlib.h>
 #include "readImage.h"
 #include "writeImage.h"
+#include "nodePerf.h"
 
-vx_graph makeTestGraph(vx_context context, vx_image image, vx_image output)
+vx_graph makeTestGraph(vx_context context, vx_image image, vx_image output, struct node_perf_report *report)
 {
     /* creates a graph with one input image and one output image.
     You supply the input and output images, it is assumed that the input and output images are RGB.
@@ -34,25 +35,25 @@ vx_graph makeTestGraph(vx_context context, vx_image image, vx_image output)
     /* Do some arbitrary processing on the imput image */
     /* First, make a true greyscale image. We do this by converting to YUV
     and extracting the Y. */
-    vxColorConvertNode(graph, image, virtsyuv[0]);
-    vxChannelExtractNode(graph, virtsyuv[0], VX_CHANNEL_Y, virts8[0]);
+    addNodeToPerfReport(report, "change", vxColorConvertNode(graph, image, virtsyuv[0]));
+    addNodeToPerfReport(report, "change", vxChannelExtractNode(graph, virtsyuv[0], VX_CHANNEL_Y, virts8[0]));
 
     /* Use a Canny detector on the greyscale image to find edges */
-    vxCannyEdgeDetectorNode(graph, virts8[0], hyst, 5, VX_NORM_L1, virts8[1]);
+    addNodeToPerfReport(report, "change", vxCannyEdgeDetectorNode(graph, virts8[0], hyst, 5, VX_NORM_L1, virts8[1]));
 
     /* Make the edges black and AND the edges back with the Y value so as to super-impose a black background */
-    vxNotNode(graph, virts8[1], virts8[2]);
-    vxAndNode(graph, virts8[0], virts8[2], virts8[3]);
+    addNodeToPerfReport(report, "change", vxNotNode(graph, virts8[1], virts8[2]));
+    addNodeToPerfReport(report, "change", vxAndNode(graph, virts8[0], virts8[2], virts8[3]));
 
     /* Get the U and V channels as well.. */
-    vxChannelExtractNode(graph, virtsyuv[0], VX_CHANNEL_U, virts8[4]);
-    vxChannelExtractNode(graph, virtsyuv[0], VX_CHANNEL_V, virts8[5]);
+    addNodeToPerfReport(report, "change", vxChannelExtractNode(graph, virtsyuv[0], VX_CHANNEL_U, virts8[4]));
+    addNodeToPerfReport(report, "change", vxChannelExtractNode(graph, virtsyuv[0], VX_CHANNEL_V, virts8[5]));
 
     /* Combine the colour channels to give a YUV output image */
-    vxChannelCombineNode(graph, virts8[3], virts8[4], virts8[5], NULL, virtsyuv[1]);
+    addNodeToPerfReport(report, "change", vxChannelCombineNode(graph, virts8[3], virts8[4], virts8[5], NULL, virtsyuv[1]));
 
     /* Convert the YUV to RGB output */
-    vxColorConvertNode(graph, virtsyuv[1], output);
+    addNodeToPerfReport(report, "change", vxColorConvertNode(graph, virtsyuv[1], output));
 
     for (i =0; i < numv8; ++i)
         vxReleaseImage(&virts8[i]);
@@ -74,13 +75,17 @@ int main(int argc, char **argv)
         vx_context context = vxCreateContext();
         vx_image image = createImageFromFile(context, (const char *)argv[1], &attr);
         vx_image output = vxCreateImage(context, attr.width, attr.height, attr.format);
-        vx_graph graph = makeTestGraph(context, image, output);
+        struct node_perf_report *report = createNodePerfReport(context);
+        vx_graph graph = makeTestGraph(context, image, output, report);
         if (vxGetStatus((vx_reference)image))
             printf("Could not create input image\n");
         else if (vxProcessGraph(graph))
             printf("Error processing graph\n");
         else if (writeImage(output, (const char *)argv[2]))
             printf("Problem writing the output image\n");
+        sampleNodePerfReport(report);
+        printNodePerfReport(report);
+        releaseNodePerfReport(&report);
         vxReleaseContext(&context);
     }
 }
@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include "VX/vx.h"
 #include "writeImage.h"
+#include "nodePerf.h"
 
 void errorCheck(vx_context *context_p, vx_status status, const char *message)
 {
@@ -72,7 +73,7 @@ vx_image makeInputImage(vx_context context, vx_uint32 width, vx_uint32 height)
   return image;
 }
 
-vx_graph makeTestGraph(vx_context context)
+vx_graph makeTestGraph(vx_context context, struct node_perf_report *report)
 {
     vx_graph graph = vxCreateGraph(context);
     int i;
@@ -97,16 +98,16 @@ vx_graph makeTestGraph(vx_context context)
     vxCopyMatrix(warp_matrix, matrix_values, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
 
     /* Create the nodes to do the processing, order of creation is not important */
-    vx_node last_node = vxFastCornersNode(graph, imagesU8[4], strength_thresh, vx_true_e, corners, num_corners);
-    vxDilate3x3Node(graph, imagesU8[3], imagesU8[4]);
-    vxConvertDepthNode(graph, imagesS16[2], imagesU8[3], VX_CONVERT_POLICY_SATURATE, shift);
-    vxMagnitudeNode(graph, imagesS16[0], imagesS16[1], imagesS16[2]);
-    vxSobel3x3Node(graph, imagesU8[2], imagesS16[0], imagesS16[1]);
-    vxOrNode(graph, imagesU8[0], imagesU8[1], imagesU8[2]);
-    vxWarpAffineNode(graph, imagesU8[0], warp_matrix, VX_INTERPOLATION_NEAREST_NEIGHBOR, imagesU8[1]);
+    vx_node last_node = addNodeToPerfReport(report, "test", vxFastCornersNode(graph, imagesU8[4], strength_thresh, vx_true_e, corners, num_corners));
+    addNodeToPerfReport(report, "test", vxDilate3x3Node(graph, imagesU8[3], imagesU8[4]));
+    addNodeToPerfReport(report, "test", vxConvertDepthNode(graph, imagesS16[2], imagesU8[3], VX_CONVERT_POLICY_SATURATE, shift));
+    addNodeToPerfReport(report, "test", vxMagnitudeNode(graph, imagesS16[0], imagesS16[1], imagesS16[2]));
+    addNodeToPerfReport(report, "test", vxSobel3x3Node(graph, imagesU8[2], imagesS16[0], imagesS16[1]));
+    addNodeToPerfReport(report, "test", vxOrNode(graph, imagesU8[0], imagesU8[1], imagesU8[2]));
+    addNodeToPerfReport(report, "test", vxWarpAffineNode(graph, imagesU8[0], warp_matrix, VX_INTERPOLATION_NEAREST_NEIGHBOR, imagesU8[1]));
 
     /* Setup input parameter using a Copy node */
-    vxAddParameterToGraph(graph, vxGetParameterByIndex(vxCopyNode(graph, (vx_reference)input, (vx_reference)imagesU8[0]), 0));
+    vxAddParameterToGraph(graph, vxGetParameterByIndex(addNodeToPerfReport(report, "test", vxCopyNode(graph, (vx_reference)input, (vx_reference)imagesU8[0])), 0));
 
     /* Setup the output parameters from the last node */
     vxAddParameterToGraph(graph, vxGetParameterByIndex(last_node, 3));    /* array of corners */
@@ -114,7 +115,7 @@ vx_graph makeTestGraph(vx_context context)
 
     /* Add another output parameter to the graph */
     vx_image output = vxCreateImage(context, 100U, 100U, VX_DF_IMAGE_U8);
-    vxAddParameterToGraph(graph, vxGetParameterByIndex(vxCopyNode(graph, (vx_reference)imagesU8[4], (vx_reference)output), 1));
+    vxAddParameterToGraph(graph, vxGetParameterByIndex(addNodeToPerfReport(report, "test", vxCopyNode(graph, (vx_reference)imagesU8[4], (vx_reference)output)), 1));
 
     /* Release resources */
     vxReleaseImage(&input);
@@ -141,13 +142,14 @@ vx_reference getGraphParameter(vx_graph graph, vx_uint32 index)
     return ref;
 }
 
-void showResults(vx_graph graph, vx_image image, const char * message)
+void showResults(vx_graph graph, vx_image image, const char * message, struct node_perf_report *report)
 {
     vx_context context = vxGetContext((vx_reference)graph);
     puts(message);
     vxSetGraphParameterByIndex(graph, 0, (vx_reference)image);
     if (VX_SUCCESS == vxProcessGraph(graph))
     {
+        sampleNodePerfReport(report);
         vx_size num_corners_value = 0;
         vx_keypoint_t *kp = calloc( 100, sizeof(vx_keypoint_t));
         errorCheck(&context, vxCopyScalar((vx_scalar)getGraphParameter(graph, 2), &num_corners_value,
@@ -179,16 +181,20 @@ int main(void)
     vx_context context = vxCreateContext();
     errorCheck(&context, vxGetStatus((vx_reference)context), "Could not create a vx_context\n");
 
-    vx_graph graph = makeTestGraph(context);
+    struct node_perf_report *report = createNodePerfReport(context);
+    vx_graph graph = makeTestGraph(context, report);
 
     vx_image image1 = makeInputImage(context, 30, 10);
     vx_image image2 = makeInputImage(context, 25, 25);
 
-    showResults(graph, image1, "Results for Image 1");
+    showResults(graph, image1, "Results for Image 1", report);
     writeImage((vx_image)getGraphParameter(graph, 3), "example4-1.pgm");
-    showResults(graph, image2, "Results for Image 2");
+    showResults(graph, image2, "Results for Image 2", report);
     writeImage((vx_image)getGraphParameter(graph, 3), "example4-2.pgm");
 
+    printNodePerfReport(report);
+    releaseNodePerfReport(&report);
+
     vxReleaseContext(&context);
     return 0;
 }
@@ -7,8 +7,9 @@ Read and write an image.
 #include <stdlib.h>
 #include "readImage.h"
 #include "writeImage.h"
+#include "nodePerf.h"
 
-vx_graph makeFilterGraph(vx_context context, vx_image input, vx_image output)
+vx_graph makeFilterGraph(vx_context context, vx_image input, vx_image output, struct node_perf_report *report)
 {
     /* creates a graph with one input image and one output image.
     You supply the input and output images, it is assumed that the input and output images are RGB.
@@ -39,16 +40,16 @@ vx_graph makeFilterGraph(vx_context context, vx_image input, vx_image output)
 
     /* Do custom filtering on the input image */
     /* First, extract R, G, and B channels to individual virtual images */
-    vxChannelExtractNode(graph, input, VX_CHANNEL_R, virtu8[0]);
-    vxChannelExtractNode(graph, input, VX_CHANNEL_G, virtu8[1]);
-    vxChannelExtractNode(graph, input, VX_CHANNEL_B, virtu8[2]);
+    addNodeToPerfReport(report, "filter", vxChannelExtractNode(graph, input, VX_CHANNEL_R, virtu8[0]));
+    addNodeToPerfReport(report, "filter", vxChannelExtractNode(graph, input, VX_CHANNEL_G, virtu8[1]));
+    addNodeToPerfReport(report, "filter", vxChannelExtractNode(graph, input, VX_CHANNEL_B, virtu8[2]));
 
     /* Now, run box filter on each of gray scale images */
     for(i = 0; i < 3; i++)
-      vxConvolveNode(graph, virtu8[i], scharr, virtu8[i + 3]);
+      addNodeToPerfReport(report, "filter", vxConvolveNode(graph, virtu8[i], scharr, virtu8[i + 3]));
 
     /* Now combine images together in the ouptut color image */
-    vxChannelCombineNode(graph, virtu8[3], virtu8[4], virtu8[5], NULL, output);
+    addNodeToPerfReport(report, "filter", vxChannelCombineNode(graph, virtu8[3], virtu8[4], virtu8[5], NULL, output));
 
     for (i =0; i < numv8; ++i)
         vxReleaseImage(&virtu8[i]);
@@ -68,13 +69,17 @@ void main(int argc, char **argv)
         vx_context context = vxCreateContext();
         vx_image image = createImageFromFile(context, (const char *)argv[1], &attr);
         vx_image output = vxCreateImage(context, attr.width, attr.height, attr.format);
-        vx_graph graph = makeFilterGraph(context, image, output);
+        struct node_perf_report *report = createNodePerfReport(context);
+        vx_graph graph = makeFilterGraph(context, image, output, report);
         if (vxGetStatus((vx_reference)image))
             printf("Could not create input image\n");
         else if (vxProcessGraph(graph))
             printf("Error processing graph\n");
         else if (writeImage(output, (const char *)argv[2]))
             printf("Problem writing the output image\n");
+        sampleNodePerfReport(report);
+        printNodePerfReport(report);
+        releaseNodePerfReport(&report);
         vxReleaseContext(&context);
     }
 }
@@ -0,0 +1,162 @@
+/*
+packFrames.c
+Pack images of the same size and format into a frame file (see frameFile.h), then replay the frame file and
+check every frame against the image file it came from. The images are given one by one or, where
+PACK_FRAMES_SCAN_DIRECTORY is set, as a directory that is probed in parallel with scanImageDirectory. All the
+headers are read before any pixel data.
+*/
+#include <VX/vx.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "readImage.h"
+#include "frameFile.h"
+#if PACK_FRAMES_SCAN_DIRECTORY
+#include "scanImages.h"
+#endif
+
+struct pack_input {             /* An image file and the result of probing it */
+    const char *filename;
+    vx_status status;
+    struct read_image_attributes attr;
+};
+
+/* Pack the images that match attr into filename; their names are stored in packed, and their number returned */
+static vx_uint32 packImages(vx_context context, const char *filename, const struct read_image_attributes *attr,
+                            const struct pack_input *inputs, vx_uint32 count, const char **packed)
+{
+    vx_uint32 n = 0, i;
+    vx_image image = vxCreateImage(context, attr->width, attr->height, attr->format);
+    struct frame_writer *writer = openFrameWriter(filename, attr->width, attr->height, attr->format);
+    if (vxGetStatus((vx_reference)image) || !writer)
+        printf("Could not create %s\n", filename);
+    else
+    {
+        for (i = 0; i < count; ++i)
+        {
+            const struct pack_input *input = &inputs[i];
+            if (VX_SUCCESS != input->status || input->attr.width != attr->width ||
+                input->attr.height != attr->height || input->attr.format != attr->format)
+                printf("Skipping %s, which is not an image of the same size and format as the first\n",
+                       input->filename);
+            else if (readImage(image, input->filename, READ_IMAGE_USE_NONE, READ_IMAGE_PLACE_NONE,
+                               READ_IMAGE_FILL_NONE) || writeFrame(writer, image))
+                printf("Could not pack %s\n", input->filename);
+            else
+                packed[n++] = input->filename;
+        }
+    }
+    if (writer && closeFrameWriter(&writer))
+    {
+        printf("Could not finish %s\n", filename);
+        n = 0;
+    }
+    vxReleaseImage(&image);
+    return n;
+}
+
+/* Replay the frames of filename into an image, and compare each frame with its image file. Returns the number
+   of frames that match. */
+static vx_uint32 checkFrames(vx_context context, const char *filename, const char **packed, vx_uint32 count)
+{
+    struct read_image_attributes attr;
+    vx_uint32 n = 0, frames = 0, i;
+    struct frame_reader *reader = openFrameReader(filename, &attr, &frames);
+    vx_image image = NULL;
+    void *buffer = NULL;
+    if (!reader)
+    {
+        printf("Could not open %s\n", filename);
+        return 0;
+    }
+    if (frames != count)
+        printf("%s holds %u frames instead of %u\n", filename, frames, count);
+    image = vxCreateImage(context, attr.width, attr.height, attr.format);
+    buffer = malloc((size_t)attr.width * attr.height * framePixelSize(attr.format));
+    for (i = 0; buffer && i < frames && i < count; ++i)
+    {
+        vx_imagepatch_addressing_t addr;
+        const void *frame = getFramePointer(reader, i, &addr);
+        if (VX_SUCCESS != readFrame(reader, i, image) || !frame ||
+            VX_SUCCESS != readImageToMemory(packed[i], buffer, &addr, attr.format, READ_IMAGE_USE_NONE,
+                                            READ_IMAGE_PLACE_NONE, READ_IMAGE_FILL_NONE) ||
+            0 != memcmp(frame, buffer, (size_t)addr.stride_y * attr.height))
+            printf("Frame %u does not match %s\n", i, packed[i]);
+        else
+            ++n;
+    }
+    free(buffer);
+    vxReleaseImage(&image);
+    closeFrameReader(&reader);
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    struct pack_input *inputs;
+    const char **packed;
+    vx_context context;
+    vx_uint32 count = 0, packed_count = 0, matched = 0, i;
+#if PACK_FRAMES_SCAN_DIRECTORY
+    struct read_image_probe *probes = NULL;
+    vx_uint32 probe_count = 0;
+#endif
+    if (argc < 3)
+    {
+        printf("Pack images of the same size and format into a frame file, and check it\n"
+#if PACK_FRAMES_SCAN_DIRECTORY
+               "%s <frame-file> <directory>\n"
+#endif
+               "%s <frame-file> <image> [<image> ...]\n",
+#if PACK_FRAMES_SCAN_DIRECTORY
+               (char *)argv[0],
+#endif
+               (char *)argv[0]);
+        return 1;
+    }
+#if PACK_FRAMES_SCAN_DIRECTORY
+    if (3 == argc && VX_SUCCESS == scanImageDirectory(argv[2], 0, &probes, &probe_count))
+    {
+        inputs = (struct pack_input *)calloc(probe_count + 1, sizeof(struct pack_input));
+        for (i = 0; inputs && i < probe_count; ++i)
+        {
+            inputs[i].filename = probes[i].filename;
+            inputs[i].status = probes[i].status;
+            inputs[i].attr = probes[i].attr;
+        }
+        count = probe_count;
+    }
+    else
+#endif
+    {
+        inputs = (struct pack_input *)calloc(argc, sizeof(struct pack_input));
+        for (i = 0; inputs && i < (vx_uint32)argc - 2; ++i)
+        {
+            inputs[i].filename = argv[i + 2];
+            inputs[i].status = probeImageFile(argv[i + 2], &inputs[i].attr, NULL);
+        }
+        count = (vx_uint32)argc - 2;
+    }
+    /* The first image that could be probed sets the size and format of the frames */
+    for (i = 0; inputs && i < count && VX_SUCCESS != inputs[i].status; ++i)
+        ;
+    packed = (const char **)calloc(count + 1, sizeof(char *));
+    context = vxCreateContext();
+    if (!inputs || !packed || vxGetStatus((vx_reference)context))
+        printf("Could not create the context\n");
+    else if (i == count)
+        printf("No image to pack\n");
+    else
+    {
+        packed_count = packImages(context, argv[1], &inputs[i].attr, inputs, count, packed);
+        matched = packed_count ? checkFrames(context, argv[1], packed, packed_count) : 0;
+        printf("%u images packed into %s, %u frames match their image files\n", packed_count, argv[1], matched);
+    }
+    vxReleaseContext(&context);
+    free(packed);
+    free(inputs);
+#if PACK_FRAMES_SCAN_DIRECTORY
+    releaseImageProbes(&probes, probe_count);
+#endif
+    return packed_count && matched == packed_count ? 0 : 1;
+}
@@ -36,6 +36,7 @@
 #include <string.h>
 #include "readImage.h"
 #include "writeImage.h"
+#include "nodePerf.h"
 
 void log_callback(vx_context context, vx_reference ref,
   vx_status status, const char* string)
@@ -44,7 +45,7 @@ void log_callback(vx_context context, vx_reference ref,
 }
 
 vx_graph makeHoughLinesGraph(vx_context context, vx_image input,
-  vx_image* binary, vx_array lines)
+  vx_image* binary, vx_array lines, struct node_perf_report *report)
 {
     vx_uint32 width, height;
     vxQueryImage(input, VX_IMAGE_WIDTH, &width, sizeof(vx_uint32));
@@ -74,15 +75,15 @@ vx_graph makeHoughLinesGraph(vx_context context, vx_image input,
     *binary = vxCreateImage(context, widthr, heightr, VX_DF_IMAGE_U8);
 
     /* extract grayscale channel */
-    vxColorConvertNode(graph, input, virt_nv12);
-    vxChannelExtractNode(graph, virt_nv12, VX_CHANNEL_Y, virt_y);
+    addNodeToPerfReport(report, "hough", vxColorConvertNode(graph, input, virt_nv12));
+    addNodeToPerfReport(report, "hough", vxChannelExtractNode(graph, virt_nv12, VX_CHANNEL_Y, virt_y));
 
     /* resize down */
-    vxScaleImageNode(graph, virt_y, virt_yr, VX_INTERPOLATION_BILINEAR);
+    addNodeToPerfReport(report, "hough", vxScaleImageNode(graph, virt_y, virt_yr, VX_INTERPOLATION_BILINEAR));
 
     /* compute gradient */
-    vxSobel3x3Node(graph, virt_yr, virt_s16[0], virt_s16[1]);
-    vxMagnitudeNode(graph, virt_s16[0], virt_s16[1], virt_s16[2]);
+    addNodeToPerfReport(report, "hough", vxSobel3x3Node(graph, virt_yr, virt_s16[0], virt_s16[1]));
+    addNodeToPerfReport(report, "hough", vxMagnitudeNode(graph, virt_s16[0], virt_s16[1], virt_s16[2]));
 
     /* setup threshold value */
     vx_threshold thresh = vxCreateThresholdForImage(context,
@@ -98,8 +99,8 @@ vx_graph makeHoughLinesGraph(vx_context context, vx_image input,
       printf("Issue with thresh: %d\n", status);
     }
 
-    vx_node thresh_node = vxThresholdNode(graph, virt_s16[2], thresh,
-      binary_thresh);
+    vx_node thresh_node = addNodeToPerfReport(report, "hough", vxThresholdNode(graph, virt_s16[2], thresh,
+      binary_thresh));
     status = vxGetStatus((vx_reference)thresh_node);
     if(status != VX_SUCCESS)
     {
@@ -107,7 +108,7 @@ vx_graph makeHoughLinesGraph(vx_context context, vx_image input,
     }
 
     /* dilate the threshold output */
-    vxDilate3x3Node(graph, binary_thresh, *binary);
+    addNodeToPerfReport(report, "hough", vxDilate3x3Node(graph, binary_thresh, *binary));
 
     /* run hough transform */
     vx_hough_lines_p_t hough_params;
@@ -120,7 +121,7 @@ vx_graph makeHoughLinesGraph(vx_context context, vx_image input,
     hough_params.theta_min = 0.0;
 
     vx_scalar num_lines = vxCreateScalar(context, VX_TYPE_SIZE, NULL);
-    vxHoughLinesPNode(graph, *binary, &hough_params, lines, num_lines);
+    addNodeToPerfReport(report, "hough", vxHoughLinesPNode(graph, *binary, &hough_params, lines, num_lines));
 
     return graph;
 }
@@ -149,11 +150,13 @@ int main(int argc, char **argv)
     /* create an array for storing hough lines output */
     const vx_size max_num_lines = 2000;
     vx_array lines = vxCreateArray(context, VX_TYPE_LINE_2D, max_num_lines);
-    vx_graph graph = makeHoughLinesGraph(context, image, &binary, lines);
+    struct node_perf_report *report = createNodePerfReport(context);
+    vx_graph graph = makeHoughLinesGraph(context, image, &binary, lines, report);
 
     vxRegisterLogCallback(context, log_callback, vx_true_e);
 
     vxProcessGraph(graph);
+    sampleNodePerfReport(report);
 
     vxa_write_image(binary, binary_filename);
 
@@ -169,6 +172,8 @@ int main(int argc, char **argv)
       &color, 2, &image_lines);
     vxa_write_image(image_lines, lines_filename);
 
+    printNodePerfReport(report);
+    releaseNodePerfReport(&report);
     vxReleaseContext(&context);
     return(0);
 }
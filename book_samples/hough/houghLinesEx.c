@@ -38,6 +38,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "readImage.h"
+#include "nodePerf.h"
 #include "writeImage.h"
 
 #define ERROR_CHECK_STATUS( status ) { \
@@ -320,7 +321,7 @@ void log_callback(vx_context context, vx_reference ref,
 }
 
 vx_graph makeHoughLinesGraph(vx_context context, vx_image input,
-  vx_image* binary, vx_array lines, vx_array vanishing_points)
+  vx_image* binary, vx_array lines, vx_array vanishing_points, struct node_perf_report *report)
 {
     vx_uint32 width, height;
     vxQueryImage(input, VX_IMAGE_WIDTH, &width, sizeof(vx_uint32));
@@ -354,15 +355,15 @@ vx_graph makeHoughLinesGraph(vx_context context, vx_image input,
     *binary = vxCreateImage(context, widthr, heightr, VX_DF_IMAGE_U8);
 
     /* extract grayscale channel */
-    vxColorConvertNode(graph, input, virt_nv12);
-    vxChannelExtractNode(graph, virt_nv12, VX_CHANNEL_Y, virt_y);
+    addNodeToPerfReport(report, "hough", vxColorConvertNode(graph, input, virt_nv12));
+    addNodeToPerfReport(report, "hough", vxChannelExtractNode(graph, virt_nv12, VX_CHANNEL_Y, virt_y));
 
     /* resize down */
-    vxScaleImageNode(graph, virt_y, virt_yr, VX_INTERPOLATION_BILINEAR);
+    addNodeToPerfReport(report, "hough", vxScaleImageNode(graph, virt_y, virt_yr, VX_INTERPOLATION_BILINEAR));
 
     /* compute gradient */
-    vxSobel3x3Node(graph, virt_yr, virt_s16[0], virt_s16[1]);
-    vxMagnitudeNode(graph, virt_s16[0], virt_s16[1], virt_s16[2]);
+    addNodeToPerfReport(report, "hough", vxSobel3x3Node(graph, virt_yr, virt_s16[0], virt_s16[1]));
+    addNodeToPerfReport(report, "hough", vxMagnitudeNode(graph, virt_s16[0], virt_s16[1], virt_s16[2]));
 
     /* setup threshold value */
     vx_threshold thresh = vxCreateThresholdForImage(context,
@@ -378,8 +379,8 @@ vx_graph makeHoughLinesGraph(vx_context context, vx_image input,
       printf("Issue with thresh: %d\n", status);
     }
 
-    vx_node thresh_node = vxThresholdNode(graph, virt_s16[2], thresh,
-      binary_thresh);
+    vx_node thresh_node = addNodeToPerfReport(report, "hough", vxThresholdNode(graph, virt_s16[2], thresh,
+      binary_thresh));
     status = vxGetStatus((vx_reference)thresh_node);
     if(status != VX_SUCCESS)
     {
@@ -387,7 +388,7 @@ vx_graph makeHoughLinesGraph(vx_context context, vx_image input,
     }
 
     /* dilate the threshold output */
-    vxDilate3x3Node(graph, binary_thresh, *binary);
+    addNodeToPerfReport(report, "hough", vxDilate3x3Node(graph, binary_thresh, *binary));
 
     vx_array _lines = vxCreateVirtualArray(graph, VX_TYPE_LINE_2D, max_num_lines);
 
@@ -403,10 +404,10 @@ vx_graph makeHoughLinesGraph(vx_context context, vx_image input,
     hough_params.theta_max = 3.14;
     hough_params.theta_min = 0.0;
 
-    vxHoughLinesPNode(graph, *binary, &hough_params, _lines, num_lines);
+    addNodeToPerfReport(report, "hough", vxHoughLinesPNode(graph, *binary, &hough_params, _lines, num_lines));
 
-    userFilterLinesNode(graph, _lines, lines);
-    userFindVanishingPoint(graph, lines, vanishing_points);
+    addNodeToPerfReport(report, "hough", userFilterLinesNode(graph, _lines, lines));
+    addNodeToPerfReport(report, "hough", userFindVanishingPoint(graph, lines, vanishing_points));
 
     return graph;
 }
@@ -446,11 +447,13 @@ int main(int argc, char **argv)
     /* create an array for storing vanishing point candidates */
     ERROR_CHECK_OBJECT(vanishing_points = vxCreateArray(context, VX_TYPE_COORDINATES2D, max_num_lines));
 
-    vx_graph graph = makeHoughLinesGraph(context, image, &binary, lines, vanishing_points);
+    struct node_perf_report *report = createNodePerfReport(context);
+    vx_graph graph = makeHoughLinesGraph(context, image, &binary, lines, vanishing_points, report);
 
     vxRegisterLogCallback(context, log_callback, vx_true_e);
 
     vxProcessGraph(graph);
+    sampleNodePerfReport(report);
 
     vxa_write_image(binary, binary_filename);
 
@@ -476,6 +479,8 @@ int main(int argc, char **argv)
     draw_circles(context, image_lines, vanishing_points, 1, 10, &color, 3, &image_final);
     vxa_write_image(image_final, lines_filename);
 
+    printNodePerfReport(report);
+    releaseNodePerfReport(&report);
     vxReleaseContext(&context);
     return(0);
 }
@@ -0,0 +1,390 @@
+/*
+nodePerf.c
+Per-node performance report. After each run the time of the last execution of every node is read from
+VX_NODE_PERFORMANCE and kept, so that percentiles can be computed as well as the min/avg/max that OpenVX
+accumulates itself. A node is sampled only when its run count has changed, so one report can hold the nodes of
+several graphs that do not all run every frame.
+*/
+#include <VX/vx.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nodePerf.h"
+
+#define NODE_PERF_NAME_SIZE 64
+
+struct node_perf_entry {
+    vx_node node;
+    char graph[NODE_PERF_NAME_SIZE];
+    char name[NODE_PERF_NAME_SIZE];
+    char kernel[VX_MAX_KERNEL_NAME];
+    vx_uint64 last_num;               /* Run count of the node when it was last sampled */
+    vx_uint64 *samples;               /* Execution times in nanoseconds */
+    vx_uint32 count, capacity;
+};
+
+struct node_perf_report {
+    struct node_perf_entry *nodes;
+    vx_uint32 count, capacity;
+};
+
+struct node_perf_stats {              /* Statistics of a node or of all the nodes of a kernel, in nanoseconds */
+    const char *graph, *name, *kernel;
+    vx_uint32 nodes, runs;
+    vx_uint64 min, p50, p95, p99, max, total;
+    double avg;
+};
+
+static int compareSamples(const void *a, const void *b)
+{
+    vx_uint64 x = *(const vx_uint64 *)a, y = *(const vx_uint64 *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int compareTotals(const void *a, const void *b)
+{
+    vx_uint64 x = ((const struct node_perf_stats *)a)->total, y = ((const struct node_perf_stats *)b)->total;
+    return x > y ? -1 : x < y;
+}
+
+/* Fill in the statistics of runs samples, which are sorted in place */
+static void computeStats(vx_uint64 *samples, vx_uint32 runs, struct node_perf_stats *stats)
+{
+    vx_uint32 i;
+    stats->runs = runs;
+    stats->min = stats->p50 = stats->p95 = stats->p99 = stats->max = stats->total = 0;
+    stats->avg = 0;
+    if (0 == runs)
+        return;
+    qsort(samples, runs, sizeof(vx_uint64), compareSamples);
+    for (i = 0; i < runs; ++i)
+        stats->total += samples[i];
+    /* Nearest-rank percentiles */
+    stats->min = samples[0];
+    stats->p50 = samples[(runs - 1) * 50 / 100];
+    stats->p95 = samples[(runs - 1) * 95 / 100];
+    stats->p99 = samples[(runs - 1) * 99 / 100];
+    stats->max = samples[runs - 1];
+    stats->avg = (double)stats->total / runs;
+}
+
+/* Compute the statistics of every node, and of every kernel with the samples of all its nodes. The arrays are
+   sorted slowest first and must be freed by the caller. */
+static vx_status collectStats(struct node_perf_report *report, struct node_perf_stats **node_stats,
+                              struct node_perf_stats **kernel_stats, vx_uint32 *num_kernels)
+{
+    vx_uint32 i, j, total_runs = 0;
+    vx_uint64 *work;
+    for (i = 0; i < report->count; ++i)
+        total_runs += report->nodes[i].count;
+    *node_stats = (struct node_perf_stats *)calloc(report->count + 1, sizeof(struct node_perf_stats));
+    *kernel_stats = (struct node_perf_stats *)calloc(report->count + 1, sizeof(struct node_perf_stats));
+    work = (vx_uint64 *)malloc((total_runs + 1) * sizeof(vx_uint64));
+    *num_kernels = 0;
+    if (!*node_stats || !*kernel_stats || !work)
+    {
+        free(*node_stats);
+        free(*kernel_stats);
+        free(work);
+        *node_stats = *kernel_stats = NULL;
+        return VX_ERROR_NO_MEMORY;
+    }
+    for (i = 0; i < report->count; ++i)
+    {
+        struct node_perf_entry *entry = &report->nodes[i];
+        struct node_perf_stats *stats = &(*node_stats)[i];
+        if (entry->count)
+            memcpy(work, entry->samples, entry->count * sizeof(vx_uint64));
+        computeStats(work, entry->count, stats);
+        stats->graph = entry->graph;
+        stats->name = entry->name;
+        stats->kernel = entry->kernel;
+        stats->nodes = 1;
+    }
+    for (i = 0; i < report->count; ++i)
+    {
+        /* The first node of each kernel gathers the samples of the others */
+        vx_uint32 runs = 0;
+        struct node_perf_stats *stats;
+        for (j = 0; j < i && strcmp(report->nodes[j].kernel, report->nodes[i].kernel); ++j)
+            ;
+        if (j < i)
+            continue;
+        stats = &(*kernel_stats)[(*num_kernels)++];
+        stats->kernel = report->nodes[i].kernel;
+        for (j = i; j < report->count; ++j)
+        {
+            if (strcmp(report->nodes[j].kernel, report->nodes[i].kernel))
+                continue;
+            if (report->nodes[j].count)
+                memcpy(work + runs, report->nodes[j].samples, report->nodes[j].count * sizeof(vx_uint64));
+            runs += report->nodes[j].count;
+            stats->nodes++;
+        }
+        computeStats(work, runs, stats);
+    }
+    free(work);
+    qsort(*node_stats, report->count, sizeof(struct node_perf_stats), compareTotals);
+    qsort(*kernel_stats, *num_kernels, sizeof(struct node_perf_stats), compareTotals);
+    return VX_SUCCESS;
+}
+
+static vx_uint64 totalTime(struct node_perf_stats *stats, vx_uint32 count)
+{
+    vx_uint64 total = 0;
+    vx_uint32 i;
+    for (i = 0; i < count; ++i)
+        total += stats[i].total;
+    return total;
+}
+
+/* Write a string as a quoted CSV or JSON field */
+static void writeQuoted(FILE *f, const char *s, int json)
+{
+    fputc('"', f);
+    for (; s && *s; ++s)
+    {
+        if ('"' == *s)
+            fputs(json ? "\\\"" : "\"\"", f);
+        else if ('\\' == *s && json)
+            fputs("\\\\", f);
+        else
+            fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static void writeStatsCSV(FILE *f, const char *scope, struct node_perf_stats *stats, vx_uint64 total)
+{
+    fprintf(f, "%s,", scope);
+    writeQuoted(f, stats->graph ? stats->graph : "", 0);
+    fputc(',', f);
+    writeQuoted(f, stats->name ? stats->name : "", 0);
+    fputc(',', f);
+    writeQuoted(f, stats->kernel, 0);
+    fprintf(f, ",%u,%u,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.2f\n", stats->nodes, stats->runs, stats->min * 1e-6,
+            stats->avg * 1e-6, stats->p50 * 1e-6, stats->p95 * 1e-6, stats->p99 * 1e-6, stats->max * 1e-6,
+            stats->total * 1e-6, total ? 100.0 * stats->total / total : 0.0);
+}
+
+static void writeStatsJSON(FILE *f, struct node_perf_stats *stats, vx_uint64 total, int last)
+{
+    fputs("    {", f);
+    if (stats->name)
+    {
+        fputs("\"graph\": ", f);
+        writeQuoted(f, stats->graph, 1);
+        fputs(", \"node\": ", f);
+        writeQuoted(f, stats->name, 1);
+        fputs(", ", f);
+    }
+    fputs("\"kernel\": ", f);
+    writeQuoted(f, stats->kernel, 1);
+    fprintf(f, ", \"nodes\": %u, \"runs\": %u, \"min_ms\": %.6f, \"avg_ms\": %.6f, \"p50_ms\": %.6f, "
+            "\"p95_ms\": %.6f, \"p99_ms\": %.6f, \"max_ms\": %.6f, \"total_ms\": %.6f, \"share_pct\": %.2f}%s\n",
+            stats->nodes, stats->runs, stats->min * 1e-6, stats->avg * 1e-6, stats->p50 * 1e-6,
+            stats->p95 * 1e-6, stats->p99 * 1e-6, stats->max * 1e-6, stats->total * 1e-6,
+            total ? 100.0 * stats->total / total : 0.0, last ? "" : ",");
+}
+
+static void printStats(const char *label, struct node_perf_stats *stats, vx_uint64 total)
+{
+    printf("%-40.40s %7u %9.3f %9.3f %9.3f %9.3f %9.3f %6.1f%%\n", label, stats->runs, stats->min * 1e-6,
+           stats->avg * 1e-6, stats->p50 * 1e-6, stats->p95 * 1e-6, stats->max * 1e-6,
+           total ? 100.0 * stats->total / total : 0.0);
+}
+
+struct node_perf_report *createNodePerfReport(vx_context context)
+{
+    /* Implementations are allowed not to measure unless asked; the directive fails harmlessly where unsupported */
+    vxDirective((vx_reference)context, VX_DIRECTIVE_ENABLE_PERFORMANCE);
+    return (struct node_perf_report *)calloc(1, sizeof(struct node_perf_report));
+}
+
+/* Name the kernel after the function called in call: drop the vx prefix and the Node or ::CreateNode suffix */
+static void kernelNameFromCall(const char *call, char *kernel, size_t size)
+{
+    const char *begin = call, *end;
+    size_t length;
+    while (isspace((unsigned char)*begin))
+        ++begin;
+    end = begin;
+    while (isalnum((unsigned char)*end) || '_' == *end || ':' == *end)
+        ++end;
+    length = (size_t)(end - begin);
+    if (length > 12 && 0 == strncmp(end - 12, "::CreateNode", 12))
+        length -= 12;
+    else if (length > 4 && 0 == strncmp(end - 4, "Node", 4))
+        length -= 4;
+    if (length > 2 && 'v' == begin[0] && 'x' == begin[1] && isupper((unsigned char)begin[2]))
+    {
+        begin += 2;
+        length -= 2;
+    }
+    if (0 == length)
+        snprintf(kernel, size, "%s", "kernel");
+    else
+        snprintf(kernel, size, "%.*s", (int)length, begin);
+}
+
+vx_node addNodeToPerfReportAs(struct node_perf_report *report, const char *graph_name, vx_node node,
+                              const char *kernel_name)
+{
+    struct node_perf_entry *entry;
+    vx_char *name = NULL;
+    vx_perf_t perf;
+    if (!report || VX_SUCCESS != vxGetStatus((vx_reference)node))
+        return node;
+    if (report->count == report->capacity)
+    {
+        vx_uint32 capacity = report->capacity ? report->capacity * 2 : 16;
+        struct node_perf_entry *grown = (struct node_perf_entry *)realloc(report->nodes,
+                                                                         capacity * sizeof(struct node_perf_entry));
+        if (!grown)
+            return node;
+        report->nodes = grown;
+        report->capacity = capacity;
+    }
+    entry = &report->nodes[report->count];
+    memset(entry, 0, sizeof(struct node_perf_entry));
+    snprintf(entry->graph, sizeof(entry->graph), "%s", graph_name ? graph_name : "graph");
+    snprintf(entry->kernel, sizeof(entry->kernel), "%s", kernel_name && kernel_name[0] ? kernel_name : "kernel");
+    /* Use the node name if the application has set one, otherwise the kernel name and the position */
+    if (VX_SUCCESS == vxQueryReference((vx_reference)node, VX_REFERENCE_NAME, &name, sizeof(name)) &&
+        name && name[0])
+        snprintf(entry->name, sizeof(entry->name), "%s", name);
+    else
+    {
+        const char *short_name = strrchr(entry->kernel, '.');
+        snprintf(entry->name, sizeof(entry->name), "%.50s#%u", short_name ? short_name + 1 : entry->kernel,
+                 report->count);
+    }
+    /* Runs before the node was added are not sampled */
+    if (VX_SUCCESS == vxQueryNode(node, VX_NODE_PERFORMANCE, &perf, sizeof(perf)))
+        entry->last_num = perf.num;
+    vxRetainReference((vx_reference)node);
+    entry->node = node;
+    report->count++;
+    return node;
+}
+
+vx_node addNodeToPerfReportCall(struct node_perf_report *report, const char *graph_name, vx_node node,
+                                const char *call)
+{
+    char kernel[VX_MAX_KERNEL_NAME];
+    kernelNameFromCall(call, kernel, sizeof(kernel));
+    return addNodeToPerfReportAs(report, graph_name, node, kernel);
+}
+
+void sampleNodePerfReport(struct node_perf_report *report)
+{
+    vx_uint32 i;
+    for (i = 0; report && i < report->count; ++i)
+    {
+        struct node_perf_entry *entry = &report->nodes[i];
+        vx_perf_t perf;
+        if (VX_SUCCESS != vxQueryNode(entry->node, VX_NODE_PERFORMANCE, &perf, sizeof(perf)) ||
+            perf.num == entry->last_num)
+            continue;
+        entry->last_num = perf.num;
+        if (entry->count == entry->capacity)
+        {
+            vx_uint32 capacity = entry->capacity ? entry->capacity * 2 : 256;
+            vx_uint64 *grown = (vx_uint64 *)realloc(entry->samples, capacity * sizeof(vx_uint64));
+            if (!grown)
+                continue;
+            entry->samples = grown;
+            entry->capacity = capacity;
+        }
+        entry->samples[entry->count++] = perf.tmp;
+    }
+}
+
+void printNodePerfReport(struct node_perf_report *report)
+{
+    struct node_perf_stats *node_stats, *kernel_stats;
+    vx_uint32 num_kernels, i;
+    vx_uint64 total;
+    char label[2 * NODE_PERF_NAME_SIZE + 2];
+    if (!report || VX_SUCCESS != collectStats(report, &node_stats, &kernel_stats, &num_kernels))
+        return;
+    total = totalTime(node_stats, report->count);
+    printf("%-40s %7s %9s %9s %9s %9s %9s %7s\n", "Node", "Runs", "Min(ms)", "Avg(ms)", "P50(ms)", "P95(ms)",
+           "Max(ms)", "Share");
+    for (i = 0; i < report->count; ++i)
+    {
+        snprintf(label, sizeof(label), "%s/%s", node_stats[i].graph, node_stats[i].name);
+        printStats(label, &node_stats[i], total);
+    }
+    printf("%-40s %7s %9s %9s %9s %9s %9s %7s\n", "Kernel", "Runs", "Min(ms)", "Avg(ms)", "P50(ms)", "P95(ms)",
+           "Max(ms)", "Share");
+    for (i = 0; i < num_kernels; ++i)
+        printStats(kernel_stats[i].kernel, &kernel_stats[i], total);
+    free(node_stats);
+    free(kernel_stats);
+}
+
+vx_status writeNodePerfReport(struct node_perf_report *report, const char *filename)
+{
+    struct node_perf_stats *node_stats, *kernel_stats;
+    vx_uint32 num_kernels, i;
+    vx_uint64 total;
+    size_t len = strlen(filename);
+    int json = len > 5 && 0 == strcmp(filename + len - 5, ".json");
+    vx_status status;
+    FILE *f;
+    if (!report)
+        return VX_ERROR_INVALID_PARAMETERS;
+    status = collectStats(report, &node_stats, &kernel_stats, &num_kernels);
+    if (VX_SUCCESS != status)
+        return status;
+    f = fopen(filename, "w");
+    if (!f)
+    {
+        free(node_stats);
+        free(kernel_stats);
+        return VX_FAILURE;
+    }
+    total = totalTime(node_stats, report->count);
+    if (json)
+    {
+        fputs("{\n  \"nodes\": [\n", f);
+        for (i = 0; i < report->count; ++i)
+            writeStatsJSON(f, &node_stats[i], total, i + 1 == report->count);
+        fputs("  ],\n  \"kernels\": [\n", f);
+        for (i = 0; i < num_kernels; ++i)
+            writeStatsJSON(f, &kernel_stats[i], total, i + 1 == num_kernels);
+        fputs("  ]\n}\n", f);
+    }
+    else
+    {
+        fputs("scope,graph,node,kernel,nodes,runs,min_ms,avg_ms,p50_ms,p95_ms,p99_ms,max_ms,total_ms,share_pct\n", f);
+        for (i = 0; i < report->count; ++i)
+            writeStatsCSV(f, "node", &node_stats[i], total);
+        for (i = 0; i < num_kernels; ++i)
+            writeStatsCSV(f, "kernel", &kernel_stats[i], total);
+    }
+    status = ferror(f) ? VX_FAILURE : VX_SUCCESS;
+    if (fclose(f))
+        status = VX_FAILURE;
+    free(node_stats);
+    free(kernel_stats);
+    return status;
+}
+
+void releaseNodePerfReport(struct node_perf_report **report)
+{
+    vx_uint32 i;
+    struct node_perf_report *r = *report;
+    if (!r)
+        return;
+    for (i = 0; i < r->count; ++i)
+    {
+        vxReleaseNode(&r->nodes[i].node);
+        free(r->nodes[i].samples);
+    }
+    free(r->nodes);
+    free(r);
+    *report = NULL;
+}
@@ -0,0 +1,58 @@
+/*
+nodePerf.h
+Collect the execution time of every node of one or more graphs over many runs, and report min/avg/max and
+percentiles per node and per kernel, on the console or as a CSV or JSON file.
+
+OpenVX has no way to list the nodes of a graph, so nodes are added to the report as they are created; the
+report keeps its own reference to them. Typical use:
+
+    struct node_perf_report *report = createNodePerfReport(context);
+    vxReleaseNode(addNodeToPerfReport(report, "main", vxSobel3x3Node(graph, in, gx, gy)));
+    ...
+    vxProcessGraph(graph);
+    sampleNodePerfReport(report);
+    ...
+    printNodePerfReport(report);
+    releaseNodePerfReport(&report);
+*/
+#ifndef _nodePerf_h_included_
+#define _nodePerf_h_included_
+#include <VX/vx.h>
+#ifdef  __cplusplus
+extern "C" {
+#endif
+/* Opaque handle to a report */
+struct node_perf_report;
+
+/* Create an empty report, and enable performance measurement on the context */
+struct node_perf_report *createNodePerfReport(vx_context context);
+
+/* Add a node of the graph called graph_name, under the kernel called kernel_name. The node is returned so that
+   the call can wrap the node creation. Invalid nodes are returned but not added. */
+vx_node addNodeToPerfReportAs(struct node_perf_report *report, const char *graph_name, vx_node node,
+                              const char *kernel_name);
+
+/* Add a node created by the call given as node, under a kernel named after the function called: OpenVX cannot
+   tell the kernel of a node, so the text of the call is used instead. vxSobel3x3Node(graph, in, gx, gy) is
+   reported as Sobel3x3, and CosKernel::CreateNode(graph, in, out) as CosKernel. */
+#define addNodeToPerfReport(report, graph_name, node) \
+    addNodeToPerfReportCall((report), (graph_name), (node), #node)
+vx_node addNodeToPerfReportCall(struct node_perf_report *report, const char *graph_name, vx_node node,
+                                const char *call);
+
+/* Record the last execution time of every node that has run since the previous call. Call after each
+   vxProcessGraph or vxWaitGraph; nodes of graphs that did not run are skipped. */
+void sampleNodePerfReport(struct node_perf_report *report);
+
+/* Print a table of the nodes and of the kernels, slowest first, to stdout */
+void printNodePerfReport(struct node_perf_report *report);
+
+/* Write the same statistics to filename, as JSON if the name ends in .json and as CSV otherwise */
+vx_status writeNodePerfReport(struct node_perf_report *report, const char *filename);
+
+/* Release the node references and free the report */
+void releaseNodePerfReport(struct node_perf_report **report);
+#ifdef  __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,111 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+/*!
+ * \file    hard_sigmoid_cpu.cpp
+ * \brief   CPU implementation of the 16-bit fixed-point (Q7.8) hard_sigmoid
+ */
+
+#include "hard_sigmoid_cpu.h"
+#include "row_thread_pool.h"
+#include <algorithm>
+#if __AVX2__
+#include <immintrin.h>
+#elif __SSE2__
+#include <emmintrin.h>
+#endif
+
+////
+// compute one row of n elements:
+//   in Q7.8, y * 256 = min(max(alpha * (x * 256) + beta * 256, 0), 256),
+//   so the fixed-point values are used directly as floats, and the result
+//   is truncated like the "(short)(y * 256.0)" of the OpenCL kernel
+//
+static void hard_sigmoid_row(float alpha, float beta_q, const short * x, short * y, size_t n)
+{
+    size_t i = 0;
+#if __AVX2__
+    const __m256 valpha = _mm256_set1_ps(alpha);
+    const __m256 vbeta = _mm256_set1_ps(beta_q);
+    const __m256 vzero = _mm256_setzero_ps();
+    const __m256 vone = _mm256_set1_ps(256.0f);
+    for(; i + 16 <= n; i += 16) {
+        __m256i xi = _mm256_loadu_si256((const __m256i *)(x + i));
+        __m256 x0 = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(xi)));
+        __m256 x1 = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(xi, 1)));
+        __m256 y0 = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(x0, valpha), vbeta), vzero), vone);
+        __m256 y1 = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(x1, valpha), vbeta), vzero), vone);
+        // packs works within 128-bit lanes: restore the element order
+        __m256i yi = _mm256_packs_epi32(_mm256_cvttps_epi32(y0), _mm256_cvttps_epi32(y1));
+        _mm256_storeu_si256((__m256i *)(y + i), _mm256_permute4x64_epi64(yi, 0xd8));
+    }
+#elif __SSE2__
+    const __m128 valpha = _mm_set1_ps(alpha);
+    const __m128 vbeta = _mm_set1_ps(beta_q);
+    const __m128 vzero = _mm_setzero_ps();
+    const __m128 vone = _mm_set1_ps(256.0f);
+    for(; i + 8 <= n; i += 8) {
+        __m128i xi = _mm_loadu_si128((const __m128i *)(x + i));
+        // sign-extend 16-bit to 32-bit: put each value in the upper half and shift down
+        __m128 x0 = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(xi, xi), 16));
+        __m128 x1 = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(xi, xi), 16));
+        __m128 y0 = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(x0, valpha), vbeta), vzero), vone);
+        __m128 y1 = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(x1, valpha), vbeta), vzero), vone);
+        _mm_storeu_si128((__m128i *)(y + i), _mm_packs_epi32(_mm_cvttps_epi32(y0), _mm_cvttps_epi32(y1)));
+    }
+#endif
+    for(; i < n; i++) {
+        float value = alpha * x[i] + beta_q;
+        value = std::min(std::max(value, 0.0f), 256.0f);
+        y[i] = (short)value;
+    }
+}
+
+////
+// compute rows [begin, end) of the tensor, numbered over dims[1] * dims[2] * dims[3]
+//
+static void hard_sigmoid_rows(float alpha, float beta_q,
+                const short * x, const size_t * x_stride,
+                short * y, const size_t * y_stride,
+                const size_t * dims, size_t begin, size_t end)
+{
+    for(size_t row = begin; row < end; row++) {
+        size_t j = row % dims[1], k = (row / dims[1]) % dims[2], n = row / dims[1] / dims[2];
+        hard_sigmoid_row(alpha, beta_q,
+                (const short *)((const char *)x + n * x_stride[3] + k * x_stride[2] + j * x_stride[1]),
+                (short *)((char *)y + n * y_stride[3] + k * y_stride[2] + j * y_stride[1]),
+                dims[0]);
+    }
+}
+
+void hard_sigmoid_cpu(float alpha, float beta,
+                const short * x, const size_t x_stride[4],
+                short * y, const size_t y_stride[4],
+                const size_t dims[4], unsigned num_threads)
+{
+    ////
+    // split rows between the threads of the tutorial's row thread pool
+    //
+    float beta_q = beta * 256.0f;
+    CRowThreadPool::ForRows(dims[1] * dims[2] * dims[3], dims[0], [&](size_t begin, size_t end) {
+        hard_sigmoid_rows(alpha, beta_q, x, x_stride, y, y_stride, dims, begin, end);
+    }, num_threads);
+}
@@ -0,0 +1,48 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+/*!
+ * \file    hard_sigmoid_cpu.h
+ * \brief   CPU implementation of the 16-bit fixed-point (Q7.8) hard_sigmoid
+ *          activation function, used when no OpenCL device is available
+ */
+
+#ifndef hard_sigmoid_cpu_h__
+#define hard_sigmoid_cpu_h__
+
+#include <stddef.h>
+
+////
+// compute Y = min(max(alpha * X + beta, 0), 1) for 4-dimensional Q7.8 tensors
+//   - dims[3] is the batch size (1 for a 3-dimensional tensor)
+//   - x_stride & y_stride are the byte strides of each dimension
+//     (the stride of dimension 0 must be sizeof(short))
+//   - the rows (dimensions 1 to 3) are split between num_threads threads,
+//     or one thread per processor core if num_threads is 0, so that the
+//     items of a batch are processed on separate threads
+//   - each row is processed with SSE2/AVX2 when the compiler targets them
+//
+void hard_sigmoid_cpu(float alpha, float beta,
+                const short * x, const size_t x_stride[4],
+                short * y, const size_t y_stride[4],
+                const size_t dims[4], unsigned num_threads);
+
+#endif
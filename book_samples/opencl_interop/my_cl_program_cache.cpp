@@ -0,0 +1,255 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+/*!
+ * \file    my_cl_program_cache.cpp
+ * \brief   On-disk cache of OpenCL program binaries
+ */
+
+#include "my_cl_program_cache.h"
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+////
+// constants
+//
+#define CACHE_FILE_MAGIC   "MYCLBIN1"
+
+////
+// cache hit/miss counters
+//
+static std::atomic<size_t> my_cache_hits(0);
+static std::atomic<size_t> my_cache_misses(0);
+
+////
+// get a string attribute of the device
+//
+static std::string myClGetDeviceString(cl_device_id device, cl_device_info param_name)
+{
+    size_t size = 0;
+    if(clGetDeviceInfo(device, param_name, 0, NULL, &size) != CL_SUCCESS || size == 0)
+        return std::string();
+    std::vector<char> value(size);
+    if(clGetDeviceInfo(device, param_name, size, &value[0], NULL) != CL_SUCCESS)
+        return std::string();
+    return std::string(&value[0]);
+}
+
+////
+// 64-bit FNV-1a hash, used to name the cache files
+//
+static uint64_t myHash(const std::string& key)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for(size_t i = 0; i < key.size(); i++) {
+        hash ^= (uint8_t)key[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+////
+// the cache key: everything that changes the program binary
+//
+static std::string myClProgramCacheKey(cl_device_id device,
+                const char * source, size_t source_size, const char * options)
+{
+    std::string key;
+    key += myClGetDeviceString(device, CL_DEVICE_NAME) + '\n';
+    key += myClGetDeviceString(device, CL_DEVICE_VENDOR) + '\n';
+    key += myClGetDeviceString(device, CL_DEVICE_VERSION) + '\n';
+    key += myClGetDeviceString(device, CL_DRIVER_VERSION) + '\n';
+    key += std::string(options ? options : "") + '\n';
+    key += std::string(source, source_size);
+    return key;
+}
+
+////
+// the cache file for a key, or an empty string if the cache is disabled
+//
+static std::string myClProgramCacheFile(const std::string& key)
+{
+    const char * dir = getenv(MY_CL_PROGRAM_CACHE_DIR_ENV);
+    if(!dir || !dir[0])
+        return std::string();
+    char name[64];
+    sprintf(name, "clprogram-%016llx.bin", (unsigned long long)myHash(key));
+    return std::string(dir) + "/" + name;
+}
+
+////
+// cache file format:
+//   CACHE_FILE_MAGIC, uint64 key size, key, uint64 binary size, binary
+//
+static bool myReadCacheFile(const std::string& file_name, const std::string& key,
+                std::vector<unsigned char>& binary)
+{
+    FILE * fp = fopen(file_name.c_str(), "rb");
+    if(!fp)
+        return false;
+    bool ok = false;
+    char magic[sizeof(CACHE_FILE_MAGIC) - 1];
+    uint64_t key_size = 0, binary_size = 0;
+    if(fread(magic, sizeof(magic), 1, fp) == 1 &&
+       !memcmp(magic, CACHE_FILE_MAGIC, sizeof(magic)) &&
+       fread(&key_size, sizeof(key_size), 1, fp) == 1 &&
+       key_size == key.size())
+    {
+        std::vector<char> file_key(key_size + 1);
+        if(fread(&file_key[0], 1, key_size, fp) == key_size &&
+           !memcmp(&file_key[0], key.data(), key_size) &&
+           fread(&binary_size, sizeof(binary_size), 1, fp) == 1 &&
+           binary_size > 0)
+        {
+            binary.resize(binary_size);
+            ok = fread(&binary[0], 1, binary_size, fp) == binary_size;
+        }
+    }
+    fclose(fp);
+    return ok;
+}
+
+static void myWriteCacheFile(const std::string& file_name, const std::string& key,
+                const std::vector<unsigned char>& binary)
+{
+    // write into a temporary file and rename it, so that another process
+    // never reads a partially written cache file; the process id keeps two
+    // processes that miss on the same program from writing the same file
+    char suffix[32];
+    sprintf(suffix, ".%d.tmp", (int)getpid());
+    std::string temp_name = file_name + suffix;
+    FILE * fp = fopen(temp_name.c_str(), "wb");
+    if(!fp)
+        return;
+    uint64_t key_size = key.size(), binary_size = binary.size();
+    bool ok = fwrite(CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC) - 1, 1, fp) == 1 &&
+              fwrite(&key_size, sizeof(key_size), 1, fp) == 1 &&
+              fwrite(key.data(), 1, key.size(), fp) == key.size() &&
+              fwrite(&binary_size, sizeof(binary_size), 1, fp) == 1 &&
+              fwrite(&binary[0], 1, binary.size(), fp) == binary.size();
+    ok = (fclose(fp) == 0) && ok;
+    if(!ok || rename(temp_name.c_str(), file_name.c_str()) != 0) {
+        remove(temp_name.c_str());
+    }
+}
+
+////
+// build the program from the cached binary: returns NULL if the binary
+//   is missing or rejected by the OpenCL driver
+//
+static cl_program myClBuildProgramFromCache(cl_context context, cl_device_id device,
+                const char * options, const std::string& file_name, const std::string& key)
+{
+    std::vector<unsigned char> binary;
+    if(file_name.empty() || !myReadCacheFile(file_name, key, binary))
+        return NULL;
+    const unsigned char * binaries[] = { &binary[0] };
+    size_t binary_sizes[] = { binary.size() };
+    cl_int binary_status, err;
+    cl_program program = clCreateProgramWithBinary(context, 1, &device,
+            binary_sizes, binaries, &binary_status, &err);
+    if(err != CL_SUCCESS)
+        return NULL;
+    if(binary_status != CL_SUCCESS) {
+        clReleaseProgram(program);
+        return NULL;
+    }
+    if(clBuildProgram(program, 1, &device, options, NULL, NULL) != CL_SUCCESS) {
+        clReleaseProgram(program);
+        return NULL;
+    }
+    return program;
+}
+
+////
+// save the binary of a program built from source
+//
+static void myClSaveProgramToCache(cl_program program,
+                const std::string& file_name, const std::string& key)
+{
+    size_t binary_size = 0;
+    if(file_name.empty() ||
+       clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size_t), &binary_size, NULL) != CL_SUCCESS ||
+       binary_size == 0)
+        return;
+    std::vector<unsigned char> binary(binary_size);
+    unsigned char * binaries[] = { &binary[0] };
+    if(clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(binaries), binaries, NULL) != CL_SUCCESS)
+        return;
+    myWriteCacheFile(file_name, key, binary);
+}
+
+cl_program myClBuildProgramWithCache(
+    cl_context                                  context,
+    cl_device_id                                device,
+    const char *                                source,
+    size_t                                      source_size,
+    const char *                                options,
+    cl_int *                                    errcode_ret)
+{
+    ////
+    // use the cached binary if available
+    //
+    std::string key = myClProgramCacheKey(device, source, source_size, options);
+    std::string file_name = myClProgramCacheFile(key);
+    cl_program program = myClBuildProgramFromCache(context, device, options, file_name, key);
+    if(program) {
+        my_cache_hits++;
+        *errcode_ret = CL_SUCCESS;
+        return program;
+    }
+    my_cache_misses++;
+
+    ////
+    // build from source and save the binary for the next time
+    //
+    const char * program_strings[] = { source };
+    size_t program_sizes[] = { source_size };
+    program = clCreateProgramWithSource(context, 1, program_strings, program_sizes, errcode_ret);
+    if(*errcode_ret != CL_SUCCESS)
+        return NULL;
+    *errcode_ret = clBuildProgram(program, 1, &device, options, NULL, NULL);
+    if(*errcode_ret != CL_SUCCESS) {
+        clReleaseProgram(program);
+        return NULL;
+    }
+    myClSaveProgramToCache(program, file_name, key);
+    return program;
+}
+
+void myClGetProgramCacheCounters(
+    size_t *                                    hits,
+    size_t *                                    misses)
+{
+    *hits = my_cache_hits;
+    *misses = my_cache_misses;
+}
@@ -0,0 +1,79 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+/*!
+ * \file    my_cl_program_cache.h
+ * \brief   On-disk cache of OpenCL program binaries, so that an OpenCL C
+ *          program is compiled only once for a device instead of every
+ *          time an application or a node is initialized
+ */
+
+#ifndef my_cl_program_cache_h__
+#define my_cl_program_cache_h__
+
+#if __APPLE__
+#include <OpenCL/cl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+////
+// cache location: the directory in MY_CL_PROGRAM_CACHE_DIR environment
+//   variable, which must exist; the cache is disabled if it is not set,
+//   so that the binaries never land in the current directory by accident
+//
+#define MY_CL_PROGRAM_CACHE_DIR_ENV   "MY_CL_PROGRAM_CACHE_DIR"
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+////
+// create and build an OpenCL program for one device, the same as
+//   clCreateProgramWithSource + clBuildProgram, except that:
+//   1. on a cache hit, the program is created with clCreateProgramWithBinary
+//      from the binary saved for the same source, build options and device
+//   2. on a cache miss, the program is built from source and its
+//      CL_PROGRAM_BINARIES are saved in the cache
+//   the cache is keyed on a hash of the source, build options and device
+//   (name, vendor, version and driver version), and the full key is stored
+//   in the cache file and checked on load
+//
+cl_program myClBuildProgramWithCache(
+    cl_context                                  context,
+    cl_device_id                                device,
+    const char *                                source,
+    size_t                                      source_size,
+    const char *                                options,
+    cl_int *                                    errcode_ret);
+
+////
+// get the number of cache hits and misses of myClBuildProgramWithCache
+//
+void myClGetProgramCacheCounters(
+    size_t *                                    hits,
+    size_t *                                    misses);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
@@ -21,21 +21,36 @@
 
 /*!
  * \file    my_vx_tensor_map_impl.c
- * \brief   This is a simple reference implementation (not optimized)
- *          to demonstrate vxMapTensorPatch functionality, since it is
- *          not yet available in KhronosGroup/OpenVX-sample-impl repo
+ * \brief   This is a reference implementation to demonstrate
+ *          vxMapTensorPatch functionality, since it is not yet
+ *          available in KhronosGroup/OpenVX-sample-impl repo
  * \author  Radhakrishna Giduthuri <radhakrishna.giduthuri@ieee.org>
  */
 
 #include <VX/vx_khr_opencl_interop.h>
 #include "my_vx_tensor_map_impl.h"
 #include "common.h"
+#include <map>
+#include <mutex>
 
 ////
 // constants
 //
 #define MAX_TENSOR_DIMS   6
 
+////
+// mapping buffer of a tensor: the OpenVX internal buffer of a tensor is not
+//   accessible through the standard API, so the data is copied through this
+//   buffer, which is kept from one map to the next instead of being created
+//   and released every time
+//
+struct my_vx_tensor_map_buffer {
+    vx_enum mem_type;
+    vx_size size;
+    void * ptr;
+    bool in_use;
+};
+
 ////
 // local data structure to pass data between vxMapTensorPatch & vxUnmapTensorPatch
 //
@@ -44,15 +59,142 @@ struct my_vx_tensor_map_id {
     vx_size view_start[MAX_TENSOR_DIMS];
     vx_size view_end[MAX_TENSOR_DIMS];
     vx_size stride[MAX_TENSOR_DIMS];
-    void * ptr;
+    my_vx_tensor_map_buffer * buffer;
+    bool cached;
     vx_enum usage;
     vx_enum mem_type;
 };
 
 ////
-// simple reference implementation (not optimized) for vxMapTensorPatch
-//   this creates a temporary buffer and uses a copy, instead of returning
-//   OpenVX internal buffer allocated for the tensor (so the copy overheads)
+// mapping buffers cached per tensor and memory type
+//
+typedef std::map<std::pair<vx_tensor, vx_enum>, my_vx_tensor_map_buffer *> my_vx_tensor_map_cache;
+static my_vx_tensor_map_cache my_map_cache;
+static std::mutex my_map_cache_mutex;
+
+////
+// size of an element of a tensor data type
+//
+static vx_size myVxTensorElementSize(vx_enum data_type)
+{
+    switch(data_type) {
+        case VX_TYPE_INT8:    return sizeof(vx_int8);
+        case VX_TYPE_UINT8:   return sizeof(vx_uint8);
+        case VX_TYPE_INT16:   return sizeof(vx_int16);
+        case VX_TYPE_UINT16:  return sizeof(vx_uint16);
+        case VX_TYPE_INT32:   return sizeof(vx_int32);
+        case VX_TYPE_UINT32:  return sizeof(vx_uint32);
+        case VX_TYPE_FLOAT32: return sizeof(vx_float32);
+        case VX_TYPE_INT64:   return sizeof(vx_int64);
+        case VX_TYPE_UINT64:  return sizeof(vx_uint64);
+        case VX_TYPE_FLOAT64: return sizeof(vx_float64);
+        default:              return 0;
+    }
+}
+
+////
+// allocate & release the memory of a mapping buffer
+//
+static vx_status myVxAllocMapBuffer(vx_tensor tensor, my_vx_tensor_map_buffer * buffer)
+{
+    if(buffer->mem_type == VX_MEMORY_TYPE_OPENCL_BUFFER)
+    {
+        vx_context context = vxGetContext((vx_reference)tensor);
+        cl_context opencl_ctx;
+        ERROR_CHECK_STATUS_RET( vxQueryContext(context, VX_CONTEXT_CL_CONTEXT, &opencl_ctx, sizeof(cl_context)) );
+        cl_int err;
+        buffer->ptr = clCreateBuffer(opencl_ctx, CL_MEM_READ_WRITE, buffer->size, NULL, &err);
+        ERROR_CHECK_STATUS_RET( err );
+    }
+    else
+    {
+        buffer->ptr = new vx_uint8[buffer->size];
+    }
+    return VX_SUCCESS;
+}
+
+static vx_status myVxReleaseMapBuffer(my_vx_tensor_map_buffer * buffer)
+{
+    if(buffer->ptr)
+    {
+        if(buffer->mem_type == VX_MEMORY_TYPE_OPENCL_BUFFER) {
+            ERROR_CHECK_STATUS_RET( clReleaseMemObject((cl_mem)buffer->ptr) );
+        }
+        else {
+            delete[] (vx_uint8 *)buffer->ptr;
+        }
+        buffer->ptr = NULL;
+    }
+    return VX_SUCCESS;
+}
+
+////
+// get a mapping buffer of at least size bytes for the tensor:
+//   the cached buffer of the tensor if it is not in use (i.e., the same tensor
+//   is not mapped twice at the same time), otherwise a temporary buffer
+//
+static vx_status myVxGetMapBuffer(vx_tensor tensor, vx_enum mem_type, vx_size size, my_vx_tensor_map_id * id)
+{
+    std::lock_guard<std::mutex> lock(my_map_cache_mutex);
+    my_vx_tensor_map_buffer *& cached = my_map_cache[std::make_pair(tensor, mem_type)];
+    if(!cached) {
+        cached = new my_vx_tensor_map_buffer;
+        cached->mem_type = mem_type;
+        cached->size = 0;
+        cached->ptr = NULL;
+        cached->in_use = false;
+    }
+    if(!cached->in_use) {
+        if(cached->size < size) {
+            ERROR_CHECK_STATUS_RET( myVxReleaseMapBuffer(cached) );
+            cached->size = size;
+            vx_status status = myVxAllocMapBuffer(tensor, cached);
+            if(status != VX_SUCCESS) {
+                cached->size = 0;
+                return status;
+            }
+        }
+        cached->in_use = true;
+        id->buffer = cached;
+        id->cached = true;
+    }
+    else {
+        my_vx_tensor_map_buffer * buffer = new my_vx_tensor_map_buffer;
+        buffer->mem_type = mem_type;
+        buffer->size = size;
+        buffer->ptr = NULL;
+        buffer->in_use = true;
+        vx_status status = myVxAllocMapBuffer(tensor, buffer);
+        if(status != VX_SUCCESS) {
+            delete buffer;
+            return status;
+        }
+        id->buffer = buffer;
+        id->cached = false;
+    }
+    return VX_SUCCESS;
+}
+
+////
+// give the mapping buffer back: the cached buffer is kept for the next map
+//
+static vx_status myVxPutMapBuffer(my_vx_tensor_map_id * id)
+{
+    std::lock_guard<std::mutex> lock(my_map_cache_mutex);
+    if(id->cached) {
+        id->buffer->in_use = false;
+    }
+    else {
+        ERROR_CHECK_STATUS_RET( myVxReleaseMapBuffer(id->buffer) );
+        delete id->buffer;
+    }
+    return VX_SUCCESS;
+}
+
+////
+// reference implementation for vxMapTensorPatch
+//   this returns a mapping buffer cached for the tensor, with the patch
+//   copied into it only if the usage reads the data
 //
 vx_status myVxMapTensorPatch(
     vx_tensor                                   tensor,
@@ -66,69 +208,54 @@ vx_status myVxMapTensorPatch(
     vx_enum                                     mem_type)
 {
     ////
-    // calculate output stride values
+    // calculate output stride values of the patch
     //
     vx_enum data_type;
     vx_size dims[MAX_TENSOR_DIMS];
-    ERROR_CHECK_STATUS( vxQueryTensor(tensor, VX_TENSOR_DATA_TYPE, &data_type, sizeof(vx_enum)) );
-    ERROR_CHECK_STATUS( vxQueryTensor(tensor, VX_TENSOR_DIMS, &dims, sizeof(vx_size)*number_of_dims) );
-    switch(data_type) {
-        case VX_TYPE_INT16: stride[0] = sizeof(vx_int16); break;
-        case VX_TYPE_UINT8: stride[0] = sizeof(vx_uint8); break;
-        default: return VX_ERROR_NOT_SUPPORTED;
-    }
-    for(size_t dim = 1; dim < number_of_dims; dim++) {
-        stride[dim] = dims[dim-1] * stride[dim-1];
-    }
-    vx_size size = dims[number_of_dims-1] * stride[number_of_dims-1];
+    if(number_of_dims < 1 || number_of_dims > MAX_TENSOR_DIMS)
+        return VX_ERROR_INVALID_DIMENSION;
+    ERROR_CHECK_STATUS_RET( vxQueryTensor(tensor, VX_TENSOR_DATA_TYPE, &data_type, sizeof(vx_enum)) );
+    ERROR_CHECK_STATUS_RET( vxQueryTensor(tensor, VX_TENSOR_DIMS, &dims, sizeof(vx_size)*number_of_dims) );
+    vx_size element_size = myVxTensorElementSize(data_type);
+    if(element_size == 0)
+        return VX_ERROR_NOT_SUPPORTED;
 
     ////
-    // create map_id and allocate temporary buffers to return
+    // create map_id and get the mapping buffer to return
     //
     my_vx_tensor_map_id * id = new my_vx_tensor_map_id;
-    ERROR_CHECK_NOT_NULL( id );
     id->number_of_dims = number_of_dims;
     id->usage = usage;
     id->mem_type = mem_type;
-    if(id->mem_type == VX_MEMORY_TYPE_OPENCL_BUFFER)
-    {
-        vx_context context = vxGetContext((vx_reference)tensor);
-        cl_context opencl_ctx;
-        ERROR_CHECK_STATUS( vxQueryContext(context, VX_CONTEXT_CL_CONTEXT, &opencl_ctx, sizeof(cl_context)) );
-        cl_int err;
-        id->ptr = clCreateBuffer(opencl_ctx, CL_MEM_READ_WRITE, size, NULL, &err);
-        ERROR_CHECK_STATUS( err );
-    }
-    else
-    {
-        id->ptr = new vx_uint8[size];
-        ERROR_CHECK_NOT_NULL( id->ptr );
-    }
     for(size_t dim = 0; dim < number_of_dims; dim++) {
         id->view_start[dim] = view_start ? view_start[dim] : 0;
         id->view_end[dim] = view_end ? view_end[dim] : dims[dim];
-        id->stride[dim] = stride[dim];
+        id->stride[dim] = dim ? (id->view_end[dim-1] - id->view_start[dim-1]) * id->stride[dim-1] : element_size;
+        stride[dim] = id->stride[dim];
+    }
+    vx_size size = (id->view_end[number_of_dims-1] - id->view_start[number_of_dims-1]) * id->stride[number_of_dims-1];
+    vx_status status = myVxGetMapBuffer(tensor, mem_type, size, id);
+    if(status != VX_SUCCESS) {
+        delete id;
+        return status;
     }
     *map_id = (vx_map_id)id;
-    *ptr = id->ptr;
+    *ptr = id->buffer->ptr;
 
     ////
-    // copy tensor patch into temporarily allocated map buffer if read requested
+    // copy tensor patch into the mapping buffer if read requested:
+    //   with VX_WRITE_ONLY, the buffer contents are undefined until written
     //
     if(id->usage == VX_READ_ONLY || id->usage == VX_READ_AND_WRITE)
     {
-        vx_status status = vxCopyTensorPatch(tensor, id->number_of_dims,
-                    id->view_start, id->view_end, id->stride, id->ptr,
+        status = vxCopyTensorPatch(tensor, id->number_of_dims,
+                    id->view_start, id->view_end, id->stride, id->buffer->ptr,
                     VX_READ_ONLY, id->mem_type);
         if(status != VX_SUCCESS)
         {
-            // release resources in case or error
-            if(id->mem_type == VX_MEMORY_TYPE_OPENCL_BUFFER) {
-                ERROR_CHECK_STATUS( clReleaseMemObject((cl_mem)id->ptr) );
-            }
-            else {
-                delete (vx_uint8 *)id->ptr;
-            }
+            // release resources in case or error: id is deleted even if
+            // the buffer cannot be given back
+            myVxPutMapBuffer(id);
             delete id;
             return status;
         }
@@ -138,8 +265,9 @@ vx_status myVxMapTensorPatch(
 }
 
 ////
-// simple reference implementation (not optimized) for vxUnmapTensorPatch
-//   this uses the temporary buffer used for mapping in myVxMapTensorPatch
+// reference implementation for vxUnmapTensorPatch
+//   this copies the mapping buffer back into the tensor only if the usage
+//   writes the data, and keeps the buffer for the next map
 //
 vx_status myVxUnmapTensorPatch(
     vx_tensor                                   tensor,
@@ -151,36 +279,53 @@ vx_status myVxUnmapTensorPatch(
     my_vx_tensor_map_id * id = (my_vx_tensor_map_id *)map_id;
 
     ////
-    // copy tensor patch into temporarily allocated map buffer if read requested
+    // copy the mapping buffer into tensor patch if write requested
     //
+    vx_status status = VX_SUCCESS;
     if(id->usage == VX_WRITE_ONLY || id->usage == VX_READ_AND_WRITE)
     {
-        vx_status status = vxCopyTensorPatch(tensor, id->number_of_dims,
-                    id->view_start, id->view_end, id->stride, id->ptr,
+        status = vxCopyTensorPatch(tensor, id->number_of_dims,
+                    id->view_start, id->view_end, id->stride, id->buffer->ptr,
                     VX_WRITE_ONLY, id->mem_type);
-        if(status != VX_SUCCESS) {
-            // release resources in case or error
-            if(id->mem_type == VX_MEMORY_TYPE_OPENCL_BUFFER) {
-                ERROR_CHECK_STATUS( clReleaseMemObject((cl_mem)id->ptr) );
-            }
-            else {
-                delete (vx_uint8 *)id->ptr;
-            }
-            delete id;
-            return status;
-        }
     }
 
     ////
-    // release temporary buffers allocated for mapping
+    // give the mapping buffer back, and report the first error
     //
-    if(id->mem_type == VX_MEMORY_TYPE_OPENCL_BUFFER) {
-        ERROR_CHECK_STATUS( clReleaseMemObject((cl_mem)id->ptr) );
-    }
-    else {
-        delete (vx_uint8 *)id->ptr;
-    }
+    vx_status put_status = myVxPutMapBuffer(id);
     delete id;
 
+    return status != VX_SUCCESS ? status : put_status;
+}
+
+////
+// release the mapping buffers cached for a tensor
+//
+vx_status myVxReleaseTensorMapCache(
+    vx_tensor                                   tensor)
+{
+    std::lock_guard<std::mutex> lock(my_map_cache_mutex);
+    my_vx_tensor_map_cache::iterator it = my_map_cache.lower_bound(std::make_pair(tensor, (vx_enum)0));
+    while(it != my_map_cache.end() && it->first.first == tensor) {
+        if(it->second->in_use)
+            return VX_ERROR_NOT_SUFFICIENT;
+        ERROR_CHECK_STATUS_RET( myVxReleaseMapBuffer(it->second) );
+        delete it->second;
+        it = my_map_cache.erase(it);
+    }
     return VX_SUCCESS;
 }
+
+////
+// release the mapping buffers cached for a tensor, then the tensor itself
+//   with the OpenVX vxReleaseTensor
+//
+#undef vxReleaseTensor
+vx_status myVxReleaseTensor(
+    vx_tensor *                                 tensor)
+{
+    if(tensor && *tensor) {
+        ERROR_CHECK_STATUS_RET( myVxReleaseTensorMapCache(*tensor) );
+    }
+    return vxReleaseTensor(tensor);
+}
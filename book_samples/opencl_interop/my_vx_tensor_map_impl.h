@@ -21,9 +21,9 @@
 
 /*!
  * \file    my_vx_tensor_map_impl.h
- * \brief   This is a simple reference implementation (not optimized)
- *          to demonstrate vxMapTensorPatch functionality, since it is
- *          not yet available in KhronosGroup/OpenVX-sample-impl repo
+ * \brief   This is a reference implementation to demonstrate
+ *          vxMapTensorPatch functionality, since it is not yet
+ *          available in KhronosGroup/OpenVX-sample-impl repo
  * \author  Radhakrishna Giduthuri <radhakrishna.giduthuri@ieee.org>
  */
 
@@ -33,14 +33,20 @@
 #include <VX/vx.h>
 
 ////
-// simple reference implementations (not optimized) for vxMapTensorPatch & vxUnmapTensorPatch
-//   1. refer to my_vx_tensor_map_impl.cpp for the unoptimized source
+// reference implementations for vxMapTensorPatch & vxUnmapTensorPatch
+//   1. refer to my_vx_tensor_map_impl.cpp for the source: the data is copied
+//      through a mapping buffer kept per tensor, only in the directions
+//      required by the usage
 //   2. the my_vx_tensor_map_impl.h & my_vx_tensor_map_impl.cpp can be removed
 //      once the sample implementation supports the vxMapTensorPatch and
 //      vxUnmapTensorPatch APIs
+//   3. vxReleaseTensor is replaced too, so that the mapping buffers of a
+//      tensor are dropped with it: the cache is keyed by the vx_tensor
+//      handle, which can be reused by a tensor created later
 //
 #define vxMapTensorPatch myVxMapTensorPatch
 #define vxUnmapTensorPatch myVxUnmapTensorPatch
+#define vxReleaseTensor myVxReleaseTensor
 
 #ifdef  __cplusplus
 extern "C" {
@@ -58,13 +64,26 @@ vx_status vxMapTensorPatch(
     vx_enum                                     mem_type);
 
 ////
-// simple reference implementation (not optimized) for vxUnmapTensorPatch
-//   this uses the temporary buffer used for mapping in myVxMapTensorPatch
+// reference implementation for vxUnmapTensorPatch
+//   this uses the mapping buffer returned by myVxMapTensorPatch
 //
 vx_status vxUnmapTensorPatch(
     vx_tensor                                   tensor,
     const vx_map_id                             map_id);
 
+////
+// release the mapping buffers kept for a tensor by myVxMapTensorPatch:
+//   vxReleaseTensor calls this before releasing the tensor
+//
+vx_status myVxReleaseTensorMapCache(
+    vx_tensor                                   tensor);
+
+////
+// vxReleaseTensor that also releases the mapping buffers of the tensor
+//
+vx_status vxReleaseTensor(
+    vx_tensor *                                 tensor);
+
 #ifdef  __cplusplus
 }
 #endif
@@ -33,18 +33,26 @@
 #include <VX/vx.h>
 #include <VX/vx_khr_opencl_interop.h>
 #include "my_vx_tensor_map_impl.h"
+#include "my_cl_program_cache.h"
+#include "hard_sigmoid_cpu.h"
 #include "common.h"
+#include "nodePerf.h"
+#include <chrono>
+#include <string.h>
 
 ////////
 // structure used for passing arguments to hard_sigmoid OpenCL kernel
 //   - alpha & beta are part hard_sigmoid math function
-//   - x_stride_1 & x_stride_2 are used to calculate addr of x tensor element
-//   - y_stride_1 & y_stride_2 are used to calculate addr of y tensor element
+//   - x_stride_1 .. x_stride_3 are used to calculate addr of x tensor element
+//   - y_stride_1 .. y_stride_3 are used to calculate addr of y tensor element
+//   - dims_2 is used to split global work dimension 2 into the tensor
+//     dimension 2 and the batch item (tensor dimension 3)
 //
 struct hard_sigmoid_params {
     cl_float alpha, beta;
-    cl_int x_stride_1, x_stride_2;
-    cl_int y_stride_1, y_stride_2;
+    cl_int x_stride_1, x_stride_2, x_stride_3;
+    cl_int y_stride_1, y_stride_2, y_stride_3;
+    cl_int dims_2;
 };
 
 ////////
@@ -54,12 +62,14 @@ struct hard_sigmoid_params {
 //       * opencl_kernel: pre-compiled OpenCL program for hard_sigmoid
 //       * params: arguments to OpenCL kernel
 //       * global_work_size: work size for opencl_kernel
+//       * num_dims: number of tensor dimensions (3, or 4 for a batch)
 //   - detstoyed during the hard_sigmoid node uninitialize call
 //
 struct hard_sigmoid_local_data {
     cl_kernel opencl_kernel;
     hard_sigmoid_params params;
     size_t global_work_size[3];
+    vx_size num_dims;
 };
 
 ////////
@@ -100,8 +110,8 @@ vx_status VX_CALLBACK hard_sigmoid_opencl_function(vx_node node,
     //
     cl_mem x_mem;
     vx_map_id x_map_id;
-    vx_size x_stride[3];
-    ERROR_CHECK_STATUS( vxMapTensorPatch(tensor_x, 3, NULL, NULL,
+    vx_size x_stride[4] = { 0 };
+    ERROR_CHECK_STATUS( vxMapTensorPatch(tensor_x, data->num_dims, NULL, NULL,
                             &x_map_id, x_stride, (void **)&x_mem,
                             VX_READ_ONLY, VX_MEMORY_TYPE_OPENCL_BUFFER) );
 
@@ -111,8 +121,8 @@ vx_status VX_CALLBACK hard_sigmoid_opencl_function(vx_node node,
     //
     cl_mem y_mem;
     vx_map_id y_map_id;
-    vx_size y_stride[3];
-    ERROR_CHECK_STATUS( vxMapTensorPatch(tensor_y, 3, NULL, NULL,
+    vx_size y_stride[4] = { 0 };
+    ERROR_CHECK_STATUS( vxMapTensorPatch(tensor_y, data->num_dims, NULL, NULL,
                             &y_map_id, y_stride, (void **)&y_mem,
                             VX_WRITE_ONLY, VX_MEMORY_TYPE_OPENCL_BUFFER) );
 
@@ -121,8 +131,10 @@ vx_status VX_CALLBACK hard_sigmoid_opencl_function(vx_node node,
     //
     data->params.x_stride_1 = x_stride[1] / sizeof(short);
     data->params.x_stride_2 = x_stride[2] / sizeof(short);
+    data->params.x_stride_3 = x_stride[3] / sizeof(short);
     data->params.y_stride_1 = y_stride[1] / sizeof(short);
     data->params.y_stride_2 = y_stride[2] / sizeof(short);
+    data->params.y_stride_3 = y_stride[3] / sizeof(short);
     ERROR_CHECK_STATUS( clSetKernelArg(data->opencl_kernel, 0, sizeof(hard_sigmoid_params), (void *)&data->params) );
     ERROR_CHECK_STATUS( clSetKernelArg(data->opencl_kernel, 1, sizeof(cl_mem), (void *)&x_mem) );
     ERROR_CHECK_STATUS( clSetKernelArg(data->opencl_kernel, 2, sizeof(cl_mem), (void *)&y_mem) );
@@ -148,10 +160,60 @@ vx_status VX_CALLBACK hard_sigmoid_opencl_function(vx_node node,
     return VX_SUCCESS;
 }
 
+////////
+// OpenVX user kernel function for "hard_sigmoid" on CPU
+//   - used instead of hard_sigmoid_opencl_function when no OpenCL device
+//     is available
+//   - invoked during graph execution to compute the output on the host
+//
+vx_status VX_CALLBACK hard_sigmoid_cpu_function(vx_node node,
+                const vx_reference arg[], vx_uint32 num_args)
+{
+    ////
+    // get node parameters
+    //
+    vx_scalar scalar_alpha = (vx_scalar)arg[0];
+    vx_scalar scalar_beta = (vx_scalar)arg[1];
+    vx_tensor tensor_x = (vx_tensor)arg[2];
+    vx_tensor tensor_y = (vx_tensor)arg[3];
+    float alpha, beta;
+    vx_size num_dims, dims[4] = { 1, 1, 1, 1 };
+    ERROR_CHECK_STATUS( vxCopyScalar(scalar_alpha, &alpha, VX_READ_ONLY, VX_MEMORY_TYPE_HOST) );
+    ERROR_CHECK_STATUS( vxCopyScalar(scalar_beta, &beta, VX_READ_ONLY, VX_MEMORY_TYPE_HOST) );
+    ERROR_CHECK_STATUS( vxQueryTensor(tensor_y, VX_TENSOR_NUMBER_OF_DIMS, &num_dims, sizeof(vx_size)) );
+    ERROR_CHECK_STATUS( vxQueryTensor(tensor_y, VX_TENSOR_DIMS, dims, num_dims*sizeof(vx_size)) );
+
+    ////
+    // map the input and output tensors into host address space
+    //
+    short * x_buf, * y_buf;
+    vx_map_id x_map_id, y_map_id;
+    vx_size x_stride[4] = { 0 }, y_stride[4] = { 0 };
+    ERROR_CHECK_STATUS( vxMapTensorPatch(tensor_x, num_dims, NULL, NULL,
+                            &x_map_id, x_stride, (void **)&x_buf,
+                            VX_READ_ONLY, VX_MEMORY_TYPE_HOST) );
+    ERROR_CHECK_STATUS( vxMapTensorPatch(tensor_y, num_dims, NULL, NULL,
+                            &y_map_id, y_stride, (void **)&y_buf,
+                            VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST) );
+
+    ////
+    // compute hard_sigmoid with SIMD instructions on all processor cores:
+    //   the rows of all batch items are split between the threads
+    //
+    hard_sigmoid_cpu(alpha, beta, x_buf, x_stride, y_buf, y_stride, dims, 0);
+
+    ERROR_CHECK_STATUS( vxUnmapTensorPatch(tensor_x, x_map_id) );
+    ERROR_CHECK_STATUS( vxUnmapTensorPatch(tensor_y, y_map_id) );
+
+    return VX_SUCCESS;
+}
+
 ////////
 // validate "hard_sigmoid" user kernel:
 //   - scalar data type is VX_TYPE_FLOAT32
 //   - tensor data types is VX_TYPE_INT16 for 16-bit fixed-point Q7.8
+//   - tensors are 3-dimensional, or 4-dimensional with the batch size
+//     as the last dimension
 //   - input and output tensor dimensions are same
 //
 vx_status VX_CALLBACK hard_sigmoid_validator(vx_node node,
@@ -189,18 +251,18 @@ vx_status VX_CALLBACK hard_sigmoid_validator(vx_node node,
     // get input tensor attributes
     //
     vx_int8 fixed_pos;
-    vx_size num_dims_x, dims_x[3];
+    vx_size num_dims_x, dims_x[4];
     ERROR_CHECK_STATUS( vxQueryTensor(tensor_x, VX_TENSOR_FIXED_POINT_POSITION, &fixed_pos, sizeof(vx_int8)) );
     ERROR_CHECK_STATUS( vxQueryTensor(tensor_x, VX_TENSOR_NUMBER_OF_DIMS, &num_dims_x, sizeof(vx_size)) );
     if(fixed_pos != 8) {
         vxAddLogEntry((vx_reference)node, VX_ERROR_INVALID_PARAMETERS, "hard_sigmoid: tensor fixed_pos must be 8");
         return VX_ERROR_INVALID_PARAMETERS;
     }
-    if(num_dims_x != 3) {
-        vxAddLogEntry((vx_reference)node, VX_ERROR_INVALID_PARAMETERS, "hard_sigmoid: tensor must be 3-dimensional");
+    if(num_dims_x != 3 && num_dims_x != 4) {
+        vxAddLogEntry((vx_reference)node, VX_ERROR_INVALID_PARAMETERS, "hard_sigmoid: tensor must be 3-dimensional or batched 4-dimensional");
         return VX_ERROR_INVALID_PARAMETERS;
     }
-    ERROR_CHECK_STATUS( vxQueryTensor(tensor_x, VX_TENSOR_DIMS, dims_x, 3*sizeof(vx_size)) );
+    ERROR_CHECK_STATUS( vxQueryTensor(tensor_x, VX_TENSOR_DIMS, dims_x, num_dims_x*sizeof(vx_size)) );
 
     ////
     // set output tensor attributes
@@ -246,13 +308,17 @@ vx_status VX_CALLBACK hard_sigmoid_init(vx_node node,
     ////
     // calculate global work for the "hard_sigmoid" kernel
     //   in this example, each thread is working on a single element,
-    //   so total number of work items is number of elements in the tensor
+    //   so total number of work items is number of elements in the tensor;
+    //   the batch items are stacked along global work dimension 2, so that
+    //   they are processed by separate work-groups
     //
-    vx_size dims[3];
-    ERROR_CHECK_STATUS( vxQueryTensor(tensor_y, VX_TENSOR_DIMS, dims, 3*sizeof(vx_size)) );
+    vx_size dims[4] = { 1, 1, 1, 1 };
+    ERROR_CHECK_STATUS( vxQueryTensor(tensor_y, VX_TENSOR_NUMBER_OF_DIMS, &data->num_dims, sizeof(vx_size)) );
+    ERROR_CHECK_STATUS( vxQueryTensor(tensor_y, VX_TENSOR_DIMS, dims, data->num_dims*sizeof(vx_size)) );
     data->global_work_size[0] = dims[0];
     data->global_work_size[1] = dims[1];
-    data->global_work_size[2] = dims[2];
+    data->global_work_size[2] = dims[2] * dims[3];
+    data->params.dims_2 = (cl_int)dims[2];
 
     ////
     // get OpenCL command-queue from the node and corresponding OpenCL device
@@ -277,21 +343,27 @@ vx_status VX_CALLBACK hard_sigmoid_init(vx_node node,
     static const char hard_sigmoid_program_source[] =
       "  typedef struct hard_sigmoid_params_ {                   \n"
       "    float alpha, beta;                                    \n"
-      "    int x_stride_1, x_stride_2;                           \n"
-      "    int y_stride_1, y_stride_2;                           \n"
+      "    int x_stride_1, x_stride_2, x_stride_3;               \n"
+      "    int y_stride_1, y_stride_2, y_stride_3;               \n"
+      "    int dims_2;                                           \n"
       "  } hard_sigmoid_params;                                  \n"
       "                                                          \n"
       "  // OpenCL kernel to compute hard sigmoid activation     \n"
       "  __kernel void hard_sigmoid(hard_sigmoid_params params,  \n"
       "        __global const short * X, __global short * Y)     \n"
       "  {                                                       \n"
-      "    // get the index of current data element              \n"
+      "    // get the index of current data element:             \n"
+      "    //   global dimension 2 spans all batch items         \n"
+      "    int k = get_global_id(2) % params.dims_2;             \n"
+      "    int n = get_global_id(2) / params.dims_2;             \n"
       "    int x_idx = get_global_id(0) +                        \n"
       "                  + get_global_id(1) * params.x_stride_1  \n"
-      "                  + get_global_id(2) * params.x_stride_2; \n"
+      "                  + k * params.x_stride_2                 \n"
+      "                  + n * params.x_stride_3;                \n"
       "    int y_idx = get_global_id(0) +                        \n"
       "                  + get_global_id(1) * params.y_stride_1  \n"
-      "                  + get_global_id(2) * params.y_stride_2; \n"
+      "                  + k * params.y_stride_2                 \n"
+      "                  + n * params.y_stride_3;                \n"
       "                                                          \n"
       "    // read and convert input into float from Q7.8        \n"
       "    float x = X[x_idx]/256.0;                             \n"
@@ -303,17 +375,16 @@ vx_status VX_CALLBACK hard_sigmoid_init(vx_node node,
       "    // convert the output to Q7.8 and write               \n"
       "    Y[y_idx] = (short)(y * 256.0);                        \n"
       "  }                                                       \n";
-    const char * program_strings[] = {
-        hard_sigmoid_program_source
-    };
-    size_t program_sizes[] = {
-        sizeof(hard_sigmoid_program_source)
-    };
+
+    ////
+    // build the program: the program binary is cached on disk (see
+    //   my_cl_program_cache.h), so the OpenCL C compiler only runs the
+    //   first time the program is built for a device
+    //
     cl_int err;
-    cl_program hard_sigmoid_program = clCreateProgramWithSource(opencl_ctx,
-            1, program_strings, program_sizes, &err);
+    cl_program hard_sigmoid_program = myClBuildProgramWithCache(opencl_ctx, opencl_device,
+            hard_sigmoid_program_source, sizeof(hard_sigmoid_program_source), NULL, &err);
     ERROR_CHECK_STATUS( err );
-    ERROR_CHECK_STATUS( clBuildProgram(hard_sigmoid_program, 1, &opencl_device, NULL, NULL, NULL) );
     data->opencl_kernel = clCreateKernel(hard_sigmoid_program, "hard_sigmoid", &err);
     ERROR_CHECK_STATUS( err );
     ERROR_CHECK_STATUS( clReleaseProgram(hard_sigmoid_program) );
@@ -363,22 +434,24 @@ vx_status VX_CALLBACK hard_sigmoid_uninit(vx_node node,
 
 ////////
 // register user kernel
+//   - use_opencl: true to run with OpenCL interop, false to run on CPU
 //
-vx_kernel register_hard_sigmoid_kernel(vx_context openvx_ctx)
+vx_kernel register_hard_sigmoid_kernel(vx_context openvx_ctx, bool use_opencl)
 {
     ////
     // register user kernel for "hard_sigmoid"
     //   1. allocate and register a user kernel enum in the OpenVX context
-    //   2. register hard_sigmoid user kernel with callback functions (above)
+    //   2. register hard_sigmoid user kernel with callback functions (above):
+    //      the CPU function doesn't need node initialization
     //
     vx_enum hard_sigmoid_kernel_id;
     ERROR_CHECK_STATUS( vxAllocateUserKernelId(openvx_ctx, &hard_sigmoid_kernel_id) );
     vx_kernel user_kernel = vxAddUserKernel(openvx_ctx,
             "app.userkernels.hard_sigmoid", hard_sigmoid_kernel_id,
-            hard_sigmoid_opencl_function, 4,
+            use_opencl ? hard_sigmoid_opencl_function : hard_sigmoid_cpu_function, 4,
             hard_sigmoid_validator,
-            hard_sigmoid_init,
-            hard_sigmoid_uninit);
+            use_opencl ? hard_sigmoid_init : NULL,
+            use_opencl ? hard_sigmoid_uninit : NULL);
     ERROR_CHECK_STATUS( vxGetStatus((vx_reference)user_kernel) );
 
     ////
@@ -396,9 +469,11 @@ vx_kernel register_hard_sigmoid_kernel(vx_context openvx_ctx)
     ////
     // specify that the user kernel is using OpenCL interop
     //
-    vx_bool use_opencl_interop = vx_true_e;
-    ERROR_CHECK_STATUS( vxSetKernelAttribute(user_kernel, VX_KERNEL_USE_OPENCL,
-                            &use_opencl_interop, sizeof(vx_bool)) );
+    if(use_opencl) {
+        vx_bool use_opencl_interop = vx_true_e;
+        ERROR_CHECK_STATUS( vxSetKernelAttribute(user_kernel, VX_KERNEL_USE_OPENCL,
+                                &use_opencl_interop, sizeof(vx_bool)) );
+    }
 
     ////
     // finalize the user kernel after setting VX_KERNEL_USE_OPENCL attribute
@@ -417,7 +492,67 @@ void VX_CALLBACK log_callback(vx_context context, vx_reference ref,
     printf("LOG: [status:%d] %s\n", status, string);
 }
 
-int main()
+////////
+// benchmark "hard_sigmoid" on a batch of 3-dimensional tensors:
+//   - creates a graph with one node on 4-dimensional tensors of batch_size items
+//   - reports the number of batch items processed per second
+//
+void benchmark_hard_sigmoid(vx_context openvx_ctx, vx_kernel openvx_hard_sigmoid_kernel,
+                vx_scalar scalar_alpha, vx_scalar scalar_beta,
+                const size_t item_dims[3], size_t batch_size, int iterations,
+                struct node_perf_report * report)
+{
+    ////
+    // create the batched tensors and the graph
+    //
+    size_t dims[4] = { item_dims[0], item_dims[1], item_dims[2], batch_size };
+    vx_tensor tensor_x = vxCreateTensor(openvx_ctx, 4, dims, VX_TYPE_INT16, 8);
+    vx_tensor tensor_y = vxCreateTensor(openvx_ctx, 4, dims, VX_TYPE_INT16, 8);
+    vx_graph graph = vxCreateGraph(openvx_ctx);
+    ERROR_CHECK_STATUS( vxGetStatus((vx_reference)tensor_x) );
+    ERROR_CHECK_STATUS( vxGetStatus((vx_reference)tensor_y) );
+    ERROR_CHECK_STATUS( vxGetStatus((vx_reference)graph) );
+    char graph_name[32];
+    sprintf(graph_name, "batch %d", (int)batch_size);
+    vx_char kernel_name[VX_MAX_KERNEL_NAME];
+    ERROR_CHECK_STATUS( vxQueryKernel(openvx_hard_sigmoid_kernel, VX_KERNEL_NAME, kernel_name, sizeof(kernel_name)) );
+    vx_node hard_sigmoid_node = addNodeToPerfReportAs(report, graph_name,
+                                    vxCreateGenericNode(graph, openvx_hard_sigmoid_kernel), kernel_name);
+    ERROR_CHECK_STATUS( vxGetStatus((vx_reference)hard_sigmoid_node) );
+    ERROR_CHECK_STATUS( vxSetParameterByIndex(hard_sigmoid_node, 0, (vx_reference) scalar_alpha) );
+    ERROR_CHECK_STATUS( vxSetParameterByIndex(hard_sigmoid_node, 1, (vx_reference) scalar_beta) );
+    ERROR_CHECK_STATUS( vxSetParameterByIndex(hard_sigmoid_node, 2, (vx_reference) tensor_x) );
+    ERROR_CHECK_STATUS( vxSetParameterByIndex(hard_sigmoid_node, 3, (vx_reference) tensor_y) );
+    ERROR_CHECK_STATUS( vxReleaseNode(&hard_sigmoid_node) );
+    ERROR_CHECK_STATUS( vxVerifyGraph(graph) );
+
+    ////
+    // run once to warm up, then time the iterations
+    //
+    ERROR_CHECK_STATUS( vxProcessGraph(graph) );
+    std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < iterations; i++) {
+        ERROR_CHECK_STATUS( vxProcessGraph(graph) );
+        sampleNodePerfReport(report);
+    }
+    std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    printf("OK: batch %3d: %9.3f msec/batch %10.1f items/sec\n", (int)batch_size,
+            seconds * 1000.0 / iterations, (double)batch_size * iterations / seconds);
+
+    ////
+    // release all resources
+    //
+    ERROR_CHECK_STATUS( vxReleaseGraph(&graph) );
+    ERROR_CHECK_STATUS( vxReleaseTensor(&tensor_x) );
+    ERROR_CHECK_STATUS( vxReleaseTensor(&tensor_y) );
+}
+
+////////
+// usage: opencl_interop_example [benchmark [<iterations>]]
+//   benchmark: after the test, measure batch items/sec for several batch sizes
+//
+int main(int argc, char * argv[])
 {
     ////
     // hard_sigmoind example configuration
@@ -459,47 +594,60 @@ int main()
     }
 
     ////
-    // select an OpenCL device
+    // select an OpenCL device: if there is none, hard_sigmoid runs on CPU
     //
     cl_platform_id platform_id;
     cl_device_id device_id;
-    cl_int err;
-    ERROR_CHECK_STATUS( clGetPlatformIDs(1, &platform_id, NULL) );
-    ERROR_CHECK_STATUS( clGetDeviceIDs(platform_id, CL_DEVICE_TYPE_DEFAULT, 1, &device_id, NULL) );
-
-    ////
-    // create OpenCL context
-    //   device can be returned back to OpenCL once context is created
-    //
-    cl_context opencl_ctx;
-    cl_context_properties ctxprop[] = { CL_CONTEXT_PLATFORM,
-        (cl_context_properties)platform_id, 0, 0 };
-    opencl_ctx = clCreateContext(ctxprop, 1, &device_id, NULL, NULL, &err);
-    ERROR_CHECK_STATUS( err );
-    ERROR_CHECK_STATUS( clReleaseDevice(device_id) );
-    printf("OK: created OpenCL context\n");
-
-    ////
-    // create OpenCL command-queue for the device
-    //
-    cl_command_queue opencl_cmdq;
-    opencl_cmdq = clCreateCommandQueue(opencl_ctx, device_id, 0, &err);
-    ERROR_CHECK_STATUS( err );
-    printf("OK: created OpenCL command-queue\n");
-
-    ////
-    // create OpenVX context with OpenCL interoperability
-    //
-    vx_context openvx_ctx = vxCreateContextFromCL(opencl_ctx, opencl_cmdq);
-    ERROR_CHECK_STATUS( vxGetStatus((vx_reference)openvx_ctx) );
+    cl_uint num_platforms = 0;
+    bool use_opencl = clGetPlatformIDs(1, &platform_id, &num_platforms) == CL_SUCCESS &&
+                      num_platforms > 0 &&
+                      clGetDeviceIDs(platform_id, CL_DEVICE_TYPE_DEFAULT, 1, &device_id, NULL) == CL_SUCCESS;
+
+    vx_context openvx_ctx;
+    if(use_opencl) {
+        ////
+        // create OpenCL context
+        //   device can be returned back to OpenCL once context is created
+        //
+        cl_int err;
+        cl_context opencl_ctx;
+        cl_context_properties ctxprop[] = { CL_CONTEXT_PLATFORM,
+            (cl_context_properties)platform_id, 0, 0 };
+        opencl_ctx = clCreateContext(ctxprop, 1, &device_id, NULL, NULL, &err);
+        ERROR_CHECK_STATUS( err );
+        ERROR_CHECK_STATUS( clReleaseDevice(device_id) );
+        printf("OK: created OpenCL context\n");
+
+        ////
+        // create OpenCL command-queue for the device
+        //
+        cl_command_queue opencl_cmdq;
+        opencl_cmdq = clCreateCommandQueue(opencl_ctx, device_id, 0, &err);
+        ERROR_CHECK_STATUS( err );
+        printf("OK: created OpenCL command-queue\n");
+
+        ////
+        // create OpenVX context with OpenCL interoperability
+        //
+        openvx_ctx = vxCreateContextFromCL(opencl_ctx, opencl_cmdq);
+        ERROR_CHECK_STATUS( vxGetStatus((vx_reference)openvx_ctx) );
+        printf("OK: created OpenVX context with OpenCL interoperability\n");
+    }
+    else {
+        ////
+        // create OpenVX context without OpenCL
+        //
+        openvx_ctx = vxCreateContext();
+        ERROR_CHECK_STATUS( vxGetStatus((vx_reference)openvx_ctx) );
+        printf("OK: no OpenCL device found: created OpenVX context for CPU\n");
+    }
     vxRegisterLogCallback(openvx_ctx, log_callback, vx_false_e);
-    printf("OK: created OpenVX context with OpenCL interoperability\n");
 
     ////
     // register "hard_sigmoid" OpenVX user kernel
     //
-    vx_kernel openvx_hard_sigmoid_kernel = register_hard_sigmoid_kernel(openvx_ctx);
-    printf("OK: registered OpenVX user kernel for hard_sigmoid\n");
+    vx_kernel openvx_hard_sigmoid_kernel = register_hard_sigmoid_kernel(openvx_ctx, use_opencl);
+    printf("OK: registered OpenVX user kernel for hard_sigmoid (%s)\n", use_opencl ? "OpenCL" : "CPU");
 
     ////
     // create OpenVX buffers for hard_sigmoid inputs and outputs
@@ -539,6 +687,9 @@ int main()
     //
     ERROR_CHECK_STATUS( vxVerifyGraph(graph) );
     printf("OK: verified the graph\n");
+    size_t cache_hits, cache_misses;
+    myClGetProgramCacheCounters(&cache_hits, &cache_misses);
+    printf("OK: OpenCL program cache hits = %d, misses = %d\n", (int)cache_hits, (int)cache_misses);
 
     ////
     // initialize input tensor
@@ -589,11 +740,31 @@ int main()
     }
     printf("OK: computed MSE against reference: MSE = %.6g (expected)\n", mse);
 
+    ////
+    // benchmark hard_sigmoid with batched tensors, if requested
+    //
+    if(argc > 1 && !strcmp(argv[1], "benchmark")) {
+        int iterations = (argc > 2) ? atoi(argv[2]) : 100;
+        size_t item_dims[3] = { 56, 56, 64 };
+        size_t batch_sizes[] = { 1, 8, 16, 32, 64 };
+        struct node_perf_report * report = createNodePerfReport(openvx_ctx);
+        printf("OK: hard_sigmoid benchmark: %d iterations of batches of %zu x %zu x %zu items\n",
+                iterations, item_dims[2], item_dims[1], item_dims[0]);
+        for(size_t i = 0; i < sizeof(batch_sizes) / sizeof(batch_sizes[0]); i++) {
+            benchmark_hard_sigmoid(openvx_ctx, openvx_hard_sigmoid_kernel,
+                    scalar_alpha, scalar_beta, item_dims, batch_sizes[i], iterations, report);
+        }
+        printNodePerfReport(report);
+        releaseNodePerfReport(&report);
+    }
+
     ////
     // release all resources
     //
     delete[] x_input;
     delete[] y_output_ref;
+    ERROR_CHECK_STATUS( vxReleaseTensor(&tensor_x) );
+    ERROR_CHECK_STATUS( vxReleaseTensor(&tensor_y) );
     //ERROR_CHECK_STATUS( vxReleaseContext(&openvx_ctx) );
 
     return 0;
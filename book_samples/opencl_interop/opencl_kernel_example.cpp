@@ -32,6 +32,7 @@
 #else
 #include <CL/cl.h>
 #endif
+#include "my_cl_program_cache.h"
 #include "common.h"
 
 ////////
@@ -128,19 +129,16 @@ int main()
       "  }                                                       \n";
 
     ////
-    // compile OpenCL C program from source
+    // compile OpenCL C program from source, or load the program binary
+    //   cached on disk by an earlier run (see my_cl_program_cache.h)
     //
-    const char * program_strings[] = {
-        hard_sigmoid_program_source
-    };
-    size_t program_sizes[] = {
-        sizeof(hard_sigmoid_program_source)
-    };
-    cl_program hard_sigmoid_program = clCreateProgramWithSource(opencl_ctx,
-            1, program_strings, program_sizes, &err);
+    cl_program hard_sigmoid_program = myClBuildProgramWithCache(opencl_ctx, device_id,
+            hard_sigmoid_program_source, sizeof(hard_sigmoid_program_source), NULL, &err);
     ERROR_CHECK_STATUS( err );
-    ERROR_CHECK_STATUS( clBuildProgram(hard_sigmoid_program, 1, &device_id, NULL, NULL, NULL) );
-    printf("OK: compiled OpenCL program for hard_sigmoid kernel\n");
+    size_t cache_hits, cache_misses;
+    myClGetProgramCacheCounters(&cache_hits, &cache_misses);
+    printf("OK: %s OpenCL program for hard_sigmoid kernel (cache hits = %d, misses = %d)\n",
+           cache_hits ? "loaded cached" : "compiled", (int)cache_hits, (int)cache_misses);
 
     ////
     // get kernel object for the "hard_sigmoid" kernel function in program
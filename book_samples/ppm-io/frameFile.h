@@ -0,0 +1,69 @@
+/*
+frameFile.h
+Write and read many frames of the same size and format in a single file, so that long captures can be replayed
+without opening and parsing a file per frame.
+
+File layout (all header fields are little-endian):
+    offset  0: magic "VXFRAMES"
+    offset  8: vx_uint32 version (1)
+    offset 12: vx_uint32 width
+    offset 16: vx_uint32 height
+    offset 20: vx_df_image format (VX_DF_IMAGE_U8, VX_DF_IMAGE_U16, VX_DF_IMAGE_RGB or VX_DF_IMAGE_RGBX)
+    offset 24: vx_uint32 frame count, written when the file is closed
+    offset 32: vx_uint64 offset of the frame index, written when the file is closed
+    offset 64: frames, each width * height * pixel size bytes with no gaps, padded to a multiple of 64 bytes
+    index:     one vx_uint64 file offset per frame
+Pixel data is stored in host byte order. If the writer did not close the file the index is missing, and the
+frames present are found from the size of the file.
+*/
+#ifndef _frameFile_h_included_
+#define _frameFile_h_included_
+#include "readImage.h"
+#ifdef  __cplusplus
+extern "C" {
+#endif
+/* Size of the header, and alignment of the start of every frame */
+#define FRAME_FILE_HEADER_SIZE 64
+#define FRAME_FILE_ALIGNMENT 64
+
+/* Bytes per pixel of the formats a frame file can hold, or 0 for any other format */
+static inline int framePixelSize(vx_df_image format)
+{
+    switch (format)
+    {
+        case VX_DF_IMAGE_U8: return 1;
+        case VX_DF_IMAGE_U16: return 2;
+        case VX_DF_IMAGE_RGB: return 3;
+        case VX_DF_IMAGE_RGBX: return 4;
+        default: return 0;
+    }
+}
+
+/* Opaque handles to open frame files */
+struct frame_writer;
+struct frame_reader;
+
+/* Create a frame file for images of the given size and format */
+struct frame_writer *openFrameWriter(const char *filename, vx_uint32 width, vx_uint32 height, vx_df_image format);
+
+/* Append an image, which must have the size and format given when the file was opened */
+vx_status writeFrame(struct frame_writer *writer, vx_image image);
+
+/* Write the index and close the file */
+vx_status closeFrameWriter(struct frame_writer **writer);
+
+/* Map a frame file into memory. The size and format are returned in attr and the number of frames in count. */
+struct frame_reader *openFrameReader(const char *filename, struct read_image_attributes *attr, vx_uint32 *count);
+
+/* Copy frame number index into an image of the same size and format */
+vx_status readFrame(struct frame_reader *reader, vx_uint32 index, vx_image image);
+
+/* Get the address of frame number index in the mapped file, and its layout in addr. The memory is valid until
+   the reader is closed and must not be written. Returns NULL if there is no such frame. */
+const void *getFramePointer(struct frame_reader *reader, vx_uint32 index, vx_imagepatch_addressing_t *addr);
+
+void closeFrameReader(struct frame_reader **reader);
+#ifdef  __cplusplus
+}
+#endif
+#endif
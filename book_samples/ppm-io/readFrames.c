@@ -0,0 +1,202 @@
+/*
+readFrames.c
+Random access to the frames of a multi-frame file. The layout is described in frameFile.h.
+The file is mapped into memory, so reading frame N is a single vxCopyImagePatch from the mapping, or no copy at
+all when the caller uses getFramePointer. Where mmap is not available the whole file is read into allocated
+memory with stdio instead.
+*/
+#include <VX/vx.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__unix__) || defined(__APPLE__)
+#define READ_FRAMES_USE_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "frameFile.h"
+
+struct frame_reader {
+    const vx_uint8 *data;  /* The mapped file */
+    size_t size;
+    vx_uint32 width, height;
+    vx_df_image format;
+    vx_imagepatch_addressing_t addr;  /* Layout of every frame */
+    vx_uint32 count;
+    const vx_uint8 *index; /* Index in the file, or NULL if the file was not closed by the writer */
+    size_t frame_stride;
+};
+
+static vx_uint32 getLE32(const vx_uint8 *p)
+{
+    return (vx_uint32)p[0] | ((vx_uint32)p[1] << 8) | ((vx_uint32)p[2] << 16) | ((vx_uint32)p[3] << 24);
+}
+
+static vx_uint64 getLE64(const vx_uint8 *p)
+{
+    return (vx_uint64)getLE32(p) | ((vx_uint64)getLE32(p + 4) << 32);
+}
+
+/* Bring the whole file into memory. Returns NULL if it cannot, or if it is too short to hold the header. */
+#if READ_FRAMES_USE_MMAP
+static vx_uint8 *loadFile(const char *filename, size_t *size)
+{
+    struct stat st;
+    void *data;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    if (0 != fstat(fd, &st) || st.st_size < FRAME_FILE_HEADER_SIZE)
+    {
+        close(fd);
+        return NULL;
+    }
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == data)
+        return NULL;
+    madvise(data, (size_t)st.st_size, MADV_WILLNEED);
+    *size = (size_t)st.st_size;
+    return (vx_uint8 *)data;
+}
+
+static void unloadFile(const vx_uint8 *data, size_t size)
+{
+    munmap((void *)data, size);
+}
+#else
+static vx_uint8 *loadFile(const char *filename, size_t *size)
+{
+    vx_uint8 *data = NULL;
+    long length = -1;
+    FILE *fp = fopen(filename, "rb");
+    if (!fp)
+        return NULL;
+    if (0 == fseek(fp, 0, SEEK_END))
+        length = ftell(fp);
+    if (length >= FRAME_FILE_HEADER_SIZE && 0 == fseek(fp, 0, SEEK_SET))
+    {
+        data = (vx_uint8 *)malloc((size_t)length);
+        if (data && (size_t)length != fread(data, 1, (size_t)length, fp))
+        {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(fp);
+    *size = (size_t)length;
+    return data;
+}
+
+static void unloadFile(const vx_uint8 *data, size_t size)
+{
+    free((void *)data);
+}
+#endif
+
+struct frame_reader *openFrameReader(const char *filename, struct read_image_attributes *attr, vx_uint32 *count)
+{
+    struct frame_reader *reader = NULL;
+    size_t size = 0;
+    int psz;
+    const vx_uint8 *data = loadFile(filename, &size);
+    if (!data)
+        return NULL;
+    reader = (struct frame_reader *)calloc(1, sizeof(struct frame_reader));
+    if (reader)
+    {
+        vx_uint64 index_offset = getLE64(data + 32);
+        reader->data = data;
+        reader->size = size;
+        reader->width = getLE32(data + 12);
+        reader->height = getLE32(data + 16);
+        reader->format = getLE32(data + 20);
+        reader->count = getLE32(data + 24);
+        psz = framePixelSize(reader->format);
+        if (memcmp(data, "VXFRAMES", 8) || 1 != getLE32(data + 8) || 0 == psz ||
+            0 == reader->width || 0 == reader->height)
+        {
+            unloadFile(data, size);
+            free(reader);
+            return NULL;
+        }
+        reader->addr.dim_x = reader->width;
+        reader->addr.dim_y = reader->height;
+        reader->addr.stride_x = psz;
+        reader->addr.stride_y = reader->width * psz;
+        reader->addr.scale_x = VX_SCALE_UNITY;
+        reader->addr.scale_y = VX_SCALE_UNITY;
+        reader->addr.step_x = 1;
+        reader->addr.step_y = 1;
+        reader->frame_stride = ((size_t)reader->addr.stride_y * reader->height + FRAME_FILE_ALIGNMENT - 1) /
+                               FRAME_FILE_ALIGNMENT * FRAME_FILE_ALIGNMENT;
+        if (index_offset && index_offset + (vx_uint64)reader->count * 8 <= reader->size)
+            reader->index = reader->data + index_offset;
+        else
+        {
+            /* The writer did not finish; recover the complete frames that follow the header */
+            reader->count = (vx_uint32)((reader->size - FRAME_FILE_HEADER_SIZE) / reader->frame_stride);
+        }
+        if (NULL != attr)
+        {
+            attr->width = reader->width;
+            attr->height = reader->height;
+            attr->format = reader->format;
+        }
+        if (NULL != count)
+            *count = reader->count;
+    }
+    else
+        unloadFile(data, size);
+    return reader;
+}
+
+const void *getFramePointer(struct frame_reader *reader, vx_uint32 index, vx_imagepatch_addressing_t *addr)
+{
+    vx_uint64 offset;
+    if (index >= reader->count)
+        return NULL;
+    if (reader->index)
+        offset = getLE64(reader->index + (size_t)index * 8);
+    else
+        offset = FRAME_FILE_HEADER_SIZE + (vx_uint64)index * reader->frame_stride;
+    if (offset + (vx_uint64)reader->addr.stride_y * reader->height > reader->size)
+        return NULL;
+    if (NULL != addr)
+        *addr = reader->addr;
+    return reader->data + offset;
+}
+
+vx_status readFrame(struct frame_reader *reader, vx_uint32 index, vx_image image)
+{
+    vx_uint32 image_width;
+    vx_uint32 image_height;
+    vx_df_image image_format;
+    vx_status status = vxGetStatus((vx_reference)image) ||
+                       vxQueryImage(image, VX_IMAGE_WIDTH, &image_width, sizeof(image_width)) ||
+                       vxQueryImage(image, VX_IMAGE_HEIGHT, &image_height, sizeof(image_height)) ||
+                       vxQueryImage(image, VX_IMAGE_FORMAT, &image_format, sizeof(image_format));
+    vx_rectangle_t rect = {.start_x = 0, .start_y = 0, .end_x = image_width, .end_y = image_height};
+    vx_imagepatch_addressing_t addr;
+    const void *frame;
+    if (VX_SUCCESS != status)
+        return status;
+    if (image_width != reader->width || image_height != reader->height || image_format != reader->format)
+        return VX_ERROR_INVALID_FORMAT;
+    frame = getFramePointer(reader, index, &addr);
+    if (!frame)
+        return VX_ERROR_INVALID_PARAMETERS;
+    return vxCopyImagePatch(image, &rect, 0, &addr, (void *)frame, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+}
+
+void closeFrameReader(struct frame_reader **reader)
+{
+    if (*reader)
+    {
+        unloadFile((*reader)->data, (*reader)->size);
+        free(*reader);
+        *reader = NULL;
+    }
+}
@@ -44,91 +44,425 @@ Other return values of different meanings are possible when returned from the vx
 #include <VX/vx.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#if defined(__unix__) || defined(__APPLE__)
+#define READ_IMAGE_USE_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
 #include "readImage.h"
+
 /*
-fillPixel - set a given pixel to a value based upon a given integer value, the image format, and conversion flag.
+mapped_file - a file mapped into memory. The mapping is private and writable so that a vx_image created from
+the payload may be modified without changing the file. Where mmap is not available the whole file is read into
+allocated memory with stdio instead, which behaves the same apart from the copy.
 */
+struct mapped_file {
+    vx_uint8 *data;
+    size_t size;
+};
+
+struct read_image_mapping {
+    struct mapped_file file;
+};
+
+#if READ_IMAGE_USE_MMAP
+static vx_status mapFile(const char *filename, struct mapped_file *mf)
+{
+    vx_status status = VX_FAILURE;
+    struct stat st;
+    int fd = open(filename, O_RDONLY);
+    mf->data = NULL;
+    mf->size = 0;
+    if (fd >= 0)
+    {
+        if (0 != fstat(fd, &st))
+            st.st_size = -1;
+        if (st.st_size > 0)
+        {
+            void *data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (MAP_FAILED != data)
+            {
+                madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+                mf->data = (vx_uint8 *)data;
+                mf->size = (size_t)st.st_size;
+                status = VX_SUCCESS;
+            }
+        }
+        else if (0 == st.st_size)
+        {
+            /* An empty file cannot be mapped, and is not an image anyway */
+            status = VX_ERROR_NOT_SUPPORTED;
+        }
+        close(fd);
+    }
+    return status;
+}
 
-static void fillPixel(void *imgp, const vx_imagepatch_addressing_t * addr, vx_uint32 x,
-                      vx_uint32 y, vx_pixel_value_t fillValue, vx_df_image image_format)
+static void unmapFile(struct mapped_file *mf)
 {
-    vx_pixel_value_t *pixptr = (vx_pixel_value_t *) vxFormatImagePatchAddress2d(imgp, x, y, addr);
+    if (mf->data)
+        munmap(mf->data, mf->size);
+    mf->data = NULL;
+    mf->size = 0;
+}
+#else
+static vx_status mapFile(const char *filename, struct mapped_file *mf)
+{
+    vx_status status = VX_FAILURE;
+    long size = -1;
+    FILE *fp = fopen(filename, "rb");
+    mf->data = NULL;
+    mf->size = 0;
+    if (fp)
+    {
+        if (0 == fseek(fp, 0, SEEK_END))
+            size = ftell(fp);
+        if (size > 0 && 0 == fseek(fp, 0, SEEK_SET))
+        {
+            mf->data = (vx_uint8 *)malloc((size_t)size);
+            if (mf->data && (size_t)size == fread(mf->data, 1, (size_t)size, fp))
+            {
+                mf->size = (size_t)size;
+                status = VX_SUCCESS;
+            }
+            else
+            {
+                free(mf->data);
+                mf->data = NULL;
+            }
+        }
+        else if (0 == size)
+        {
+            status = VX_ERROR_NOT_SUPPORTED;
+        }
+        fclose(fp);
+    }
+    return status;
+}
+
+static void unmapFile(struct mapped_file *mf)
+{
+    free(mf->data);
+    mf->data = NULL;
+    mf->size = 0;
+}
+#endif
+
+/*
+isBigEndian - returns non-zero if the host stores the most significant byte of a vx_uint16 first, in which
+case 16-bit file data can be used without conversion.
+*/
+static int isBigEndian(void)
+{
+    const vx_uint16 one = 1;
+    return 0 == *(const vx_uint8 *)&one;
+}
+
+/*
+fillSpan - fill count pixels of a row of the vx_image. The fill value is either all zeros or all ones, so apart
+from the alpha channel of RGBX, which is always set to the maximum, the span can be filled byte by byte.
+*/
+static void fillSpan(vx_uint8 *dst, vx_uint32 count, enum read_image_fill fill, vx_df_image image_format)
+{
+    vx_uint8 value = READ_IMAGE_FILL_ONES == fill ? 0xFF : 0;
+    vx_uint32 x;
     switch (image_format)
     {
         case VX_DF_IMAGE_U8:
-            pixptr -> U8 = fillValue.U8;
+            memset(dst, value, count);
             break;
         case VX_DF_IMAGE_U16:
-            pixptr -> U16 = fillValue.U16;
+            memset(dst, value, (size_t)count * 2);
             break;
-        case VX_DF_IMAGE_RGBX:
-            pixptr -> RGBX[3] = 0;       /* Fall through to RGB */
         case VX_DF_IMAGE_RGB:
-            pixptr -> RGBX[0] = fillValue.RGBX[0];
-            pixptr -> RGBX[1] = fillValue.RGBX[1];
-            pixptr -> RGBX[2] = fillValue.RGBX[2];
+            memset(dst, value, (size_t)count * 3);
+            break;
+        case VX_DF_IMAGE_RGBX:
+            for (x = 0; x < count; ++x, dst += 4)
+            {
+                dst[0] = dst[1] = dst[2] = value;
+                dst[3] = 0xFF;
+            }
             break;
         default: break;
     }
 }
 
-static void copyPixel(void *filerow, void *imgp, const vx_imagepatch_addressing_t *addr, vx_uint32 src_x,
-                           vx_uint32 dst_x, vx_uint32 dst_y, int psz, vx_df_image image_format)
+/*
+expandSpanRGB - copy count RGB pixels into RGBX pixels, setting alpha to the maximum.
+*/
+static void expandSpanRGB(vx_uint8 * restrict dst, const vx_uint8 * restrict src, vx_uint32 count)
 {
-    fillPixel(imgp, addr, dst_x, dst_y, *(vx_pixel_value_t *)(filerow + src_x * psz), image_format);
+    vx_uint32 x = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; x + 16 <= count; x += 16, src += 48, dst += 64)
+    {
+        uint8x16x3_t rgb = vld3q_u8(src);
+        uint8x16x4_t rgbx = {{ rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(0xFF) }};
+        vst4q_u8(dst, rgbx);
+    }
+#elif defined(__SSSE3__)
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    /* Each load reads 16 bytes for 4 pixels, so stop while 16 bytes remain in the row */
+    for (; x + 6 <= count; x += 4, src += 12, dst += 16)
+    {
+        __m128i rgb = _mm_loadu_si128((const __m128i *)src);
+        _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+    }
+#endif
+    for (; x < count; ++x, src += 3, dst += 4)
+    {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 0xFF;
+    }
 }
 
-static vx_status readHeader(FILE *fp, int *psz, vx_uint32 *width, vx_uint32 *height)
+/*
+copySpan - copy count pixels from a row of the file into a row of the vx_image, converting as necessary.
+*/
+static void copySpan(vx_uint8 * restrict dst, const vx_uint8 * restrict src, vx_uint32 count, int psz,
+                     vx_df_image image_format)
 {
-    vx_status status = VX_SUCCESS;
-    char *buffer = 0;
-    char line[1024];
-    int fmt = 0;    /* Format of ppm file (allowed 5 or 6) */
-    int maxval = 0; /* maximum value of each datum in the file */
-    *width = 0;     /* width of image in the file */
-    *height = 0;    /* height of image in the file */
-    *psz = 0;       /* size of pixel in file */
-
-    /* Notice that because we are using fgets, the separator before the data *must* be a newline */
-    fgets(line, 1024, fp);
-    int n = sscanf(line, "P%d %d %d %d", &fmt, width, height, &maxval);
-
-    if (n > 0)
+    vx_uint32 x;
+    if (VX_DF_IMAGE_RGBX == image_format)
+        expandSpanRGB(dst, src, count);
+    else if (2 == psz && !isBigEndian())
     {
-        if (5 == fmt)
+        /* 16-bit samples in the file are stored most significant byte first */
+        for (x = 0; x < count; ++x, src += 2, dst += 2)
         {
-            *psz = 1;
+            dst[0] = src[1];
+            dst[1] = src[0];
         }
-        else if (6 == fmt)
+    }
+    else
+        memcpy(dst, src, (size_t)count * psz);
+}
+
+/*
+skipHeaderSpace - advance past whitespace and comments in a header held in memory.
+Returns the new position.
+*/
+static size_t skipHeaderSpace(const vx_uint8 *data, size_t size, size_t pos)
+{
+    while (pos < size)
+    {
+        if ('#' == data[pos])
         {
-            *psz = 3;
+            while (pos < size && '\n' != data[pos] && '\r' != data[pos])
+                ++pos;
         }
-        while (n < 4 && fgets(line, 1024, fp))
+        else if (' ' == data[pos] || '\t' == data[pos] || '\n' == data[pos] || '\r' == data[pos] ||
+                 '\v' == data[pos] || '\f' == data[pos])
+            ++pos;
+        else
+            break;
+    }
+    return pos;
+}
+
+/*
+readHeaderValue - read a decimal header field, which must be followed by whitespace. Returns the position after
+the value, or 0 if there is no value or it is too large for any header field. *truncated is set if the data ends
+before the value does.
+*/
+static size_t readHeaderValue(const vx_uint8 *data, size_t size, size_t pos, vx_uint32 *value, int *truncated)
+{
+    size_t start;
+    *value = 0;
+    pos = skipHeaderSpace(data, size, pos);
+    start = pos;
+    while (pos < size && data[pos] >= '0' && data[pos] <= '9')
+    {
+        if (*value > 0xFFFFFF)
+            return 0;
+        *value = *value * 10 + (data[pos++] - '0');
+    }
+    if (pos == size)
+    {
+        *truncated = 1;
+        return 0;
+    }
+    return pos > start ? pos : 0;
+}
+
+/*
+parseHeader - parse a P5 or P6 header from the first size bytes of a file of file_size bytes. On success the
+size of a pixel, the image dimensions and the offset of the pixel data are returned. The file must be long enough
+to hold all of the pixel data. Returns VX_ERROR_NOT_SUFFICIENT if the header goes on past the first size bytes.
+*/
+static vx_status parseHeader(const vx_uint8 *data, size_t size, size_t file_size, int *psz, vx_uint32 *width,
+                             vx_uint32 *height, size_t *offset)
+{
+    vx_status status = VX_ERROR_NOT_SUPPORTED;
+    vx_uint32 maxval = 0; /* maximum value of each datum in the file */
+    size_t pos = 0;
+    int truncated = 0;    /* set if the header goes on past the data */
+    *width = 0;           /* width of image in the file */
+    *height = 0;          /* height of image in the file */
+    *psz = 0;             /* size of pixel in file */
+    *offset = 0;          /* offset of the pixel data in the file */
+
+    if (size > 2 && 'P' == data[0] && ('5' == data[1] || '6' == data[1]))
+    {
+        *psz = '5' == data[1] ? 1 : 3;
+        pos = readHeaderValue(data, size, 2, width, &truncated);
+        pos = pos ? readHeaderValue(data, size, pos, height, &truncated) : 0;
+        pos = pos ? readHeaderValue(data, size, pos, &maxval, &truncated) : 0;
+        /* A single whitespace character separates the header from the data */
+        if (pos && pos < size && *width && *height && maxval && maxval <= 65535 && !(maxval > 255 && *psz == 3))
         {
-            if ('#' != line[0])
+            if (maxval > 255)
             {
-                if (1 == n)
-                    n += sscanf(line, "%d %d %d", width, height, &maxval);
-                else if (2 == n)
-                    n += sscanf(line, "%d %d", height, &maxval);
-                else if (3 == n)
-                    n += sscanf(line, "%d", &maxval);
+                /* Adjust size of data for maxval */
+                *psz <<= 1;
             }
+            *offset = pos + 1;
+            if (*offset <= file_size && (file_size - *offset) / ((size_t)*width * *psz) >= *height)
+                status = VX_SUCCESS;
         }
-        if (n < 4 || 0 == fmt || (maxval > 255 && *psz == 3))
+        else if (truncated && size < file_size)
+            status = VX_ERROR_NOT_SUFFICIENT;
+    }
+    return status;
+}
+
+/*
+isDirectFormat - returns non-zero if data in the file can be used as the image data without conversion.
+*/
+static int isDirectFormat(vx_df_image image_format, int psz)
+{
+    return (image_format == VX_DF_IMAGE_U8 && psz == 1) ||
+           (image_format == VX_DF_IMAGE_RGB && psz == 3) ||
+           (image_format == VX_DF_IMAGE_U16 && psz == 2 && isBigEndian());
+}
+
+/*
+fileAddressing - describe the pixel data in the file as an image patch.
+*/
+static vx_imagepatch_addressing_t fileAddressing(vx_uint32 width, vx_uint32 height, int psz)
+{
+    vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
+    addr.dim_x = width;
+    addr.dim_y = height;
+    addr.stride_x = psz;
+    addr.stride_y = width * psz;
+    addr.scale_x = VX_SCALE_UNITY;
+    addr.scale_y = VX_SCALE_UNITY;
+    addr.step_x = 1;
+    addr.step_y = 1;
+    return addr;
+}
+
+/*
+checkFile - check that the image in the file can be read into an image of the given size and format.
+*/
+static vx_status checkFile(int psz, vx_uint32 width, vx_uint32 height, vx_uint32 image_width, vx_uint32 image_height,
+                           vx_df_image image_format, enum read_image_crop crop, enum read_image_place place)
+{
+    vx_status status = VX_SUCCESS;
+    if ((READ_IMAGE_USE_NONE == crop && (width > image_width || height > image_height)) ||
+        (READ_IMAGE_PLACE_NONE == place && (width < image_width || height < image_height)))
+    {
+        /* Report an error because the dimension of the file image does not match the dimensions of the
+           vx_imge and caller has specified no cropping or positioning */
+        status = VX_ERROR_INVALID_DIMENSION;
+    }
+    else if (image_format != VX_DF_IMAGE_U8 && image_format != VX_DF_IMAGE_U16 &&
+             image_format != VX_DF_IMAGE_RGB && image_format != VX_DF_IMAGE_RGBX)
+    {
+        /* Report an error becuase the vx_image is in a format that is not supported */
+        status = VX_ERROR_NOT_SUPPORTED;
+    }
+    else if ((image_format == VX_DF_IMAGE_U8 && psz != 1) ||
+             (image_format == VX_DF_IMAGE_U16 && psz != 2) ||
+             (image_format == VX_DF_IMAGE_RGB && psz != 3) ||
+             (image_format == VX_DF_IMAGE_RGBX && psz != 3))
+    {
+        /* Report an error because the image file format does not match the vx_image */
+        status = VX_ERROR_INVALID_FORMAT;
+    }
+    return status;
+}
+
+/*
+insertPixels - crop, place and convert the pixel data from the file into image memory described by addr,
+filling the spare pixels as requested.
+*/
+static void insertPixels(const vx_uint8 *payload, int psz, vx_uint32 width, vx_uint32 height,
+                         void *imgp, const vx_imagepatch_addressing_t *addr, vx_df_image image_format,
+                         enum read_image_crop crop, enum read_image_place place, enum read_image_fill fill)
+{
+    vx_uint32 y;
+    vx_uint32 image_width = addr->dim_x, image_height = addr->dim_y;
+    vx_uint32 src_x_offset = 0, src_y_offset = 0, dst_x_offset = 0, dst_y_offset = 0;
+    vx_uint32 copy_width = image_width, copy_height = image_height;
+    size_t rowsize = (size_t)width * psz;
+    /* first calculate offsets */
+    if (width > image_width)
+    {
+        if (READ_IMAGE_USE_TOP_RIGHT == crop || READ_IMAGE_USE_BOTTOM_RIGHT == crop)
+          src_x_offset = width - image_width;
+        else if (READ_IMAGE_USE_CENTRE == crop)
+          src_x_offset = (width - image_width) / 2;
+    }
+    else if (image_width > width)
+    {
+        if (READ_IMAGE_PLACE_TOP_RIGHT == place || READ_IMAGE_PLACE_BOTTOM_RIGHT == place)
+          dst_x_offset = image_width - width;
+        else if (READ_IMAGE_PLACE_CENTRE == place)
+          dst_x_offset = (image_width - width) / 2;
+        copy_width = width;
+    }
+    if (height > image_height)
+    {
+        if (READ_IMAGE_USE_BOTTOM_LEFT == crop || READ_IMAGE_USE_BOTTOM_RIGHT == crop)
+          src_y_offset = height - image_height;
+        else if (READ_IMAGE_USE_CENTRE == crop)
+          src_y_offset = (height - image_height) / 2;
+    }
+    else if (image_height > height)
+    {
+        if (READ_IMAGE_PLACE_BOTTOM_LEFT == place || READ_IMAGE_PLACE_BOTTOM_RIGHT == place)
+          dst_y_offset = image_height - height;
+        else if (READ_IMAGE_PLACE_CENTRE == place)
+          dst_y_offset = (image_height - height) / 2;
+        copy_height = height;
+    }
+
+    /* Now insert the pixels a row span at a time, performing any necessary conversion */
+    for (y = 0; y < image_height; ++y)
+    {
+        vx_uint8 *dstrow = (vx_uint8 *)imgp + (size_t)y * addr->stride_y;
+        if (y < dst_y_offset || y >= dst_y_offset + copy_height)
         {
-            /* Report an error because the file is not of a recognised format */
-            status = VX_ERROR_NOT_SUPPORTED;
+            /* Fill rows above and below the file image */
+            if (READ_IMAGE_FILL_NONE != fill)
+                fillSpan(dstrow, image_width, fill, image_format);
+            continue;
         }
-        else if (maxval > 255)
+        if (READ_IMAGE_FILL_NONE != fill)
         {
-            /* Adjust size of data for maxval */
-            *psz <<= 1;
+            /* Fill pixels to the left and right of the file image */
+            fillSpan(dstrow, dst_x_offset, fill, image_format);
+            fillSpan(dstrow + (dst_x_offset + copy_width) * addr->stride_x,
+                     image_width - dst_x_offset - copy_width, fill, image_format);
         }
+        copySpan(dstrow + dst_x_offset * addr->stride_x,
+                 payload + (src_y_offset + y - dst_y_offset) * rowsize + src_x_offset * psz,
+                 copy_width, psz, image_format);
     }
-    else
-        status = VX_ERROR_NOT_SUPPORTED;
-    return status;
 }
 
 vx_status readImage(vx_image image, const char * filename, enum read_image_crop crop,
@@ -146,202 +480,267 @@ vx_status readImage(vx_image image, const char * filename, enum read_image_crop
     vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
     void * imgp;
     vx_map_id map_id;
-    status = status || vxMapImagePatch(image, &rect, 0, &map_id, &addr, &imgp, VX_READ_AND_WRITE, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+    struct mapped_file mf;
+    if (VX_SUCCESS == status)
+        status = mapFile(filename, &mf);
     if (VX_SUCCESS == status)
     {
-        FILE *fp = fopen(filename, "rb");
-        if (fp)
+        int psz = 0;             /* Size of a single pixel in the file */
+        vx_uint32 width = 0;     /* width of image in the file */
+        vx_uint32 height = 0;    /* height of image in the file */
+        size_t offset = 0;       /* Offset of the pixel data in the file */
+
+        status = parseHeader(mf.data, mf.size, mf.size, &psz, &width, &height, &offset);
+        if (VX_SUCCESS == status)
+            status = checkFile(psz, width, height, image_width, image_height, image_format, crop, place);
+
+        if (VX_SUCCESS == status)
         {
-            int psz = 0;       /* Size of a single pixel in the file */
-            vx_uint32 width = 0;     /* width of image in the file */
-            vx_uint32 height = 0;    /* height of image in the file */
+            if (width == image_width && height == image_height && isDirectFormat(image_format, psz))
+            {
+                /* Nothing to crop, place or convert, so copy the whole payload in one go */
+                vx_imagepatch_addressing_t file_addr = fileAddressing(width, height, psz);
+                status = vxCopyImagePatch(image, &rect, 0, &file_addr, mf.data + offset,
+                                          VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+            }
+            else if (VX_SUCCESS == (status = vxMapImagePatch(image, &rect, 0, &map_id, &addr, &imgp, VX_READ_AND_WRITE,
+                                                             VX_MEMORY_TYPE_HOST, VX_NOGAP_X)))
+            {
+                /* Now read the data and insert into the vx_image */
+                insertPixels(mf.data + offset, psz, width, height, imgp, &addr, image_format, crop, place, fill);
+                vxUnmapImagePatch(image, map_id);
+            }
+        } /* if (VX_SUCCESS == status) */
+        unmapFile(&mf);
+    } /*   if (VX_SUCCESS == vx_status) */
+    return status;
+}
+
+vx_status readImageToMemory(const char * filename, void *ptr, const vx_imagepatch_addressing_t *addr,
+                            vx_df_image image_format, enum read_image_crop crop,
+                            enum read_image_place place, enum read_image_fill fill)
+{
+    struct mapped_file mf;
+    vx_status status = mapFile(filename, &mf);
+    if (VX_SUCCESS == status)
+    {
+        int psz = 0;
+        vx_uint32 width = 0, height = 0;
+        size_t offset = 0;
+        status = parseHeader(mf.data, mf.size, mf.size, &psz, &width, &height, &offset);
+        if (VX_SUCCESS == status)
+            status = checkFile(psz, width, height, addr->dim_x, addr->dim_y, image_format, crop, place);
+        if (VX_SUCCESS == status)
+            insertPixels(mf.data + offset, psz, width, height, ptr, addr, image_format, crop, place, fill);
+        unmapFile(&mf);
+    }
+    return status;
+}
 
-            status = readHeader(fp, &psz, &width, &height);
+/*
+formatFromPixelSize - the vx_image format that holds file pixels of the given size without loss.
+*/
+static vx_df_image formatFromPixelSize(int psz)
+{
+    vx_df_image format;
+    switch (psz)
+    {
+        case 1:
+            format = VX_DF_IMAGE_U8;
+            break;
+        case 2:
+            format = VX_DF_IMAGE_U16;
+            break;
+        case 3:
+            format = VX_DF_IMAGE_RGB;
+            break;
+        default:
+            format = VX_DF_IMAGE_VIRT;
+            printf("Invalid value for psz: %d\n", psz);
+            break;
+    }
+    return format;
+}
 
-            if (VX_SUCCESS == status)
+vx_status probeImageFile(const char * filename, struct read_image_attributes *attr, size_t *offset)
+{
+    vx_uint8 *header = NULL;
+    vx_status status = VX_FAILURE;
+    FILE *fp = fopen(filename, "rb");
+    if (fp)
+    {
+        long size = 0 == fseek(fp, 0, SEEK_END) ? ftell(fp) : -1;
+        if (0 == size)
+            status = VX_ERROR_NOT_SUPPORTED;
+        else if (size > 0 && 0 == fseek(fp, 0, SEEK_SET))
+        {
+            int psz = 0;
+            vx_uint32 width = 0, height = 0;
+            size_t payload = 0, n = 0, capacity = 4096;
+            /* Headers are short, so one small read is usually enough; read more while comments run past it */
+            do
             {
-                /* Now check formats and sizes */
-                if ((READ_IMAGE_USE_NONE == crop && (width > image_width || height > image_height)) ||
-                    (READ_IMAGE_PLACE_NONE == place && (width < image_width || height < image_height)))
-                {
-                    /* Report an error because the dimension of the file image does not match the dimensions of the
-                       vx_imge and caller has specified no cropping or positioning */
-                    status = VX_ERROR_INVALID_DIMENSION;
-                }
-                else if (image_format != VX_DF_IMAGE_U8 && image_format != VX_DF_IMAGE_U16 &&
-                         image_format != VX_DF_IMAGE_RGB && image_format != VX_DF_IMAGE_RGBX)
+                vx_uint8 *grown;
+                if (capacity > (size_t)size)
+                    capacity = (size_t)size;
+                grown = (vx_uint8 *)realloc(header, capacity);
+                if (!grown)
                 {
-                    /* Report an error becuase the vx_image is in a format that is not supported */
-                    status = VX_ERROR_NOT_SUPPORTED;
+                    status = VX_ERROR_NO_MEMORY;
+                    break;
                 }
-                else if ((image_format == VX_DF_IMAGE_U8 && psz != 1) ||
-                         (image_format == VX_DF_IMAGE_U16 && psz != 2) ||
-                         (image_format == VX_DF_IMAGE_RGB && psz != 3) ||
-                         (image_format == VX_DF_IMAGE_RGBX && psz != 3))
+                header = grown;
+                n += fread(header + n, 1, capacity - n, fp);
+                status = parseHeader(header, n, (size_t)size, &psz, &width, &height, &payload);
+                capacity *= 2;
+            } while (VX_ERROR_NOT_SUFFICIENT == status && n == capacity / 2);
+            if (VX_SUCCESS == status)
+            {
+                if (NULL != attr)
                 {
-                    /* Report an error because the image file format does not match the vx_image */
-                    status = VX_ERROR_INVALID_FORMAT;
+                    attr->width = width;
+                    attr->height = height;
+                    attr->format = formatFromPixelSize(psz);
                 }
-                else /* Now read the data and insert into the vx_image */
-                {
-                    int x, y;
-                    int src_x_offset = 0, src_y_offset = 0, dst_x_offset = 0, dst_y_offset = 0;
-                    vx_uint32 copy_width = image_width, copy_height = image_height;
-                    vx_pixel_value_t fillValue = { .U32 = READ_IMAGE_FILL_ONES == fill ? 0xFFFFFF : 0 };
-                    void *filerow = calloc(width, psz);
-                    /* first calculate offsets */
-                    if (width > image_width)
-                    {
-                        if (READ_IMAGE_USE_TOP_RIGHT == crop || READ_IMAGE_USE_BOTTOM_RIGHT == crop)
-                          src_x_offset = width - image_width;
-                        else if (READ_IMAGE_USE_CENTRE == crop)
-                          src_x_offset = (width - image_width) / 2;
-                    }
-                    else if (image_width > width)
-                    {
-                        if (READ_IMAGE_PLACE_TOP_RIGHT == place || READ_IMAGE_PLACE_BOTTOM_RIGHT == place)
-                          dst_x_offset = image_width - width;
-                        else if (READ_IMAGE_PLACE_CENTRE == place)
-                          dst_x_offset = (image_width - width) / 2;
-                        copy_width = dst_x_offset + width;
-                    }
-                    if (height > image_height)
-                    {
-                        if (READ_IMAGE_USE_BOTTOM_LEFT == crop || READ_IMAGE_USE_BOTTOM_RIGHT == crop)
-                          src_y_offset = height - image_height;
-                        else if (READ_IMAGE_USE_CENTRE == crop)
-                          src_y_offset = (height - image_height) / 2;
-                    }
-                    else if (image_height > height)
-                    {
-                        if (READ_IMAGE_PLACE_BOTTOM_LEFT == place || READ_IMAGE_PLACE_BOTTOM_RIGHT == place)
-                          dst_y_offset = image_height - height;
-                        else if (READ_IMAGE_PLACE_CENTRE == place)
-                          dst_y_offset = (image_height - height) / 2;
-                        copy_height = dst_y_offset + height;
-                    }
-
-                    /* Skip initial rows in the file */
-                    for (y = 0; y < src_y_offset; ++y)
-                        fread(filerow, psz, width, fp);
-
-                    /* Now insert the pixels, performing any necessary conversion */
-                    for (y = 0; y < dst_y_offset; ++y)
-                    {
-                        /* Fill initial rows */
-                        if (READ_IMAGE_FILL_NONE != fill)
-                            for (x = 0; x < image_width; ++x)
-                                fillPixel(imgp, &addr, x, y, fillValue, image_format);
-                    }
-                    for (; y < copy_height; ++y)
-                    {
-                        /* Copy rows */
-                        for (x = 0; x < dst_x_offset; ++x)
-                            if (READ_IMAGE_FILL_NONE != fill)
-                            {
-                                /* Fill initial pixels on row */
-                                fillPixel(imgp, &addr, x, y, fillValue, image_format);
-                            }
-                        fread(filerow, psz, width, fp);
-                        for (; x < copy_width; ++x)
-                        {
-                            /* Copy pixels */
-                            copyPixel(filerow, imgp, &addr, x + src_x_offset, x + dst_x_offset,
-                                               y + dst_y_offset, psz, image_format);
-                        }
-                        if (READ_IMAGE_FILL_NONE != fill)
-                            for (; x < image_width; ++x)
-                            {
-                                /* Fill final pixels on row */
-                                fillPixel(imgp, &addr, x, y, fillValue, image_format);
-                            }
-                    }
-                    if (READ_IMAGE_FILL_NONE != fill)
-                        for (; y < image_height; ++y)
-                        {
-                            /* Fill final rows */
-                            for (x = 0; x < image_width; ++x)
-                                fillPixel(imgp, &addr, x, y, fillValue, image_format);
-                        } /* for */
-                    free(filerow);
-                }   /* else */
-            } /* if (VX_SUCCESS == status) */
-            fclose(fp);
-        } /* if (fp) */
-        else
-        {
-            /* Report an error because file could not be opened */
-            status = VX_FAILURE;
+                if (NULL != offset)
+                    *offset = payload;
+            }
+            else if (VX_ERROR_NOT_SUFFICIENT == status)
+                status = n > 0 ? VX_ERROR_NOT_SUPPORTED : VX_FAILURE;
         }
-        vxUnmapImagePatch(image, map_id);
-    } /*   if (VX_SUCCESS == vx_status) */
+        free(header);
+        fclose(fp);
+    }
     return status;
 }
 
-vx_image createImageFromFile(vx_context context, const char * filename, struct read_image_attributes *attr)
+/*
+createImageFromMapping - create a new image holding a copy of the data in a mapped file.
+*/
+static vx_image createImageFromMapping(vx_context context, const struct mapped_file *mf,
+                                       struct read_image_attributes *attr)
 {
-    FILE *fp = fopen(filename, "rb");
     vx_image image = NULL;
-    if (fp)
-    {
-        int psz = 0;             /* Size of a single pixel in the file */
-        vx_uint32 width = 0;     /* width of image in the file */
-        vx_uint32 height = 0;    /* height of image in the file */
-        vx_df_image format;
+    int psz = 0;             /* Size of a single pixel in the file */
+    vx_uint32 width = 0;     /* width of image in the file */
+    vx_uint32 height = 0;    /* height of image in the file */
+    size_t offset = 0;       /* Offset of the pixel data in the file */
 
-        if (VX_SUCCESS == readHeader(fp, &psz, &width, &height))
+    if (VX_SUCCESS == parseHeader(mf->data, mf->size, mf->size, &psz, &width, &height, &offset))
+    {
+        vx_df_image format = formatFromPixelSize(psz);
+        vx_rectangle_t rect = {.start_x = 0, .start_y = 0, .end_x = width, .end_y = height};
+        vx_status status;
+        image = vxCreateImage(context, width, height, format);
+        status = vxGetStatus((vx_reference)image);
+        if (VX_SUCCESS == status && isDirectFormat(format, psz))
         {
-            switch (psz)
-            {
-                case 1:
-                    format = VX_DF_IMAGE_U8;
-                    break;
-                case 2:
-                    format = VX_DF_IMAGE_U16;
-                    break;
-                case 3:
-                    format = VX_DF_IMAGE_RGB;
-                    break;
-                default:
-                    format = VX_DF_IMAGE_VIRT;
-                    printf("Invalid value for psz: %d\n", psz);
-                    break;
-            }
-            image = vxCreateImage(context, width, height, format);
-            vx_rectangle_t rect = {.start_x = 0, .start_y = 0, .end_x = width, .end_y = height};
+            /* Copy the payload in one go */
+            vx_imagepatch_addressing_t file_addr = fileAddressing(width, height, psz);
+            status = vxCopyImagePatch(image, &rect, 0, &file_addr, mf->data + offset,
+                                      VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+        }
+        else if (VX_SUCCESS == status)
+        {
+            /* Byte-swap 16-bit data from the file into the image */
             vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
             void * imgp;
             vx_map_id map_id;
-            if (VX_SUCCESS == (vxGetStatus((vx_reference)image) || 
-                               vxMapImagePatch(image, &rect, 0, &map_id, &addr, &imgp,
-                                               VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X)))
+            status = vxMapImagePatch(image, &rect, 0, &map_id, &addr, &imgp,
+                                     VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+            if (VX_SUCCESS == status)
             {
-                int x, y;
-                void *filerow = calloc(width, psz);
-                if (!filerow)
-                    printf("? Could not allocate memory for line\n");
-                for (y = 0; y < height; ++y)
-                {
-                    /* Copy rows */
-                    if (fread(filerow, psz, width, fp) != width)
-                        printf("Error reading file\n");
-                    for (x = 0; x < width; ++x)
-                    {
-                        /* Copy pixels */
-                        copyPixel(filerow, imgp, &addr, x, x, y, psz, format);
-                    }
-                }
-                free(filerow);
+                const vx_uint8 *filerow = mf->data + offset;
+                vx_uint32 y;
+                for (y = 0; y < height; ++y, filerow += (size_t)width * psz)
+                    copySpan((vx_uint8 *)vxFormatImagePatchAddress2d(imgp, 0, y, &addr), filerow, width, psz, format);
                 vxUnmapImagePatch(image, map_id);
+            }
+        }
+        if (VX_SUCCESS == status && NULL != attr)
+        {
+            attr->width = width;
+            attr->height = height;
+            attr->format = format;
+        }
+    }
+    return image;
+}
+
+vx_image createImageFromFile(vx_context context, const char * filename, struct read_image_attributes *attr)
+{
+    struct mapped_file mf;
+    vx_image image = NULL;
+    if (VX_SUCCESS == mapFile(filename, &mf))
+    {
+        image = createImageFromMapping(context, &mf, attr);
+        unmapFile(&mf);
+    }
+    return image;
+}
+
+vx_image createImageFromMappedFile(vx_context context, const char * filename, struct read_image_attributes *attr,
+                                   struct read_image_mapping **mapping)
+{
+    struct mapped_file mf;
+    vx_image image = NULL;
+    *mapping = NULL;
+    if (VX_SUCCESS == mapFile(filename, &mf))
+    {
+        int psz = 0;
+        vx_uint32 width = 0, height = 0;
+        size_t offset = 0;
+        if (VX_SUCCESS == parseHeader(mf.data, mf.size, mf.size, &psz, &width, &height, &offset) &&
+            isDirectFormat(formatFromPixelSize(psz), psz))
+        {
+            /* Wrap the mapped payload, the mapping must outlive the image */
+            vx_imagepatch_addressing_t file_addr = fileAddressing(width, height, psz);
+            void *ptrs[] = { mf.data + offset };
+            image = vxCreateImageFromHandle(context, formatFromPixelSize(psz), &file_addr, ptrs, VX_MEMORY_TYPE_HOST);
+            *mapping = (struct read_image_mapping *)malloc(sizeof(struct read_image_mapping));
+            if (VX_SUCCESS == vxGetStatus((vx_reference)image) && *mapping)
+            {
+                (*mapping)->file = mf;
                 if (NULL != attr)
                 {
                     attr->width = width;
                     attr->height = height;
-                    attr->format = format;
+                    attr->format = formatFromPixelSize(psz);
                 }
             }
+            else
+            {
+                if (VX_SUCCESS == vxGetStatus((vx_reference)image))
+                    vxReleaseImage(&image);
+                free(*mapping);
+                *mapping = NULL;
+                image = NULL;
+            }
+        }
+        if (NULL == *mapping)
+        {
+            /* Data needs conversion, or could not be wrapped, so fall back to a copy */
+            image = createImageFromMapping(context, &mf, attr);
+            unmapFile(&mf);
         }
-        fclose(fp);
     }
     return image;
 }
+
+void releaseMappedImage(vx_image *image, struct read_image_mapping **mapping)
+{
+    if (image && *image)
+    {
+        /* Take the file data back from the image, so that nothing can reach it once it is unmapped even if
+           a graph still holds a reference to the image */
+        if (mapping && *mapping)
+            vxSwapImageHandle(*image, NULL, NULL, 1);
+        vxReleaseImage(image);
+    }
+    if (mapping && *mapping)
+    {
+        unmapFile(&(*mapping)->file);
+        free(*mapping);
+        *mapping = NULL;
+    }
+}
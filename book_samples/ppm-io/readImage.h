@@ -41,7 +41,30 @@ struct read_image_attributes {  /* Struct to report back the attributes of the i
 vx_status readImage(vx_image image, const char *filename, enum read_image_crop crop,
                     enum read_image_place place, enum read_image_fill fill);
 
+/* As readImage, but into host memory laid out as described by addr (dim_x, dim_y, stride_x and stride_y are used),
+   without calling any OpenVX function. Useful to decode files on a thread other than the one using the image. */
+vx_status readImageToMemory(const char *filename, void *ptr, const vx_imagepatch_addressing_t *addr,
+                            vx_df_image image_format, enum read_image_crop crop,
+                            enum read_image_place place, enum read_image_fill fill);
+
 vx_image createImageFromFile(vx_context context, const char *filename, struct read_image_attributes *attr);
+
+/* Read only the header of a file, returning the attributes of the image createImageFromFile would create, and the
+   offset of the pixel data in the file in offset if it is not NULL */
+vx_status probeImageFile(const char *filename, struct read_image_attributes *attr, size_t *offset);
+
+/* Opaque handle to a file mapped into memory for use as the data of a vx_image */
+struct read_image_mapping;
+
+/* Create an image that uses the file data in place, without copying. If the file data needs conversion the
+   image is created as for createImageFromFile and *mapping is set to NULL. The image must be released with
+   releaseMappedImage so that the file is unmapped after the image is gone. */
+vx_image createImageFromMappedFile(vx_context context, const char *filename, struct read_image_attributes *attr,
+                                   struct read_image_mapping **mapping);
+
+/* Release the image and unmap the file. The file data is swapped out of the image first, so no graph using the
+   image may be running; a graph that still references it fails rather than read unmapped memory. */
+void releaseMappedImage(vx_image *image, struct read_image_mapping **mapping);
 #ifdef  __cplusplus
 }
 #endif
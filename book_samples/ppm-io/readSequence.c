@@ -0,0 +1,233 @@
+/*
+readSequence.c
+Read a numbered sequence of image files (.ppm, .pgm) into a vx_image.
+
+A worker thread decodes frames into a ring of pre-allocated host buffers, up to 'depth' frames ahead of the
+consumer. The vx_image handed out is created from a host handle, and readNextInSequence() makes the next frame
+current by swapping its buffer into the image with vxSwapImageHandle, so no pixels are copied and the graph
+never waits for the disk unless the worker has fallen behind. The buffer swapped out goes back into the ring
+to be refilled.
+
+The worker only calls readImageToMemory(), so no OpenVX function is ever called from the worker thread.
+*/
+#include <VX/vx.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "readSequence.h"
+
+struct read_sequence {
+    vx_image image;                   /* Image holding the current frame */
+    void *current;                    /* Buffer attached to the image */
+    char *pattern;                    /* printf-style pattern for the file names */
+    vx_imagepatch_addressing_t addr;  /* Layout of every buffer */
+    vx_df_image format;
+    vx_uint32 depth;                  /* Number of slots in the ring */
+    void **buffers;                   /* Buffer owned by each slot */
+    int *framenums;                   /* Frame number decoded into each slot */
+    vx_uint32 head, tail, count;      /* Next slot to fill, next slot to hand out, number of filled slots */
+    int next_frame;                   /* Next frame number to decode */
+    vx_status end_status;             /* Status of the read that ended the sequence */
+    int finished, stop;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t filled, emptied;
+};
+
+static int pixelSize(vx_df_image format)
+{
+    switch (format)
+    {
+        case VX_DF_IMAGE_U8: return 1;
+        case VX_DF_IMAGE_U16: return 2;
+        case VX_DF_IMAGE_RGB: return 3;
+        default: return 0;
+    }
+}
+
+static void *decodeFrames(void *arg)
+{
+    struct read_sequence *seq = (struct read_sequence *)arg;
+    char filename[1024];
+    pthread_mutex_lock(&seq->lock);
+    while (!seq->stop)
+    {
+        vx_uint32 slot;
+        int framenum;
+        vx_status status;
+        while (!seq->stop && seq->count == seq->depth)
+            pthread_cond_wait(&seq->emptied, &seq->lock);
+        if (seq->stop)
+            break;
+        slot = seq->head;
+        framenum = seq->next_frame;
+        pthread_mutex_unlock(&seq->lock);
+
+        /* The slot is not visible to the consumer until count is incremented, so decode without the lock */
+        snprintf(filename, sizeof(filename), seq->pattern, framenum);
+        status = readImageToMemory(filename, seq->buffers[slot], &seq->addr, seq->format,
+                                   READ_IMAGE_USE_NONE, READ_IMAGE_PLACE_NONE, READ_IMAGE_FILL_NONE);
+
+        pthread_mutex_lock(&seq->lock);
+        if (VX_SUCCESS != status)
+        {
+            seq->end_status = status;
+            seq->finished = 1;
+            pthread_cond_broadcast(&seq->filled);
+            break;
+        }
+        seq->framenums[slot] = framenum;
+        seq->head = (seq->head + 1) % seq->depth;
+        seq->next_frame++;
+        seq->count++;
+        pthread_cond_broadcast(&seq->filled);
+    }
+    pthread_mutex_unlock(&seq->lock);
+    return NULL;
+}
+
+struct read_sequence *openReadSequence(vx_context context, const char *pattern, int first, vx_uint32 depth,
+                                       struct read_image_attributes *attr)
+{
+    struct read_sequence *seq = NULL;
+    struct read_image_attributes first_attr;
+    char filename[1024];
+    vx_uint32 i;
+    size_t size;
+    int psz;
+
+    /* Use the header of the first file to find the size and format of the sequence */
+    snprintf(filename, sizeof(filename), pattern, first);
+    if (VX_SUCCESS != probeImageFile(filename, &first_attr, NULL))
+        return NULL;
+    psz = pixelSize(first_attr.format);
+    if (0 == psz)
+        return NULL;
+    if (0 == depth)
+        depth = 1;
+
+    seq = (struct read_sequence *)calloc(1, sizeof(struct read_sequence));
+    if (!seq)
+        return NULL;
+    seq->pattern = strdup(pattern);
+    seq->format = first_attr.format;
+    seq->depth = depth;
+    seq->next_frame = first;
+    seq->end_status = VX_FAILURE;
+    seq->addr.dim_x = first_attr.width;
+    seq->addr.dim_y = first_attr.height;
+    seq->addr.stride_x = psz;
+    seq->addr.stride_y = first_attr.width * psz;
+    seq->addr.scale_x = VX_SCALE_UNITY;
+    seq->addr.scale_y = VX_SCALE_UNITY;
+    seq->addr.step_x = 1;
+    seq->addr.step_y = 1;
+    size = (size_t)seq->addr.stride_y * first_attr.height;
+    seq->buffers = (void **)calloc(depth, sizeof(void *));
+    seq->framenums = (int *)calloc(depth, sizeof(int));
+    seq->current = calloc(1, size);
+    for (i = 0; seq->buffers && i < depth; ++i)
+    {
+        seq->buffers[i] = malloc(size);
+        if (!seq->buffers[i])
+            break;
+    }
+    if (seq->pattern && seq->buffers && seq->framenums && seq->current && i == depth)
+    {
+        void *ptrs[] = { seq->current };
+        seq->image = vxCreateImageFromHandle(context, seq->format, &seq->addr, ptrs, VX_MEMORY_TYPE_HOST);
+    }
+    if (VX_SUCCESS != vxGetStatus((vx_reference)seq->image))
+    {
+        seq->image = NULL;
+        closeReadSequence(&seq);
+        return NULL;
+    }
+
+    pthread_mutex_init(&seq->lock, NULL);
+    pthread_cond_init(&seq->filled, NULL);
+    pthread_cond_init(&seq->emptied, NULL);
+    if (pthread_create(&seq->thread, NULL, decodeFrames, seq))
+    {
+        /* No worker: report the sequence as already finished */
+        seq->finished = 1;
+        seq->thread = pthread_self();
+    }
+    if (NULL != attr)
+        *attr = first_attr;
+    return seq;
+}
+
+vx_image getReadSequenceImage(struct read_sequence *seq)
+{
+    vxRetainReference((vx_reference)seq->image);
+    return seq->image;
+}
+
+vx_status readNextInSequence(struct read_sequence *seq, int *framenum)
+{
+    vx_status status;
+    vx_uint32 slot;
+    void *next, *prev = NULL;
+
+    pthread_mutex_lock(&seq->lock);
+    while (0 == seq->count && !seq->finished)
+        pthread_cond_wait(&seq->filled, &seq->lock);
+    if (0 == seq->count)
+    {
+        pthread_mutex_unlock(&seq->lock);
+        return seq->end_status;
+    }
+    slot = seq->tail;
+    next = seq->buffers[slot];
+    if (NULL != framenum)
+        *framenum = seq->framenums[slot];
+    pthread_mutex_unlock(&seq->lock);
+
+    /* Make the decoded buffer current, and give the one it replaces back to the slot to be refilled */
+    status = vxSwapImageHandle(seq->image, &next, &prev, 1);
+    if (VX_SUCCESS == status)
+    {
+        seq->buffers[slot] = prev;
+        seq->current = next;
+    }
+
+    pthread_mutex_lock(&seq->lock);
+    seq->tail = (seq->tail + 1) % seq->depth;
+    seq->count--;
+    pthread_cond_signal(&seq->emptied);
+    pthread_mutex_unlock(&seq->lock);
+    return status;
+}
+
+void closeReadSequence(struct read_sequence **seq)
+{
+    vx_uint32 i;
+    struct read_sequence *s = *seq;
+    if (!s)
+        return;
+    if (s->image)
+    {
+        /* Stop the worker, then reclaim the buffer attached to the image before freeing it */
+        pthread_mutex_lock(&s->lock);
+        s->stop = 1;
+        pthread_cond_broadcast(&s->emptied);
+        pthread_mutex_unlock(&s->lock);
+        if (!pthread_equal(s->thread, pthread_self()))
+            pthread_join(s->thread, NULL);
+        vxSwapImageHandle(s->image, NULL, NULL, 1);
+        vxReleaseImage(&s->image);
+        pthread_cond_destroy(&s->emptied);
+        pthread_cond_destroy(&s->filled);
+        pthread_mutex_destroy(&s->lock);
+    }
+    for (i = 0; s->buffers && i < s->depth; ++i)
+        free(s->buffers[i]);
+    free(s->buffers);
+    free(s->framenums);
+    free(s->current);
+    free(s->pattern);
+    free(s);
+    *seq = NULL;
+}
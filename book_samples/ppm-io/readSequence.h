@@ -0,0 +1,34 @@
+/*
+readSequence.h
+Read a numbered sequence of image files (.ppm, .pgm) into a vx_image, decoding frames ahead on a worker thread.
+*/
+#ifndef _readSequence_h_included_
+#define _readSequence_h_included_
+#include "readImage.h"
+#ifdef  __cplusplus
+extern "C" {
+#endif
+/* Opaque handle to an open sequence */
+struct read_sequence;
+
+/* Open the sequence of files named by the printf-style pattern (which must contain a single integer conversion,
+   for example "frames/img%04d.pgm") starting at frame number first. Up to depth frames are decoded ahead.
+   All files must have the same size and format as the first, which are reported in attr if it is not NULL.
+   Returns NULL if the first file cannot be read. */
+struct read_sequence *openReadSequence(vx_context context, const char *pattern, int first, vx_uint32 depth,
+                                       struct read_image_attributes *attr);
+
+/* The image that holds the current frame. It is the same image for the life of the sequence, so it can be
+   used as a graph input. The caller must release the reference returned. */
+vx_image getReadSequenceImage(struct read_sequence *seq);
+
+/* Make the next frame current, waiting only if it has not been decoded yet. The frame number is returned in
+   framenum if it is not NULL. Returns VX_FAILURE after the last frame, or the error from the failing call. */
+vx_status readNextInSequence(struct read_sequence *seq, int *framenum);
+
+/* Stop the worker thread and release everything */
+void closeReadSequence(struct read_sequence **seq);
+#ifdef  __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,136 @@
+/*
+scanImages.c
+Probe every .ppm and .pgm file in a directory in parallel.
+Probing only reads the header of each file, so the cost is dominated by the latency of opening files, which
+overlaps well across threads.
+*/
+#include <VX/vx.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "scanImages.h"
+
+struct scan_work {
+    struct read_image_probe *probes;
+    vx_uint32 count;
+    vx_uint32 next;             /* Next probe to be done */
+    pthread_mutex_t lock;
+};
+
+static int isImageFile(const char *name)
+{
+    size_t len = strlen(name);
+    return len > 4 && (0 == strcasecmp(name + len - 4, ".ppm") || 0 == strcasecmp(name + len - 4, ".pgm"));
+}
+
+static int compareProbes(const void *a, const void *b)
+{
+    return strcmp(((const struct read_image_probe *)a)->filename, ((const struct read_image_probe *)b)->filename);
+}
+
+static void *probeFiles(void *arg)
+{
+    struct scan_work *work = (struct scan_work *)arg;
+    for (;;)
+    {
+        vx_uint32 i;
+        struct read_image_probe *probe;
+        pthread_mutex_lock(&work->lock);
+        i = work->next++;
+        pthread_mutex_unlock(&work->lock);
+        if (i >= work->count)
+            break;
+        probe = &work->probes[i];
+        probe->status = probeImageFile(probe->filename, &probe->attr, &probe->offset);
+    }
+    return NULL;
+}
+
+vx_status scanImageDirectory(const char *dirname, vx_uint32 threads, struct read_image_probe **probes,
+                             vx_uint32 *count)
+{
+    struct scan_work work;
+    struct dirent *entry;
+    vx_uint32 capacity = 0, i;
+    pthread_t *workers;
+    DIR *dir = opendir(dirname);
+    *probes = NULL;
+    *count = 0;
+    if (!dir)
+        return VX_FAILURE;
+
+    /* List the files first */
+    memset(&work, 0, sizeof(work));
+    while (NULL != (entry = readdir(dir)))
+    {
+        size_t len;
+        if (!isImageFile(entry->d_name))
+            continue;
+        if (work.count == capacity)
+        {
+            struct read_image_probe *grown;
+            capacity = capacity ? capacity * 2 : 64;
+            grown = (struct read_image_probe *)realloc(work.probes, capacity * sizeof(struct read_image_probe));
+            if (!grown)
+            {
+                closedir(dir);
+                releaseImageProbes(&work.probes, work.count);
+                return VX_ERROR_NO_MEMORY;
+            }
+            work.probes = grown;
+        }
+        len = strlen(dirname) + strlen(entry->d_name) + 2;
+        memset(&work.probes[work.count], 0, sizeof(struct read_image_probe));
+        work.probes[work.count].filename = (char *)malloc(len);
+        if (!work.probes[work.count].filename)
+        {
+            closedir(dir);
+            releaseImageProbes(&work.probes, work.count);
+            return VX_ERROR_NO_MEMORY;
+        }
+        snprintf(work.probes[work.count].filename, len, "%s/%s", dirname, entry->d_name);
+        work.probes[work.count].status = VX_FAILURE;
+        work.count++;
+    }
+    closedir(dir);
+    if (work.count > 1)
+        qsort(work.probes, work.count, sizeof(struct read_image_probe), compareProbes);
+
+    /* Then probe them, this thread taking a share of the work */
+    if (0 == threads)
+    {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = n > 0 ? (vx_uint32)n : 1;
+    }
+    if (threads > work.count)
+        threads = work.count ? work.count : 1;
+    pthread_mutex_init(&work.lock, NULL);
+    workers = (pthread_t *)calloc(threads, sizeof(pthread_t));
+    for (i = 1; workers && i < threads; ++i)
+        if (pthread_create(&workers[i], NULL, probeFiles, &work))
+            break;
+    probeFiles(&work);
+    while (workers && --i > 0)
+        pthread_join(workers[i], NULL);
+    free(workers);
+    pthread_mutex_destroy(&work.lock);
+
+    *probes = work.probes;
+    *count = work.count;
+    return VX_SUCCESS;
+}
+
+void releaseImageProbes(struct read_image_probe **probes, vx_uint32 count)
+{
+    vx_uint32 i;
+    if (!*probes)
+        return;
+    for (i = 0; i < count; ++i)
+        free((*probes)[i].filename);
+    free(*probes);
+    *probes = NULL;
+}
@@ -0,0 +1,29 @@
+/*
+scanImages.h
+Probe every .ppm and .pgm file in a directory, so that the vx_images for a batch can be created before any pixel
+data is read.
+*/
+#ifndef _scanImages_h_included_
+#define _scanImages_h_included_
+#include "readImage.h"
+#ifdef  __cplusplus
+extern "C" {
+#endif
+struct read_image_probe {       /* Result of probing one file */
+    char *filename;             /* Full path of the file */
+    vx_status status;           /* Result of probeImageFile */
+    struct read_image_attributes attr;
+    size_t offset;              /* Offset of the pixel data in the file */
+};
+
+/* Probe the files in dirname using the given number of threads (0 to use one per processor). The results are
+   sorted by file name and must be released with releaseImageProbes. Files that could not be probed are included
+   with their status set. */
+vx_status scanImageDirectory(const char *dirname, vx_uint32 threads, struct read_image_probe **probes,
+                             vx_uint32 *count);
+
+void releaseImageProbes(struct read_image_probe **probes, vx_uint32 count);
+#ifdef  __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,225 @@
+/*
+writeBehind.c
+Write images out to .ppm or .pgm files on a background thread.
+
+writeImageBehind() maps the image, copies it into the buffer of a free queue slot and returns. A worker thread
+takes slots off the queue in order and writes them with writeImageFromMemory(), so the worker never calls OpenVX.
+Slot buffers are allocated on first use and grown as needed, so a steady stream of same-sized images causes no
+allocation. The worker swaps the buffer of the slot it takes with its own, freeing the slot as soon as writing
+starts.
+*/
+#include <VX/vx.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "writeBehind.h"
+
+struct write_behind_item {
+    void *buffer;
+    size_t capacity;
+    vx_imagepatch_addressing_t addr;
+    vx_df_image format;
+    char filename[1024];
+};
+
+struct write_behind {
+    enum write_behind_policy policy;
+    vx_uint32 depth;
+    struct write_behind_item *items;  /* The queue */
+    struct write_behind_item writing; /* Owned by the worker */
+    vx_uint32 head, tail, count;      /* Next slot to fill, next slot to write, number of queued slots */
+    struct write_behind_stats stats;
+    vx_status first_error;
+    int stop;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t queued, emptied;
+};
+
+static void swapItems(struct write_behind_item *a, struct write_behind_item *b)
+{
+    struct write_behind_item t = *a;
+    *a = *b;
+    *b = t;
+}
+
+static void *writeQueued(void *arg)
+{
+    struct write_behind *sink = (struct write_behind *)arg;
+    pthread_mutex_lock(&sink->lock);
+    for (;;)
+    {
+        vx_status status;
+        while (!sink->stop && 0 == sink->count)
+            pthread_cond_wait(&sink->queued, &sink->lock);
+        if (0 == sink->count)
+            break;
+        swapItems(&sink->writing, &sink->items[sink->tail]);
+        sink->tail = (sink->tail + 1) % sink->depth;
+        sink->count--;
+        pthread_cond_signal(&sink->emptied);
+        pthread_mutex_unlock(&sink->lock);
+
+        status = writeImageFromMemory(sink->writing.buffer, &sink->writing.addr, sink->writing.format,
+                                      sink->writing.filename);
+
+        pthread_mutex_lock(&sink->lock);
+        if (VX_SUCCESS == status)
+            sink->stats.written++;
+        else
+        {
+            sink->stats.failed++;
+            if (VX_SUCCESS == sink->first_error)
+                sink->first_error = status;
+        }
+    }
+    pthread_mutex_unlock(&sink->lock);
+    return NULL;
+}
+
+struct write_behind *openWriteBehind(vx_uint32 depth, enum write_behind_policy policy)
+{
+    struct write_behind *sink = (struct write_behind *)calloc(1, sizeof(struct write_behind));
+    if (!sink)
+        return NULL;
+    sink->policy = policy;
+    sink->depth = depth ? depth : 1;
+    sink->first_error = VX_SUCCESS;
+    sink->items = (struct write_behind_item *)calloc(sink->depth, sizeof(struct write_behind_item));
+    if (!sink->items)
+    {
+        free(sink);
+        return NULL;
+    }
+    pthread_mutex_init(&sink->lock, NULL);
+    pthread_cond_init(&sink->queued, NULL);
+    pthread_cond_init(&sink->emptied, NULL);
+    if (pthread_create(&sink->thread, NULL, writeQueued, sink))
+    {
+        pthread_cond_destroy(&sink->emptied);
+        pthread_cond_destroy(&sink->queued);
+        pthread_mutex_destroy(&sink->lock);
+        free(sink->items);
+        free(sink);
+        return NULL;
+    }
+    return sink;
+}
+
+vx_status writeImageBehind(struct write_behind *sink, vx_image image, const char *filename)
+{
+    vx_uint32 image_width;
+    vx_uint32 image_height;
+    vx_df_image image_format;
+    vx_status status = vxGetStatus((vx_reference)image) ||
+                       vxQueryImage(image, VX_IMAGE_WIDTH, &image_width, sizeof(image_width)) ||
+                       vxQueryImage(image, VX_IMAGE_HEIGHT, &image_height, sizeof(image_height)) ||
+                       vxQueryImage(image, VX_IMAGE_FORMAT, &image_format, sizeof(image_format));
+    vx_rectangle_t rect = {.start_x = 0, .start_y = 0, .end_x = image_width, .end_y = image_height};
+    vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
+    struct write_behind_item *item;
+    void * imgp;
+    vx_map_id map_id;
+    size_t rowsize;
+    vx_uint32 y;
+
+    if (VX_SUCCESS != status)
+        return status;
+    if (image_format != VX_DF_IMAGE_U8 && image_format != VX_DF_IMAGE_U16 &&
+        image_format != VX_DF_IMAGE_RGB && image_format != VX_DF_IMAGE_RGBX)
+        return VX_ERROR_NOT_SUPPORTED;
+
+    /* Make space in the queue according to the policy */
+    pthread_mutex_lock(&sink->lock);
+    if (sink->count == sink->depth)
+    {
+        if (WRITE_BEHIND_DROP_NEWEST == sink->policy)
+        {
+            sink->stats.dropped++;
+            pthread_mutex_unlock(&sink->lock);
+            return VX_SUCCESS;
+        }
+        else if (WRITE_BEHIND_DROP_OLDEST == sink->policy)
+        {
+            sink->tail = (sink->tail + 1) % sink->depth;
+            sink->count--;
+            sink->stats.dropped++;
+        }
+        else
+        {
+            while (sink->count == sink->depth)
+                pthread_cond_wait(&sink->emptied, &sink->lock);
+        }
+    }
+    /* The head slot is not seen by the worker until count is incremented, so fill it without the lock */
+    item = &sink->items[sink->head];
+    pthread_mutex_unlock(&sink->lock);
+
+    status = vxMapImagePatch(image, &rect, 0, &map_id, &addr, &imgp, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+    if (VX_SUCCESS != status)
+        return status;
+    rowsize = (size_t)image_width * addr.stride_x;
+    if (item->capacity < rowsize * image_height)
+    {
+        void *buffer = realloc(item->buffer, rowsize * image_height);
+        if (!buffer)
+        {
+            vxUnmapImagePatch(image, map_id);
+            return VX_ERROR_NO_MEMORY;
+        }
+        item->buffer = buffer;
+        item->capacity = rowsize * image_height;
+    }
+    if ((size_t)addr.stride_y == rowsize)
+        memcpy(item->buffer, imgp, rowsize * image_height);
+    else
+        for (y = 0; y < image_height; ++y)
+            memcpy((vx_uint8 *)item->buffer + y * rowsize, (vx_uint8 *)imgp + (size_t)y * addr.stride_y, rowsize);
+    vxUnmapImagePatch(image, map_id);
+    item->addr = addr;
+    item->addr.stride_y = (vx_int32)rowsize;
+    item->format = image_format;
+    snprintf(item->filename, sizeof(item->filename), "%s", filename);
+
+    pthread_mutex_lock(&sink->lock);
+    sink->head = (sink->head + 1) % sink->depth;
+    sink->count++;
+    sink->stats.queued++;
+    pthread_cond_signal(&sink->queued);
+    pthread_mutex_unlock(&sink->lock);
+    return VX_SUCCESS;
+}
+
+void getWriteBehindStats(struct write_behind *sink, struct write_behind_stats *stats)
+{
+    pthread_mutex_lock(&sink->lock);
+    *stats = sink->stats;
+    pthread_mutex_unlock(&sink->lock);
+}
+
+vx_status closeWriteBehind(struct write_behind **sink)
+{
+    vx_status status;
+    vx_uint32 i;
+    struct write_behind *s = *sink;
+    if (!s)
+        return VX_ERROR_INVALID_PARAMETERS;
+    /* The worker empties the queue before it sees the stop flag */
+    pthread_mutex_lock(&s->lock);
+    s->stop = 1;
+    pthread_cond_signal(&s->queued);
+    pthread_mutex_unlock(&s->lock);
+    pthread_join(s->thread, NULL);
+    status = s->first_error;
+    pthread_cond_destroy(&s->emptied);
+    pthread_cond_destroy(&s->queued);
+    pthread_mutex_destroy(&s->lock);
+    for (i = 0; i < s->depth; ++i)
+        free(s->items[i].buffer);
+    free(s->writing.buffer);
+    free(s->items);
+    free(s);
+    *sink = NULL;
+    return status;
+}
@@ -0,0 +1,41 @@
+/*
+writeBehind.h
+Write images out to .ppm or .pgm files on a background thread, so that the caller does not wait for the disk.
+Supported image formats are those supported by writeImage.
+*/
+#ifndef _writeBehind_h_included_
+#define _writeBehind_h_included_
+#include "writeImage.h"
+#ifdef  __cplusplus
+extern "C" {
+#endif
+enum write_behind_policy {
+  WRITE_BEHIND_BLOCK,            /* Wait for space in the queue when it is full */
+  WRITE_BEHIND_DROP_OLDEST,      /* Discard the oldest queued image to make space for the new one */
+  WRITE_BEHIND_DROP_NEWEST       /* Discard the new image when the queue is full */
+};
+
+struct write_behind_stats {     /* Counts of images since the sink was opened */
+    vx_uint32 queued, written, dropped, failed;
+};
+
+/* Opaque handle to a sink */
+struct write_behind;
+
+/* Open a sink that holds at most depth images waiting to be written */
+struct write_behind *openWriteBehind(vx_uint32 depth, enum write_behind_policy policy);
+
+/* Copy the image into a pooled buffer and queue it to be written to filename. Returns as soon as the image has
+   been copied, or after waiting for space with WRITE_BEHIND_BLOCK. A dropped image is not an error; see the
+   stats. Must be called from one thread at a time. */
+vx_status writeImageBehind(struct write_behind *sink, vx_image image, const char *filename);
+
+void getWriteBehindStats(struct write_behind *sink, struct write_behind_stats *stats);
+
+/* Write everything still queued, stop the background thread and release the sink. Returns VX_SUCCESS if every
+   image that was not dropped was written, or the first error otherwise. */
+vx_status closeWriteBehind(struct write_behind **sink);
+#ifdef  __cplusplus
+}
+#endif
+#endif
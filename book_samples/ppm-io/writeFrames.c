@@ -0,0 +1,190 @@
+/*
+writeFrames.c
+Append images to a multi-frame file. The layout is described in frameFile.h.
+Each frame is written with a single fwrite when the mapped image has no gaps between rows. A frame that cannot be
+written completely is removed again, so that the file only ever holds whole frames.
+*/
+#include <VX/vx.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__unix__) || defined(__APPLE__)
+#define WRITE_FRAMES_USE_TRUNCATE 1
+#include <sys/types.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#define ftello _ftelli64
+#define fseeko _fseeki64
+#endif
+#include "frameFile.h"
+
+struct frame_writer {
+    FILE *fp;
+    vx_uint32 width, height;
+    vx_df_image format;
+    size_t frame_size;     /* Bytes of pixel data in a frame */
+    size_t frame_stride;   /* Bytes between the start of consecutive frames */
+    vx_uint64 *index;      /* Offset of each frame written */
+    vx_uint32 count, capacity;
+    int corrupt;           /* A partial frame could not be removed; nothing more is written */
+};
+
+static void putLE32(vx_uint8 *p, vx_uint32 v)
+{
+    p[0] = (vx_uint8)v;
+    p[1] = (vx_uint8)(v >> 8);
+    p[2] = (vx_uint8)(v >> 16);
+    p[3] = (vx_uint8)(v >> 24);
+}
+
+static void putLE64(vx_uint8 *p, vx_uint64 v)
+{
+    putLE32(p, (vx_uint32)v);
+    putLE32(p + 4, (vx_uint32)(v >> 32));
+}
+
+static vx_status writeHeader(struct frame_writer *writer, vx_uint64 index_offset)
+{
+    vx_uint8 header[FRAME_FILE_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, "VXFRAMES", 8);
+    putLE32(header + 8, 1);
+    putLE32(header + 12, writer->width);
+    putLE32(header + 16, writer->height);
+    putLE32(header + 20, writer->format);
+    putLE32(header + 24, writer->count);
+    putLE64(header + 32, index_offset);
+    return fwrite(header, sizeof(header), 1, writer->fp) == 1 ? VX_SUCCESS : VX_FAILURE;
+}
+
+struct frame_writer *openFrameWriter(const char *filename, vx_uint32 width, vx_uint32 height, vx_df_image format)
+{
+    struct frame_writer *writer;
+    int psz = framePixelSize(format);
+    if (0 == psz || 0 == width || 0 == height)
+        return NULL;
+    writer = (struct frame_writer *)calloc(1, sizeof(struct frame_writer));
+    if (!writer)
+        return NULL;
+    writer->width = width;
+    writer->height = height;
+    writer->format = format;
+    writer->frame_size = (size_t)width * height * psz;
+    writer->frame_stride = (writer->frame_size + FRAME_FILE_ALIGNMENT - 1) / FRAME_FILE_ALIGNMENT * FRAME_FILE_ALIGNMENT;
+    writer->fp = fopen(filename, "wb");
+    if (!writer->fp || VX_SUCCESS != writeHeader(writer, 0))
+    {
+        if (writer->fp)
+            fclose(writer->fp);
+        free(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+/* Remove the partial frame that starts at offset after a failed write: the next frame or the index is written
+   over it, and the file is truncated where possible. If the file position cannot be restored the file is marked
+   corrupt. */
+static void dropPartialFrame(struct frame_writer *writer, vx_int64 offset)
+{
+    clearerr(writer->fp);
+    if (offset < 0 || fseeko(writer->fp, offset, SEEK_SET))
+    {
+        writer->corrupt = 1;
+        return;
+    }
+#if WRITE_FRAMES_USE_TRUNCATE
+    if (fflush(writer->fp) || ftruncate(fileno(writer->fp), (off_t)offset))
+        writer->corrupt = 1;
+#endif
+}
+
+vx_status writeFrame(struct frame_writer *writer, vx_image image)
+{
+    static const vx_uint8 padding[FRAME_FILE_ALIGNMENT] = { 0 };
+    vx_uint32 image_width;
+    vx_uint32 image_height;
+    vx_df_image image_format;
+    vx_status status = vxGetStatus((vx_reference)image) ||
+                       vxQueryImage(image, VX_IMAGE_WIDTH, &image_width, sizeof(image_width)) ||
+                       vxQueryImage(image, VX_IMAGE_HEIGHT, &image_height, sizeof(image_height)) ||
+                       vxQueryImage(image, VX_IMAGE_FORMAT, &image_format, sizeof(image_format));
+    vx_rectangle_t rect = {.start_x = 0, .start_y = 0, .end_x = image_width, .end_y = image_height};
+    vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
+    void * imgp;
+    vx_map_id map_id;
+    if (VX_SUCCESS != status)
+        return status;
+    if (writer->corrupt)
+        return VX_FAILURE;
+    if (image_width != writer->width || image_height != writer->height || image_format != writer->format)
+        return VX_ERROR_INVALID_FORMAT;
+    if (writer->count == writer->capacity)
+    {
+        vx_uint32 capacity = writer->capacity ? writer->capacity * 2 : 256;
+        vx_uint64 *index = (vx_uint64 *)realloc(writer->index, capacity * sizeof(vx_uint64));
+        if (!index)
+            return VX_ERROR_NO_MEMORY;
+        writer->index = index;
+        writer->capacity = capacity;
+    }
+    status = vxMapImagePatch(image, &rect, 0, &map_id, &addr, &imgp, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+    if (VX_SUCCESS == status)
+    {
+        size_t rowsize = writer->frame_size / image_height;
+        vx_int64 offset = (vx_int64)ftello(writer->fp);
+        if (offset < 0)
+            status = VX_FAILURE;
+        else if ((size_t)addr.stride_y == rowsize)
+        {
+            if (fwrite(imgp, writer->frame_size, 1, writer->fp) != 1)
+                status = VX_FAILURE;
+        }
+        else
+        {
+            vx_uint32 y;
+            for (y = 0; VX_SUCCESS == status && y < image_height; ++y)
+                if (fwrite(vxFormatImagePatchAddress2d(imgp, 0, y, &addr), rowsize, 1, writer->fp) != 1)
+                    status = VX_FAILURE;
+        }
+        vxUnmapImagePatch(image, map_id);
+        if (VX_SUCCESS == status && writer->frame_stride > writer->frame_size &&
+            fwrite(padding, writer->frame_stride - writer->frame_size, 1, writer->fp) != 1)
+            status = VX_FAILURE;
+        if (VX_SUCCESS == status)
+            writer->index[writer->count++] = (vx_uint64)offset;
+        else
+            dropPartialFrame(writer, offset);
+    }
+    return status;
+}
+
+vx_status closeFrameWriter(struct frame_writer **writer)
+{
+    vx_status status = VX_SUCCESS;
+    struct frame_writer *w = *writer;
+    vx_uint64 index_offset;
+    vx_uint32 i;
+    if (!w)
+        return VX_ERROR_INVALID_PARAMETERS;
+    /* A corrupt file keeps the header of an unfinished one, so the reader only recovers the whole frames */
+    if (w->corrupt)
+        status = VX_FAILURE;
+    index_offset = (vx_uint64)ftello(w->fp);
+    for (i = 0; VX_SUCCESS == status && i < w->count; ++i)
+    {
+        vx_uint8 entry[8];
+        putLE64(entry, w->index[i]);
+        if (fwrite(entry, sizeof(entry), 1, w->fp) != 1)
+            status = VX_FAILURE;
+    }
+    /* Only now is the header updated, so a file that was not closed is still recognised as unfinished */
+    if (VX_SUCCESS == status && (fseeko(w->fp, 0, SEEK_SET) || VX_SUCCESS != writeHeader(w, index_offset)))
+        status = VX_FAILURE;
+    if (fclose(w->fp))
+        status = VX_FAILURE;
+    free(w->index);
+    free(w);
+    *writer = NULL;
+    return status;
+}
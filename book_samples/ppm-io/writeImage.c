@@ -10,26 +10,80 @@ Return values:
 VX_SUCCESS : all is OK!
 VX_FAILURE: Could not open file or write error
 VX_ERROR_NOT_SUPPORTED: Image is not of a supported format
+VX_ERROR_NO_MEMORY: Could not allocate the staging buffer
 Another error may be reported if there is a problem with the image itself.
+
+The data is written a row at a time from a staging buffer, or as a single block when the mapped
+plane is contiguous and needs no conversion. 16-bit samples are stored most significant byte first
+as required by the pgm format.
 */
 #include <VX/vx.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
 #include "writeImage.h"
 
-vx_status writeImage(vx_image image, const char *filename)
+/*
+isBigEndian - returns non-zero if the host stores the most significant byte of a vx_uint16 first.
+*/
+static int isBigEndian(void)
 {
-    vx_uint32 image_width;
-    vx_uint32 image_height;
-    vx_df_image image_format;
-    vx_status status = vxGetStatus((vx_reference)image) || 
-                       vxQueryImage(image, VX_IMAGE_WIDTH, &image_width, sizeof(image_width)) ||
-                       vxQueryImage(image, VX_IMAGE_HEIGHT, &image_height, sizeof(image_height)) ||
-                       vxQueryImage(image, VX_IMAGE_FORMAT, &image_format, sizeof(image_format));
-    vx_rectangle_t rect = {.start_x = 0, .start_y = 0, .end_x = image_width, .end_y = image_height};
-    vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
-    void * imgp;
-    vx_map_id map_id;
+    const vx_uint16 one = 1;
+    return 0 == *(const vx_uint8 *)&one;
+}
+
+/*
+swapRow16 - copy a row of 16-bit samples, swapping the bytes of each.
+*/
+static void swapRow16(vx_uint16 * restrict dst, const vx_uint16 * restrict src, vx_uint32 count)
+{
+    vx_uint32 i;
+    for (i = 0; i < count; ++i)
+        dst[i] = (vx_uint16)((src[i] >> 8) | (src[i] << 8));
+}
+
+/*
+packRowRGBX - copy a row of RGBX pixels into RGB triplets, dropping the fourth channel.
+The reverse of expandSpanRGB in readImage.c, with the same NEON and SSSE3 paths.
+*/
+static void packRowRGBX(vx_uint8 * restrict dst, const vx_uint8 * restrict src, vx_uint32 count)
+{
+    vx_uint32 i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 16 <= count; i += 16, src += 64, dst += 48)
+    {
+        uint8x16x4_t rgbx = vld4q_u8(src);
+        uint8x16x3_t rgb = {{ rgbx.val[0], rgbx.val[1], rgbx.val[2] }};
+        vst3q_u8(dst, rgb);
+    }
+#elif defined(__SSSE3__)
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    /* Each store writes 16 bytes for 4 pixels, so stop while 16 bytes remain in the row */
+    for (; i + 6 <= count; i += 4, src += 16, dst += 12)
+    {
+        __m128i rgbx = _mm_loadu_si128((const __m128i *)src);
+        _mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(rgbx, shuffle));
+    }
+#endif
+    for (; i < count; ++i, src += 4, dst += 3)
+    {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+    }
+}
+
+vx_status writeImageFromMemory(const void *ptr, const vx_imagepatch_addressing_t *addr, vx_df_image image_format,
+                               const char *filename)
+{
+    vx_status status = VX_SUCCESS;
+    vx_uint32 image_width = addr->dim_x;
+    vx_uint32 image_height = addr->dim_y;
     int maxval, psz;
     char fmt;
     switch (image_format)
@@ -53,26 +107,70 @@ vx_status writeImage(vx_image image, const char *filename)
         default:
             status = VX_ERROR_NOT_SUPPORTED;
     }
-    status = status || vxMapImagePatch(image, &rect, 0, &map_id, &addr, &imgp, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
     if (VX_SUCCESS == status)
     {
         FILE *fp = fopen(filename, "wb");
         if (fp)
         {
+            size_t rowsize = (size_t)image_width * psz;
+            int swap = VX_DF_IMAGE_U16 == image_format && !isBigEndian();
+            int pack = VX_DF_IMAGE_RGBX == image_format;
             fprintf(fp, "P%c\n%d %d\n%d\n", fmt, image_width, image_height, maxval);
-            int x, y;
-            for (y = 0; y < image_height; ++y)
-                for (x = 0; x < image_width; ++x)
+            if (!swap && !pack && addr->stride_x == psz && (size_t)addr->stride_y == rowsize)
+            {
+                /* The plane is exactly the file payload, write it in one go */
+                if (fwrite(ptr, rowsize, image_height, fp) != image_height)
+                    status = VX_FAILURE;
+            }
+            else
+            {
+                /* Write a row at a time, converting into the staging buffer if necessary */
+                vx_uint8 *staging = (swap || pack) ? malloc(rowsize) : NULL;
+                vx_uint32 y;
+                if ((swap || pack) && !staging)
+                    status = VX_ERROR_NO_MEMORY;
+                for (y = 0; VX_SUCCESS == status && y < image_height; ++y)
                 {
-                    if (fwrite(vxFormatImagePatchAddress2d(imgp, x, y, &addr), 1, psz, fp) != psz)
+                    const void *row = (const vx_uint8 *)ptr + (size_t)y * addr->stride_y;
+                    if (swap)
+                        swapRow16((vx_uint16 *)staging, (const vx_uint16 *)row, image_width);
+                    else if (pack)
+                        packRowRGBX(staging, (const vx_uint8 *)row, image_width);
+                    if (fwrite(staging ? staging : row, 1, rowsize, fp) != rowsize)
                         status = VX_FAILURE;
                 }
+                free(staging);
+            }
             if (fclose(fp))
                 status = VX_FAILURE;
         }
         else
             status = VX_FAILURE;
+    }
+    return status;
+}
+
+vx_status writeImage(vx_image image, const char *filename)
+{
+    vx_uint32 image_width;
+    vx_uint32 image_height;
+    vx_df_image image_format;
+    vx_status status = vxGetStatus((vx_reference)image) ||
+                       vxQueryImage(image, VX_IMAGE_WIDTH, &image_width, sizeof(image_width)) ||
+                       vxQueryImage(image, VX_IMAGE_HEIGHT, &image_height, sizeof(image_height)) ||
+                       vxQueryImage(image, VX_IMAGE_FORMAT, &image_format, sizeof(image_format));
+    vx_rectangle_t rect = {.start_x = 0, .start_y = 0, .end_x = image_width, .end_y = image_height};
+    vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
+    void * imgp;
+    vx_map_id map_id;
+    if (VX_SUCCESS == status && image_format != VX_DF_IMAGE_U8 && image_format != VX_DF_IMAGE_U16 &&
+        image_format != VX_DF_IMAGE_RGB && image_format != VX_DF_IMAGE_RGBX)
+        status = VX_ERROR_NOT_SUPPORTED;
+    status = status || vxMapImagePatch(image, &rect, 0, &map_id, &addr, &imgp, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X);
+    if (VX_SUCCESS == status)
+    {
+        status = writeImageFromMemory(imgp, &addr, image_format, filename);
         vxUnmapImagePatch(image, map_id);
     }
     return status;
-}
\ No newline at end of file
+}
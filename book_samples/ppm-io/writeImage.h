@@ -13,6 +13,10 @@ Supported image formats:
 extern "C" {
 #endif
     vx_status writeImage(vx_image image, const char *filename);
+    /* As writeImage, but from host memory laid out as described by addr (dim_x, dim_y, stride_x and stride_y
+       are used), without calling any OpenVX function. */
+    vx_status writeImageFromMemory(const void *ptr, const vx_imagepatch_addressing_t *addr, vx_df_image image_format,
+                                   const char *filename);
 #ifdef  __cplusplus
 }
 #endif
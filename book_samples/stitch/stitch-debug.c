@@ -35,11 +35,12 @@
 #include <stdlib.h>
 #include "VX/vx.h"
 #include "vxa/vxa.h"
+#include "nodePerf.h"
 
 vx_graph makeFilterGraph(vx_context context, vx_image image1, vx_image image2,
   vx_remap remap1, vx_image coeffs1, vx_remap remap2, vx_image coeffs2,
   vx_image output, vx_image output_remapped1, vx_image output_remapped2,
-  vx_image output_weighted1, vx_image output_weighted2)
+  vx_image output_weighted1, vx_image output_weighted2, struct node_perf_report *report)
 {
     /* Create virtual images */
     const int numu8 = 5;
@@ -96,46 +97,46 @@ vx_graph makeFilterGraph(vx_context context, vx_image image1, vx_image image2,
     {
       /* First, extract input and logo R, G, and B channels to individual
       virtual images */
-      vxChannelExtractNode(graph, image1, channels[i], virtu8[0][i]);
-      vxChannelExtractNode(graph, image2, channels[i], virtu8[1][i]);
+      addNodeToPerfReport(report, "stitch", vxChannelExtractNode(graph, image1, channels[i], virtu8[0][i]));
+      addNodeToPerfReport(report, "stitch", vxChannelExtractNode(graph, image2, channels[i], virtu8[1][i]));
 
       /* Add remap nodes */
-      vxRemapNode(graph, virtu8[0][i], remap1, VX_INTERPOLATION_BILINEAR,
-        image_remapped1[i]);
-      vxRemapNode(graph, virtu8[1][i], remap2, VX_INTERPOLATION_BILINEAR,
-        image_remapped2[i]);
+      addNodeToPerfReport(report, "stitch", vxRemapNode(graph, virtu8[0][i], remap1, VX_INTERPOLATION_BILINEAR,
+        image_remapped1[i]));
+      addNodeToPerfReport(report, "stitch", vxRemapNode(graph, virtu8[1][i], remap2, VX_INTERPOLATION_BILINEAR,
+        image_remapped2[i]));
 
       /* add multiply nodes */
-      vxMultiplyNode(graph, image_remapped1[i], coeffs1, scale,
+      addNodeToPerfReport(report, "stitch", vxMultiplyNode(graph, image_remapped1[i], coeffs1, scale,
         VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_NEAREST_EVEN,
-        image_weighted1[i]);
-      vxMultiplyNode(graph, image_remapped2[i], coeffs2, scale,
+        image_weighted1[i]));
+      addNodeToPerfReport(report, "stitch", vxMultiplyNode(graph, image_remapped2[i], coeffs2, scale,
         VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_NEAREST_EVEN,
-        image_weighted2[i]);
+        image_weighted2[i]));
 
-      vxAddNode(graph, image_weighted1[i], image_weighted2[i],
-        VX_CONVERT_POLICY_SATURATE, virts16[0][i]);
+      addNodeToPerfReport(report, "stitch", vxAddNode(graph, image_weighted1[i], image_weighted2[i],
+        VX_CONVERT_POLICY_SATURATE, virts16[0][i]));
 
       /* convert from S16 to U8 */
-      vxConvertDepthNode(graph, virts16[0][i], virtu8[2][i],
-        VX_CONVERT_POLICY_SATURATE, shift);
+      addNodeToPerfReport(report, "stitch", vxConvertDepthNode(graph, virts16[0][i], virtu8[2][i],
+        VX_CONVERT_POLICY_SATURATE, shift));
 
-      vxConvertDepthNode(graph, image_weighted1[i], virtu8[3][i],
-          VX_CONVERT_POLICY_SATURATE, shift);
-      vxConvertDepthNode(graph, image_weighted2[i], virtu8[4][i],
-          VX_CONVERT_POLICY_SATURATE, shift);
+      addNodeToPerfReport(report, "stitch", vxConvertDepthNode(graph, image_weighted1[i], virtu8[3][i],
+          VX_CONVERT_POLICY_SATURATE, shift));
+      addNodeToPerfReport(report, "stitch", vxConvertDepthNode(graph, image_weighted2[i], virtu8[4][i],
+          VX_CONVERT_POLICY_SATURATE, shift));
     }
 
-    vxChannelCombineNode(graph, virtu8[2][0], virtu8[2][1], virtu8[2][2],
-      NULL, output);
-    vxChannelCombineNode(graph, image_remapped1[0], image_remapped1[1],
-      image_remapped1[2], NULL, output_remapped1);
-    vxChannelCombineNode(graph, image_remapped2[0], image_remapped2[1],
-        image_remapped2[2], NULL, output_remapped2);
-    vxChannelCombineNode(graph, virtu8[3][0], virtu8[3][1],
-        virtu8[3][2], NULL, output_weighted1);
-    vxChannelCombineNode(graph, virtu8[4][0], virtu8[4][1],
-        virtu8[4][2], NULL, output_weighted2);
+    addNodeToPerfReport(report, "stitch", vxChannelCombineNode(graph, virtu8[2][0], virtu8[2][1], virtu8[2][2],
+      NULL, output));
+    addNodeToPerfReport(report, "stitch", vxChannelCombineNode(graph, image_remapped1[0], image_remapped1[1],
+      image_remapped1[2], NULL, output_remapped1));
+    addNodeToPerfReport(report, "stitch", vxChannelCombineNode(graph, image_remapped2[0], image_remapped2[1],
+        image_remapped2[2], NULL, output_remapped2));
+    addNodeToPerfReport(report, "stitch", vxChannelCombineNode(graph, virtu8[3][0], virtu8[3][1],
+        virtu8[3][2], NULL, output_weighted1));
+    addNodeToPerfReport(report, "stitch", vxChannelCombineNode(graph, virtu8[4][0], virtu8[4][1],
+        virtu8[4][2], NULL, output_weighted2));
 
     for (i = 0; i < numu8; i++)
       for(j = 0; j < 3; j++)
@@ -231,9 +232,10 @@ int main(int argc, char **argv)
 
     /* Create a graph */
     vx_status status;
+    struct node_perf_report *report = createNodePerfReport(context);
     vx_graph graph = makeFilterGraph(context, image1, image2,
       remap1, coeffs1, remap2, coeffs2, output, remapped1, remapped2,
-      weighted1, weighted2);
+      weighted1, weighted2, report);
 
     vxRegisterLogCallback(context, log_callback, vx_true_e);
 
@@ -265,5 +267,8 @@ int main(int argc, char **argv)
     vxReleaseImage(&weighted1);
     vxReleaseImage(&weighted2);
 
+    sampleNodePerfReport(report);
+    printNodePerfReport(report);
+    releaseNodePerfReport(&report);
     vxReleaseContext(&context);
 }
@@ -34,10 +34,11 @@
 #include <VX/vx.h>
 #include <VX/vxu.h>
 #include "vxa/vxa.h"
+#include "nodePerf.h"
 
 const int max_pyr_levels = 4;
 
-vx_status _vxLaplacianPyramidNode(vx_graph graph, vx_image image, vx_pyramid pyr_image, vx_image output)
+vx_status _vxLaplacianPyramidNode(vx_graph graph, vx_image image, vx_pyramid pyr_image, vx_image output, struct node_perf_report *report)
 {
   vx_context context = vxGetContext((vx_reference)graph);
 
@@ -54,7 +55,7 @@ vx_status _vxLaplacianPyramidNode(vx_graph graph, vx_image image, vx_pyramid pyr
   vx_pyramid pyr_gauss = vxCreateVirtualPyramid(graph, level_num + 1, VX_SCALE_PYRAMID_HALF,
     width, height, VX_DF_IMAGE_U8);
 
-  vxGaussianPyramidNode(graph, image, pyr_gauss);
+  addNodeToPerfReport(report, "stitch", vxGaussianPyramidNode(graph, image, pyr_gauss));
 
   for(int i = 0; i < level_num; i++)
   {
@@ -69,11 +70,11 @@ vx_status _vxLaplacianPyramidNode(vx_graph graph, vx_image image, vx_pyramid pyr
     vx_image upscale = vxCreateVirtualImage(graph, width_level1, height_level1, VX_DF_IMAGE_U8);
     vx_image smoothed = vxCreateVirtualImage(graph, width_level1, height_level1, VX_DF_IMAGE_U8);
 
-    vxScaleImageNode(graph, level2, upscale, VX_INTERPOLATION_NEAREST_NEIGHBOR);
-    vxGaussian3x3Node(graph, upscale, smoothed);
+    addNodeToPerfReport(report, "stitch", vxScaleImageNode(graph, level2, upscale, VX_INTERPOLATION_NEAREST_NEIGHBOR));
+    addNodeToPerfReport(report, "stitch", vxGaussian3x3Node(graph, upscale, smoothed));
 
     vx_image laplacian_level = vxGetPyramidLevel(pyr_image, i);
-    vxSubtractNode(graph, level1, smoothed, VX_CONVERT_POLICY_SATURATE, laplacian_level);
+    addNodeToPerfReport(report, "stitch", vxSubtractNode(graph, level1, smoothed, VX_CONVERT_POLICY_SATURATE, laplacian_level));
 
     vxReleaseImage(&level1);
     vxReleaseImage(&level2);
@@ -82,14 +83,14 @@ vx_status _vxLaplacianPyramidNode(vx_graph graph, vx_image image, vx_pyramid pyr
     vxReleaseImage(&laplacian_level);
   }
 
-  vxHalfScaleGaussianNode(graph, vxGetPyramidLevel(pyr_gauss, level_num - 1), output, 5);
+  addNodeToPerfReport(report, "stitch", vxHalfScaleGaussianNode(graph, vxGetPyramidLevel(pyr_gauss, level_num - 1), output, 5));
 
   vxReleasePyramid(&pyr_gauss);
 
   return VX_SUCCESS;
 }
 
-vx_status _vxLaplacianReconstructNode(vx_graph graph, vx_pyramid pyr_image, vx_image input, vx_image output)
+vx_status _vxLaplacianReconstructNode(vx_graph graph, vx_pyramid pyr_image, vx_image input, vx_image output, struct node_perf_report *report)
 {
   vx_context context = vxGetContext((vx_reference)graph);
 
@@ -115,15 +116,15 @@ vx_status _vxLaplacianReconstructNode(vx_graph graph, vx_pyramid pyr_image, vx_i
     // upsample the current level
     vx_image upscale = vxCreateVirtualImage(graph, 2*width_level2, 2*height_level2, VX_DF_IMAGE_U8);
     vx_image smoothed = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_U8);
-    vxScaleImageNode(graph, level2, upscale, VX_INTERPOLATION_NEAREST_NEIGHBOR);
-    vxGaussian3x3Node(graph, upscale, smoothed);
+    addNodeToPerfReport(report, "stitch", vxScaleImageNode(graph, level2, upscale, VX_INTERPOLATION_NEAREST_NEIGHBOR));
+    addNodeToPerfReport(report, "stitch", vxGaussian3x3Node(graph, upscale, smoothed));
 
     // add it with the next level
     vx_image _sum = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_S16);
-    vxAddNode(graph, smoothed, level1, VX_CONVERT_POLICY_SATURATE, _sum);
+    addNodeToPerfReport(report, "stitch", vxAddNode(graph, smoothed, level1, VX_CONVERT_POLICY_SATURATE, _sum));
 
     sum[i] = vxCreateVirtualImage(graph, 2*width_level2, 2*height_level2, VX_DF_IMAGE_U8);
-    vxConvertDepthNode(graph, _sum, i > 0 ? sum[i] : output, VX_CONVERT_POLICY_SATURATE, shift);
+    addNodeToPerfReport(report, "stitch", vxConvertDepthNode(graph, _sum, i > 0 ? sum[i] : output, VX_CONVERT_POLICY_SATURATE, shift));
 
     vxReleaseImage(&upscale);
     vxReleaseImage(&smoothed);
@@ -142,7 +143,7 @@ vx_status _vxLaplacianReconstructNode(vx_graph graph, vx_pyramid pyr_image, vx_i
 }
 
 void createBlendingWeightImages(vx_graph graph, vx_image coeffs1, vx_image coeffs2,
-  int pyr_levels, vx_image* pyr_coeff_levels1, vx_image* pyr_coeff_levels2)
+  int pyr_levels, vx_image* pyr_coeff_levels1, vx_image* pyr_coeff_levels2, struct node_perf_report *report)
 {
   vx_context context = vxGetContext((vx_reference)graph);
 
@@ -177,24 +178,24 @@ void createBlendingWeightImages(vx_graph graph, vx_image coeffs1, vx_image coeff
     }
   }
 
-  vxConvertDepthNode(graph, coeffs1, coeff_levels[0][0],
-    VX_CONVERT_POLICY_SATURATE, shift4);
-  vxGaussian3x3Node(graph, coeff_levels[0][0], coeff_levels[2][0]);
+  addNodeToPerfReport(report, "stitch", vxConvertDepthNode(graph, coeffs1, coeff_levels[0][0],
+    VX_CONVERT_POLICY_SATURATE, shift4));
+  addNodeToPerfReport(report, "stitch", vxGaussian3x3Node(graph, coeff_levels[0][0], coeff_levels[2][0]));
 
-  vxConvertDepthNode(graph, coeffs2, coeff_levels[1][0],
-    VX_CONVERT_POLICY_SATURATE, shift4);
-  vxGaussian3x3Node(graph, coeff_levels[1][0], coeff_levels[3][0]);
+  addNodeToPerfReport(report, "stitch", vxConvertDepthNode(graph, coeffs2, coeff_levels[1][0],
+    VX_CONVERT_POLICY_SATURATE, shift4));
+  addNodeToPerfReport(report, "stitch", vxGaussian3x3Node(graph, coeff_levels[1][0], coeff_levels[3][0]));
 
   // building a pyramid and applying smoothing to each level
   for(int j = 1; j < pyr_levels; j++)
   {
-    vxHalfScaleGaussianNode(graph, coeff_levels[0][j - 1],
-      coeff_levels[0][j], 3);
-    vxGaussian3x3Node(graph, coeff_levels[0][j], coeff_levels[2][j]);
+    addNodeToPerfReport(report, "stitch", vxHalfScaleGaussianNode(graph, coeff_levels[0][j - 1],
+      coeff_levels[0][j], 3));
+    addNodeToPerfReport(report, "stitch", vxGaussian3x3Node(graph, coeff_levels[0][j], coeff_levels[2][j]));
 
-    vxHalfScaleGaussianNode(graph, coeff_levels[1][j - 1],
-      coeff_levels[1][j], 3);
-    vxGaussian3x3Node(graph, coeff_levels[1][j], coeff_levels[3][j]);
+    addNodeToPerfReport(report, "stitch", vxHalfScaleGaussianNode(graph, coeff_levels[1][j - 1],
+      coeff_levels[1][j], 3));
+    addNodeToPerfReport(report, "stitch", vxGaussian3x3Node(graph, coeff_levels[1][j], coeff_levels[3][j]));
   }
 
   // prepare a lookup table
@@ -225,21 +226,21 @@ void createBlendingWeightImages(vx_graph graph, vx_image coeffs1, vx_image coeff
   // summing up weights and building a normalization image
   for(int j = 0; j < pyr_levels; j++)
   {
-    vxAddNode(graph, coeff_levels[2][j], coeff_levels[3][j],
-      VX_CONVERT_POLICY_SATURATE, coeff_levels_s16[0][j]);
+    addNodeToPerfReport(report, "stitch", vxAddNode(graph, coeff_levels[2][j], coeff_levels[3][j],
+      VX_CONVERT_POLICY_SATURATE, coeff_levels_s16[0][j]));
 
-    vxTableLookupNode(graph, coeff_levels_s16[0][j], lut,
-      coeff_levels_s16[1][j]);
+    addNodeToPerfReport(report, "stitch", vxTableLookupNode(graph, coeff_levels_s16[0][j], lut,
+      coeff_levels_s16[1][j]));
 
-    vxMultiplyNode(graph, coeff_levels[2][j], coeff_levels_s16[1][j], scale,
-      VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_ZERO, coeff_levels_s16[2][j]);
-    vxConvertDepthNode(graph, coeff_levels_s16[2][j], pyr_coeff_levels1[j],
-      VX_CONVERT_POLICY_SATURATE, shift0);
+    addNodeToPerfReport(report, "stitch", vxMultiplyNode(graph, coeff_levels[2][j], coeff_levels_s16[1][j], scale,
+      VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_ZERO, coeff_levels_s16[2][j]));
+    addNodeToPerfReport(report, "stitch", vxConvertDepthNode(graph, coeff_levels_s16[2][j], pyr_coeff_levels1[j],
+      VX_CONVERT_POLICY_SATURATE, shift0));
 
-    vxMultiplyNode(graph, coeff_levels[3][j], coeff_levels_s16[1][j], scale,
-      VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_ZERO, coeff_levels_s16[3][j]);
-    vxConvertDepthNode(graph, coeff_levels_s16[3][j], pyr_coeff_levels2[j],
-      VX_CONVERT_POLICY_SATURATE, shift0);
+    addNodeToPerfReport(report, "stitch", vxMultiplyNode(graph, coeff_levels[3][j], coeff_levels_s16[1][j], scale,
+      VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_ZERO, coeff_levels_s16[3][j]));
+    addNodeToPerfReport(report, "stitch", vxConvertDepthNode(graph, coeff_levels_s16[3][j], pyr_coeff_levels2[j],
+      VX_CONVERT_POLICY_SATURATE, shift0));
 
   }
 
@@ -250,7 +251,7 @@ void createBlendingWeightImages(vx_graph graph, vx_image coeffs1, vx_image coeff
 
 vx_graph makeGraph(vx_context context, vx_image image1, vx_image image2,
   vx_remap remap1, vx_image coeffs1, vx_remap remap2, vx_image coeffs2,
-  int pyr_levels, vx_image output)
+  int pyr_levels, vx_image output, struct node_perf_report *report)
 {
     /* Create virtual images */
     const int numu8 = 8;
@@ -334,24 +335,24 @@ vx_graph makeGraph(vx_context context, vx_image image1, vx_image image2,
     }
 
     createBlendingWeightImages(graph, coeffs1, coeffs2, pyr_levels,
-      pyr_coeff_levels1, pyr_coeff_levels2);
+      pyr_coeff_levels1, pyr_coeff_levels2, report);
 
     for(i = 0; i < 3; i++)
     {
       /* First, extract input and logo R, G, and B channels to individual
       virtual images */
-      vxChannelExtractNode(graph, image1, channels[i], virtu8[0][i]);
-      vxChannelExtractNode(graph, image2, channels[i], virtu8[1][i]);
+      addNodeToPerfReport(report, "stitch", vxChannelExtractNode(graph, image1, channels[i], virtu8[0][i]));
+      addNodeToPerfReport(report, "stitch", vxChannelExtractNode(graph, image2, channels[i], virtu8[1][i]));
 
       /* Add remap nodes */
-      vxRemapNode(graph, virtu8[0][i], remap1, VX_INTERPOLATION_BILINEAR,
-        virtu8[2][i]);
-      vxRemapNode(graph, virtu8[1][i], remap2, VX_INTERPOLATION_BILINEAR,
-        virtu8[3][i]);
+      addNodeToPerfReport(report, "stitch", vxRemapNode(graph, virtu8[0][i], remap1, VX_INTERPOLATION_BILINEAR,
+        virtu8[2][i]));
+      addNodeToPerfReport(report, "stitch", vxRemapNode(graph, virtu8[1][i], remap2, VX_INTERPOLATION_BILINEAR,
+        virtu8[3][i]));
 
       // compute laplacian pyramid for each image channel
-      _vxLaplacianPyramidNode(graph, virtu8[2][i], pyr_image1[i], virtu8[4][i]);
-      _vxLaplacianPyramidNode(graph, virtu8[3][i], pyr_image2[i], virtu8[5][i]);
+      _vxLaplacianPyramidNode(graph, virtu8[2][i], pyr_image1[i], virtu8[4][i], report);
+      _vxLaplacianPyramidNode(graph, virtu8[3][i], pyr_image2[i], virtu8[5][i], report);
 
       for(int j = 0; j < pyr_levels - 1; j++)
       {
@@ -360,37 +361,37 @@ vx_graph makeGraph(vx_context context, vx_image image1, vx_image image2,
         pyr_img_levels[2][j][i] = vxGetPyramidLevel(pyr_output[i], j);
 
         // add multiply nodes
-        vxMultiplyNode(graph, pyr_img_levels[0][j][i], pyr_coeff_levels1[j],
+        addNodeToPerfReport(report, "stitch", vxMultiplyNode(graph, pyr_img_levels[0][j][i], pyr_coeff_levels1[j],
           scale, VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_NEAREST_EVEN,
-          virts16[0][j][i]);
-        vxMultiplyNode(graph, pyr_img_levels[1][j][i], pyr_coeff_levels2[j],
+          virts16[0][j][i]));
+        addNodeToPerfReport(report, "stitch", vxMultiplyNode(graph, pyr_img_levels[1][j][i], pyr_coeff_levels2[j],
           scale, VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_NEAREST_EVEN,
-          virts16[1][j][i]);
-        vxAddNode(graph, virts16[0][j][i], virts16[1][j][i],
-          VX_CONVERT_POLICY_SATURATE, pyr_img_levels[2][j][i]);
+          virts16[1][j][i]));
+        addNodeToPerfReport(report, "stitch", vxAddNode(graph, virts16[0][j][i], virts16[1][j][i],
+          VX_CONVERT_POLICY_SATURATE, pyr_img_levels[2][j][i]));
       }
 
       // add multiply nodes for the last pyramid levels
-      vxMultiplyNode(graph, virtu8[4][i], pyr_coeff_levels1[pyr_levels - 1],
+      addNodeToPerfReport(report, "stitch", vxMultiplyNode(graph, virtu8[4][i], pyr_coeff_levels1[pyr_levels - 1],
         scale, VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_NEAREST_EVEN,
-        virts16[2][pyr_levels - 1][i]);
-      vxMultiplyNode(graph, virtu8[5][i], pyr_coeff_levels2[pyr_levels - 1],
+        virts16[2][pyr_levels - 1][i]));
+      addNodeToPerfReport(report, "stitch", vxMultiplyNode(graph, virtu8[5][i], pyr_coeff_levels2[pyr_levels - 1],
         scale, VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_NEAREST_EVEN,
-        virts16[3][pyr_levels - 1][i]);
-      vxAddNode(graph, virts16[2][pyr_levels - 1][i],
+        virts16[3][pyr_levels - 1][i]));
+      addNodeToPerfReport(report, "stitch", vxAddNode(graph, virts16[2][pyr_levels - 1][i],
         virts16[3][pyr_levels - 1][i], VX_CONVERT_POLICY_SATURATE,
-        virts16[4][pyr_levels - 1][i]);
+        virts16[4][pyr_levels - 1][i]));
 
       // convert from S16 to U8
-      vxConvertDepthNode(graph, virts16[4][pyr_levels - 1][i], virtu8[6][i],
-        VX_CONVERT_POLICY_SATURATE, shift);
+      addNodeToPerfReport(report, "stitch", vxConvertDepthNode(graph, virts16[4][pyr_levels - 1][i], virtu8[6][i],
+        VX_CONVERT_POLICY_SATURATE, shift));
 
       _vxLaplacianReconstructNode(graph, pyr_output[i], virtu8[6][i],
-        virtu8[7][i]);
+        virtu8[7][i], report);
     }
 
-      vxChannelCombineNode(graph, virtu8[7][0], virtu8[7][1], virtu8[7][2],
-      NULL, output);
+      addNodeToPerfReport(report, "stitch", vxChannelCombineNode(graph, virtu8[7][0], virtu8[7][1], virtu8[7][2],
+      NULL, output));
 
     for (i = 0; i < numu8; i++)
       for(j = 0; j < 3; j++)
@@ -490,8 +491,9 @@ int main(int argc, char **argv)
 
     /* Create a graph */
     vx_status status;
+    struct node_perf_report *report = createNodePerfReport(context);
     vx_graph graph = makeGraph(context, image1, image2,
-      remap1, coeffs1, remap2, coeffs2, pyr_levels, output);
+      remap1, coeffs1, remap2, coeffs2, pyr_levels, output, report);
 /*
     vx_uint32 num_nodes;
     vxQueryGraph(graph, VX_GRAPH_NUMNODES, &num_nodes, sizeof(num_nodes));
@@ -509,5 +511,8 @@ int main(int argc, char **argv)
     else if (vxa_write_image(output, output_filename) != 1)
         printf("Problem writing the output image\n");
 
+    sampleNodePerfReport(report);
+    printNodePerfReport(report);
+    releaseNodePerfReport(&report);
     vxReleaseContext(&context);
 }
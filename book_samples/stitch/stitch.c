@@ -33,10 +33,11 @@
 #include <stdlib.h>
 #include <VX/vx.h>
 #include "vxa/vxa.h"
+#include "nodePerf.h"
 
 vx_graph makeFilterGraph(vx_context context, vx_image image1, vx_image image2,
   vx_remap remap1, vx_image coeffs1, vx_remap remap2, vx_image coeffs2,
-  vx_image output)
+  vx_image output, struct node_perf_report *report)
 {
     /* Create virtual images */
     const int numu8 = 5;
@@ -72,33 +73,33 @@ vx_graph makeFilterGraph(vx_context context, vx_image image1, vx_image image2,
     {
       /* First, extract input and logo R, G, and B channels to individual
       virtual images */
-      vxChannelExtractNode(graph, image1, channels[i], virtu8[0][i]);
-      vxChannelExtractNode(graph, image2, channels[i], virtu8[1][i]);
+      addNodeToPerfReport(report, "stitch", vxChannelExtractNode(graph, image1, channels[i], virtu8[0][i]));
+      addNodeToPerfReport(report, "stitch", vxChannelExtractNode(graph, image2, channels[i], virtu8[1][i]));
 
       /* Add remap nodes */
-      vxRemapNode(graph, virtu8[0][i], remap1, VX_INTERPOLATION_BILINEAR,
-        virtu8[3][i]);
-      vxRemapNode(graph, virtu8[1][i], remap2, VX_INTERPOLATION_BILINEAR,
-        virtu8[4][i]);
+      addNodeToPerfReport(report, "stitch", vxRemapNode(graph, virtu8[0][i], remap1, VX_INTERPOLATION_BILINEAR,
+        virtu8[3][i]));
+      addNodeToPerfReport(report, "stitch", vxRemapNode(graph, virtu8[1][i], remap2, VX_INTERPOLATION_BILINEAR,
+        virtu8[4][i]));
 
       /* add multiply nodes */
-      vxMultiplyNode(graph, virtu8[3][i], coeffs1, scale,
+      addNodeToPerfReport(report, "stitch", vxMultiplyNode(graph, virtu8[3][i], coeffs1, scale,
         VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_NEAREST_EVEN,
-        virts16[0][i]);
-      vxMultiplyNode(graph, virtu8[4][i], coeffs2, scale,
+        virts16[0][i]));
+      addNodeToPerfReport(report, "stitch", vxMultiplyNode(graph, virtu8[4][i], coeffs2, scale,
         VX_CONVERT_POLICY_SATURATE, VX_ROUND_POLICY_TO_NEAREST_EVEN,
-        virts16[1][i]);
+        virts16[1][i]));
 
-      vxAddNode(graph, virts16[0][i], virts16[1][i], VX_CONVERT_POLICY_SATURATE,
-        virts16[2][i]);
+      addNodeToPerfReport(report, "stitch", vxAddNode(graph, virts16[0][i], virts16[1][i], VX_CONVERT_POLICY_SATURATE,
+        virts16[2][i]));
 
       /* convert from S16 to U8 */
-      vxConvertDepthNode(graph, virts16[2][i], virtu8[2][i],
-        VX_CONVERT_POLICY_SATURATE, shift);
+      addNodeToPerfReport(report, "stitch", vxConvertDepthNode(graph, virts16[2][i], virtu8[2][i],
+        VX_CONVERT_POLICY_SATURATE, shift));
     }
 
-    vxChannelCombineNode(graph, virtu8[2][0], virtu8[2][1], virtu8[2][2],
-      NULL, output);
+    addNodeToPerfReport(report, "stitch", vxChannelCombineNode(graph, virtu8[2][0], virtu8[2][1], virtu8[2][2],
+      NULL, output));
 
     for (i = 0; i < numu8; i++)
       for(j = 0; j < 3; j++)
@@ -180,8 +181,9 @@ int main(int argc, char **argv)
 
     /* Create a graph */
     vx_status status;
+    struct node_perf_report *report = createNodePerfReport(context);
     vx_graph graph = makeFilterGraph(context, image1, image2,
-      remap1, coeffs1, remap2, coeffs2, output);
+      remap1, coeffs1, remap2, coeffs2, output, report);
 
     vxRegisterLogCallback(context, log_callback, vx_true_e);
 
@@ -194,5 +196,8 @@ int main(int argc, char **argv)
         printf("Error processing graph\n");
     else if (vxa_write_image(output, output_filename) != 1)
         printf("Problem writing the output image\n");
+    sampleNodePerfReport(report);
+    printNodePerfReport(report);
+    releaseNodePerfReport(&report);
     vxReleaseContext(&context);
 }
@@ -36,14 +36,17 @@
 #define END_X 720
 #define END_Y 250
 #include "centroid_tracking.h"
+#include "nodePerf.h"
 #include <opencv2/opencv.hpp>
 #include <stdio.h>
 #include <string>
 
 /*
 Demonstration app for the tracking example
+Usage: tracking_example [<node-report.csv|node-report.json>]
+The time taken by each node is printed at the end, and written to the report file if one is given.
 Building requires something like:
-g++ tracking_example.cpp centroid_tracking.c -lopenvx -lm -I ~/openvx/api-docs/include/ -I /usr/local/include/opencv4 -lopencv_core -lopencv_videoio -lopencv_imgproc -lopencv_highgui
+g++ tracking_example.cpp centroid_tracking.c ../node-perf/nodePerf.c -I ../node-perf -lopenvx -lm -I ~/openvx/api-docs/include/ -I /usr/local/include/opencv4 -lopencv_core -lopencv_videoio -lopencv_imgproc -lopencv_highgui
 
 */ 
 void VX_CALLBACK log_callback( vx_context    context,
@@ -63,7 +66,8 @@ vx_graph initial_feature_detection_graph(
     vx_array output_data, 
     vx_array output_corners,
     vx_array original_corners,
-    vx_scalar valid)
+    vx_scalar valid,
+    struct node_perf_report *report)
 {
     /* 
     Create the graph that performs the initial feature detection, given the bounding box.
@@ -85,13 +89,13 @@ vx_graph initial_feature_detection_graph(
     ERROR_CHECK_OBJECT(strength_thresh)
     vx_array first_corners = vxCreateVirtualArray(graph, VX_TYPE_KEYPOINT, NUM_KEYPOINTS);
     ERROR_CHECK_OBJECT(first_corners)
-    ERROR_CHECK_OBJECT(vxColorConvertNode(graph, initial_image, yuv_image))
-    ERROR_CHECK_OBJECT(vxChannelExtractNode(graph, yuv_image, VX_CHANNEL_Y, y_image))
-    ERROR_CHECK_OBJECT(clearOutsideBoundsNode(graph, y_image, bounds, roi))
-    ERROR_CHECK_OBJECT(vxGaussianPyramidNode(graph, y_image, initial_pyramid))
-    ERROR_CHECK_OBJECT(vxFastCornersNode(graph, roi, strength_thresh, vx_true_e, first_corners, NULL))
-    ERROR_CHECK_OBJECT(intialCentroidCalculationNode(graph, bounds, first_corners, output_data, output_corners, valid))
-    ERROR_CHECK_OBJECT(vxCopyNode(graph, (vx_reference)output_corners, (vx_reference)original_corners))
+    ERROR_CHECK_OBJECT(addNodeToPerfReport(report, "initial", vxColorConvertNode(graph, initial_image, yuv_image)))
+    ERROR_CHECK_OBJECT(addNodeToPerfReport(report, "initial", vxChannelExtractNode(graph, yuv_image, VX_CHANNEL_Y, y_image)))
+    ERROR_CHECK_OBJECT(addNodeToPerfReport(report, "initial", clearOutsideBoundsNode(graph, y_image, bounds, roi)))
+    ERROR_CHECK_OBJECT(addNodeToPerfReport(report, "initial", vxGaussianPyramidNode(graph, y_image, initial_pyramid)))
+    ERROR_CHECK_OBJECT(addNodeToPerfReport(report, "initial", vxFastCornersNode(graph, roi, strength_thresh, vx_true_e, first_corners, NULL)))
+    ERROR_CHECK_OBJECT(addNodeToPerfReport(report, "initial", intialCentroidCalculationNode(graph, bounds, first_corners, output_data, output_corners, valid)))
+    ERROR_CHECK_OBJECT(addNodeToPerfReport(report, "initial", vxCopyNode(graph, (vx_reference)output_corners, (vx_reference)original_corners)))
     ERROR_CHECK_STATUS(vxReleaseImage(&yuv_image))
     ERROR_CHECK_STATUS(vxReleaseImage(&y_image))
     ERROR_CHECK_STATUS(vxReleaseImage(&roi))
@@ -104,7 +108,7 @@ vx_graph initial_feature_detection_graph(
 vx_graph centroid_tracking_graph(
     vx_context context, vx_image input_image, vx_array original_corners,
     vx_delay images, vx_delay tracking_data, vx_delay corners,
-    vx_scalar valid)
+    vx_scalar valid, struct node_perf_report *report)
 {
     /*
     Extract intensity from the RGB input
@@ -147,13 +151,13 @@ vx_graph centroid_tracking_graph(
     vx_enum array_type;
     ERROR_CHECK_STATUS(vxQueryArray(current_data, VX_ARRAY_ITEMTYPE, &array_type, sizeof(array_type)))
 
-    ERROR_CHECK_OBJECT(vxColorConvertNode(graph, input_image, yuv_image))
-    ERROR_CHECK_OBJECT(vxChannelExtractNode(graph, yuv_image, VX_CHANNEL_Y, y_image))
-    ERROR_CHECK_OBJECT(vxGaussianPyramidNode(graph, y_image, current_pyramid))
-    ERROR_CHECK_OBJECT(vxOpticalFlowPyrLKNode(graph, previous_pyramid, current_pyramid, 
+    ERROR_CHECK_OBJECT(addNodeToPerfReport(report, "tracking", vxColorConvertNode(graph, input_image, yuv_image)))
+    ERROR_CHECK_OBJECT(addNodeToPerfReport(report, "tracking", vxChannelExtractNode(graph, yuv_image, VX_CHANNEL_Y, y_image)))
+    ERROR_CHECK_OBJECT(addNodeToPerfReport(report, "tracking", vxGaussianPyramidNode(graph, y_image, current_pyramid)))
+    ERROR_CHECK_OBJECT(addNodeToPerfReport(report, "tracking", vxOpticalFlowPyrLKNode(graph, previous_pyramid, current_pyramid, 
                                             previous_corners, previous_corners, unfiltered_keypoints,
                                             lk_termination, epsilon, num_iterations,
-                                            use_initial_estimate, lk_window_dimension ))
+                                            use_initial_estimate, lk_window_dimension )))
     vxAddLogEntry((vx_reference)context, VX_FAILURE, "About to insert user node");
     printf("tracking_data_delay[0] holds items type %d\n", array_type);
     ERROR_CHECK_STATUS(vxQueryArray(previous_data, VX_ARRAY_ITEMTYPE, &array_type, sizeof(array_type)))
@@ -162,7 +166,7 @@ vx_graph centroid_tracking_graph(
     printf("corners_delay[0] holds items type %d\n", array_type);
     ERROR_CHECK_STATUS(vxQueryArray(previous_corners, VX_ARRAY_ITEMTYPE, &array_type, sizeof(array_type)))
     printf("corners_delay[-1] holds items type %d\n", array_type);
-    ERROR_CHECK_OBJECT(trackCentroidsNode(graph, original_corners, previous_data, unfiltered_keypoints, current_data, current_corners, valid))
+    ERROR_CHECK_OBJECT(addNodeToPerfReport(report, "tracking", trackCentroidsNode(graph, original_corners, previous_data, unfiltered_keypoints, current_data, current_corners, valid)))
     vxAddLogEntry((vx_reference)context, VX_FAILURE, "about to release some objects");
     ERROR_CHECK_STATUS(vxReleaseScalar(&epsilon))
     ERROR_CHECK_STATUS(vxReleaseScalar(&num_iterations))
@@ -253,6 +257,7 @@ int main(int argc, const char ** argv)
     vx_float32 lk_pyramid_scale        = VX_SCALE_PYRAMID_HALF; // pyramid levels scale by factor of two
     ERROR_CHECK_OBJECT(context)
     ERROR_CHECK_STATUS(registerCentroidNodes(context))
+    struct node_perf_report *report = createNodePerfReport(context);
     vx_image frame = vxCreateImage(context, width, height, VX_DF_IMAGE_RGB);
     ERROR_CHECK_OBJECT(frame)
     vx_rectangle_t bounding_box;
@@ -283,16 +288,17 @@ int main(int argc, const char ** argv)
     bounding_box.end_x = END_X;
     /* create & verify the graphs */
     vx_graph initial_graph = initial_feature_detection_graph(context, &bounding_box, frame, (vx_pyramid)vxGetReferenceFromDelay(pyramid_delay, 0),
-        (vx_array)vxGetReferenceFromDelay(tracking_data_delay, 0), (vx_array)vxGetReferenceFromDelay(corners_delay, 0), corners, valid_scalar);
+        (vx_array)vxGetReferenceFromDelay(tracking_data_delay, 0), (vx_array)vxGetReferenceFromDelay(corners_delay, 0), corners, valid_scalar, report);
     ERROR_CHECK_STATUS(vxVerifyGraph(initial_graph))
 	vxAddLogEntry((vx_reference)context, VX_FAILURE, "Verified first graph");
-    vx_graph tracking_graph = centroid_tracking_graph(context, frame, corners, pyramid_delay, tracking_data_delay, corners_delay, valid_scalar);
+    vx_graph tracking_graph = centroid_tracking_graph(context, frame, corners, pyramid_delay, tracking_data_delay, corners_delay, valid_scalar, report);
 	vxAddLogEntry((vx_reference)context, VX_FAILURE, "Created second graph");
     ERROR_CHECK_STATUS(vxVerifyGraph(tracking_graph))
 	vxAddLogEntry((vx_reference)context, VX_FAILURE, "Verified second graph");
     copy_cv_to_vx(m_imgRGB, frame);
     /* Here we get the initial data for the tracking by running our initial feature detection graph */
     ERROR_CHECK_STATUS(vxProcessGraph(initial_graph))
+    sampleNodePerfReport(report);
 	vxAddLogEntry((vx_reference)context, VX_FAILURE, "Processed first graph");
     char key = 0;
     for( int frame_index = 0; key != 'q' && key != 'Q' && key != 27; frame_index++ )
@@ -340,6 +346,7 @@ int main(int argc, const char ** argv)
                 ERROR_CHECK_STATUS(vxAgeDelay(corners_delay))
                 copy_cv_to_vx(m_imgRGB, frame);
                 ERROR_CHECK_STATUS(vxProcessGraph(tracking_graph))
+                sampleNodePerfReport(report);
             }
             key = cv::waitKey( 1 );
             if ( ' '==key )
@@ -349,6 +356,10 @@ int main(int argc, const char ** argv)
         }
         
     }
+    printNodePerfReport(report);
+    if (argc > 1 && VX_SUCCESS != writeNodePerfReport(report, argv[1]))
+        printf("ERROR: unable to write node report to %s\n", argv[1]);
+    releaseNodePerfReport(&report);
     // This will release the context and all the resources in it
     ERROR_CHECK_STATUS(vxReleaseContext(&context));
 }
@@ -33,9 +33,10 @@
 #include <stdlib.h>
 #include <VX/vx.h>
 #include "vxa/vxa.h"
+#include "nodePerf.h"
 
 vx_graph makeRemapGraph(vx_context context, vx_image input_image,
-  vx_remap remap, vx_image output_image)
+  vx_remap remap, vx_image output_image, struct node_perf_report *report)
 {
     /* Create virtual images */
     const int numu8 = 2;
@@ -55,15 +56,15 @@ vx_graph makeRemapGraph(vx_context context, vx_image input_image,
     {
       /* First, extract input and logo R, G, and B channels to individual
       virtual images */
-      vxChannelExtractNode(graph, input_image, channels[i], virtu8[0][i]);
+      addNodeToPerfReport(report, "undistort", vxChannelExtractNode(graph, input_image, channels[i], virtu8[0][i]));
 
       /* Add remap nodes */
-      vxRemapNode(graph, virtu8[0][i], remap, VX_INTERPOLATION_BILINEAR,
-        virtu8[1][i]);
+      addNodeToPerfReport(report, "undistort", vxRemapNode(graph, virtu8[0][i], remap, VX_INTERPOLATION_BILINEAR,
+        virtu8[1][i]));
     }
 
-    vxChannelCombineNode(graph, virtu8[1][0], virtu8[1][1], virtu8[1][2],
-      NULL, output_image);
+    addNodeToPerfReport(report, "undistort", vxChannelCombineNode(graph, virtu8[1][0], virtu8[1][1], virtu8[1][2],
+      NULL, output_image));
 
     for (i = 0; i < numu8; i++)
       for(j = 0; j < 3; j++)
@@ -114,8 +115,9 @@ int main(int argc, char **argv)
 
     /* Create a graph */
     vx_status status;
+    struct node_perf_report *report = createNodePerfReport(context);
     vx_graph graph = makeRemapGraph(context, input_image,
-      remap, output_image);
+      remap, output_image, report);
 
     vxRegisterLogCallback(context, log_callback, vx_true_e);
 
@@ -128,5 +130,8 @@ int main(int argc, char **argv)
         printf("Error processing graph\n");
     else if (vxa_write_image(output_image, output_filename) != 1)
         printf("Problem writing the output image\n");
+    sampleNodePerfReport(report);
+    printNodePerfReport(report);
+    releaseNodePerfReport(&report);
     vxReleaseContext(&context);
 }
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+/*!
+ * \file    elementwise_chain.cpp
+ * \example elementwise_chain
+ * \brief   Runs the same chain of element-wise tensor operations
+ *          (cos, scale/offset, clamp) as one node per operation and as a
+ *          single fused node built with elementwise_kernel.h, and compares
+ *          their execution times and outputs. The cosine node is then
+ *          timed alone on batches of tensors.
+ */
+
+#include "elementwise_kernel.h"
+#include "nodePerf.h"
+
+#include <VX/vx.h>
+#include <vx_ext_amd.h>
+#include <chrono>
+#include <string>
+#include <stdlib.h>
+
+////////
+// Useful macros for OpenVX error checking:
+//   ERROR_CHECK_STATUS     - check whether the status is VX_SUCCESS
+#define ERROR_CHECK_STATUS( status ) { \
+        vx_status status_ = (status); \
+        if(status_ != VX_SUCCESS) { \
+            printf("ERROR: failed with status = (%d) at " __FILE__ "#%d\n", status_, __LINE__); \
+            exit(1); \
+        } \
+    }
+
+//   ERROR_CHECK_OBJECT     - check whether the object creation is successful
+#define ERROR_CHECK_OBJECT( obj ) { \
+        vx_status status_ = vxGetStatus((vx_reference)(obj)); \
+        if(status_ != VX_SUCCESS) { \
+            printf("ERROR: failed with status = (%d) at " __FILE__ "#%d\n", status_, __LINE__); \
+            exit(1); \
+        } \
+    }
+
+////////
+// One kernel per operation for the unfused graph, and one for the whole chain
+enum user_library_e
+{
+    USER_LIBRARY_EXAMPLE        = 1,
+};
+enum user_kernel_e
+{
+    USER_KERNEL_COS            = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x001,
+    USER_KERNEL_SCALE_OFFSET   = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x002,
+    USER_KERNEL_CLAMP          = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x003,
+    USER_KERNEL_FUSED          = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x004,
+};
+
+typedef CElementwiseKernel< ElementwiseCos >                                            CosKernel;
+typedef CElementwiseKernel< ElementwiseScaleOffset >                                    ScaleOffsetKernel;
+typedef CElementwiseKernel< ElementwiseClamp >                                          ClampKernel;
+typedef CElementwiseKernel< ElementwiseCos, ElementwiseScaleOffset, ElementwiseClamp > FusedKernel;
+
+////////
+// Run graph num_iterations times and return the average time in milliseconds;
+// the time of each node is sampled into report on every iteration
+double timeGraph( vx_graph graph, int num_iterations, struct node_perf_report * report )
+{
+    ERROR_CHECK_STATUS( vxProcessGraph( graph ) ); // warm-up
+    std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < num_iterations; i++ )
+    {
+        ERROR_CHECK_STATUS( vxProcessGraph( graph ) );
+        sampleNodePerfReport( report );
+    }
+    std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>( t1 - t0 ).count() / num_iterations;
+}
+
+////////
+// Time the cosine node alone on batches of 3-dimensional items, stacked
+// along the 4th dimension, and print the throughput for each batch size
+void benchmarkCosBatches( vx_context context, int num_iterations, struct node_perf_report * report )
+{
+    vx_size item_dims[3]  = { 56, 56, 64 };
+    vx_size batch_sizes[] = { 1, 8, 16, 32, 64 };
+    ElementwiseCos cos_op;
+    printf( "Cos batches of %zu x %zu x %zu INT16 items, %d iterations\n",
+            item_dims[2], item_dims[1], item_dims[0], num_iterations );
+    for( vx_size i = 0; i < sizeof( batch_sizes ) / sizeof( batch_sizes[0] ); i++ )
+    {
+        // The tensors are not initialized: the time does not depend on the values
+        vx_size dims[4] = { item_dims[0], item_dims[1], item_dims[2], batch_sizes[i] };
+        vx_tensor input  = vxCreateTensor( context, 4, dims, VX_TYPE_INT16, 5 );
+        vx_tensor output = vxCreateTensor( context, 4, dims, VX_TYPE_INT16, 7 );
+        vx_graph  graph  = vxCreateGraph( context );
+        ERROR_CHECK_OBJECT( input );
+        ERROR_CHECK_OBJECT( output );
+        ERROR_CHECK_OBJECT( graph );
+        char graph_name[32];
+        sprintf( graph_name, "cos batch %d", ( int )batch_sizes[i] );
+        vx_node node = addNodeToPerfReport( report, graph_name, CosKernel::CreateNode( graph, input, output, cos_op ) );
+        ERROR_CHECK_OBJECT( node );
+        ERROR_CHECK_STATUS( vxReleaseNode( &node ) );
+        ERROR_CHECK_STATUS( vxVerifyGraph( graph ) );
+        double ms = timeGraph( graph, num_iterations, report );
+        printf( "  batch %3d %9.3f ms/batch %10.1f items/s\n", ( int )batch_sizes[i], ms, batch_sizes[i] * 1000.0 / ms );
+        ERROR_CHECK_STATUS( vxReleaseGraph( &graph ) );
+        ERROR_CHECK_STATUS( vxReleaseTensor( &input ) );
+        ERROR_CHECK_STATUS( vxReleaseTensor( &output ) );
+    }
+}
+
+////////
+// Largest difference between two INT16 tensors with the given dimensions
+vx_int32 maxDifference( vx_tensor a, vx_tensor b, const vx_size dims[3] )
+{
+    vx_size zeros[3] = { 0 };
+    vx_size stride_a[3], stride_b[3];
+    vx_map_id map_a, map_b;
+    vx_uint8 * buf_a, * buf_b;
+    ERROR_CHECK_STATUS( vxMapTensorPatch( a, 3, zeros, dims, &map_a, stride_a, (void **)&buf_a, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0 ) );
+    ERROR_CHECK_STATUS( vxMapTensorPatch( b, 3, zeros, dims, &map_b, stride_b, (void **)&buf_b, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0 ) );
+    vx_int32 max_difference = 0;
+    for( vx_size c = 0; c < dims[2]; c++ )
+    {
+        for( vx_size y = 0; y < dims[1]; y++ )
+        {
+            const vx_int16 * row_a = (const vx_int16 *)(buf_a + y * stride_a[1] + c * stride_a[2]);
+            const vx_int16 * row_b = (const vx_int16 *)(buf_b + y * stride_b[1] + c * stride_b[2]);
+            for( vx_size x = 0; x < dims[0]; x++ )
+            {
+                max_difference = std::max( max_difference, abs( (vx_int32)row_a[x] - (vx_int32)row_b[x] ) );
+            }
+        }
+    }
+    ERROR_CHECK_STATUS( vxUnmapTensorPatch( a, map_a ) );
+    ERROR_CHECK_STATUS( vxUnmapTensorPatch( b, map_b ) );
+    return max_difference;
+}
+
+////////
+// main() builds and times both graphs, then times the cosine on batches.
+// Command-line usage:
+//   % elementwise_chain [<iterations> [cpu]]
+// The kernels are registered with OpenCL code generation, so the framework
+// may run them on the GPU, unless "cpu" is given.
+int main( int argc, char * argv[] )
+{
+    int  num_iterations = argc > 1 ? atoi( argv[1] ) : 100;
+    bool use_opencl     = !( argc > 2 && std::string( argv[2] ) == "cpu" );
+    if( num_iterations < 1 )
+    {
+        num_iterations = 1;
+    }
+
+    ////////
+    // A 1920x1080 RGB frame in Q10.5, the format of exercise 3. The cosine
+    // is kept in Q3.12 between the unfused nodes, and the output is Q8.7.
+    vx_size  dims[3]                  = { 1920, 1080, 3 };
+    vx_uint8 input_fixed_point_pos    = 5;
+    vx_uint8 internal_fixed_point_pos = 12;
+    vx_uint8 output_fixed_point_pos   = 7;
+    ElementwiseCos         cos_op;
+    ElementwiseScaleOffset scale_offset_op( 0.5f, 0.5f ); // -1..1 to 0..1
+    ElementwiseClamp       clamp_op( 0.1f, 0.9f );
+
+    vx_context context = vxCreateContext();
+    ERROR_CHECK_OBJECT( context );
+    ERROR_CHECK_STATUS( CosKernel::Register( context, USER_KERNEL_COS, use_opencl ) );
+    ERROR_CHECK_STATUS( ScaleOffsetKernel::Register( context, USER_KERNEL_SCALE_OFFSET, use_opencl ) );
+    ERROR_CHECK_STATUS( ClampKernel::Register( context, USER_KERNEL_CLAMP, use_opencl ) );
+    ERROR_CHECK_STATUS( FusedKernel::Register( context, USER_KERNEL_FUSED, use_opencl ) );
+    struct node_perf_report * report = createNodePerfReport( context );
+
+    vx_tensor input_tensor         = vxCreateTensor( context, 3, dims, VX_TYPE_INT16, input_fixed_point_pos );
+    vx_tensor unfused_output       = vxCreateTensor( context, 3, dims, VX_TYPE_INT16, output_fixed_point_pos );
+    vx_tensor fused_output         = vxCreateTensor( context, 3, dims, VX_TYPE_INT16, output_fixed_point_pos );
+    ERROR_CHECK_OBJECT( input_tensor );
+    ERROR_CHECK_OBJECT( unfused_output );
+    ERROR_CHECK_OBJECT( fused_output );
+
+    ////////
+    // Fill the input with the values exercise 3 gets from 8-bit pixels
+    vx_size zeros[3] = { 0 };
+    vx_size stride[3];
+    vx_map_id map_id;
+    vx_uint8 * buf;
+    ERROR_CHECK_STATUS( vxMapTensorPatch( input_tensor, 3, zeros, dims, &map_id, stride, (void **)&buf, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, 0 ) );
+    for( vx_size c = 0; c < dims[2]; c++ )
+    {
+        for( vx_size y = 0; y < dims[1]; y++ )
+        {
+            vx_int16 * row = (vx_int16 *)(buf + y * stride[1] + c * stride[2]);
+            for( vx_size x = 0; x < dims[0]; x++ )
+            {
+                row[x] = (vx_int16)( ( x + 3 * y + 7 * c ) & 255 ) - 128;
+            }
+        }
+    }
+    ERROR_CHECK_STATUS( vxUnmapTensorPatch( input_tensor, map_id ) );
+
+    ////////
+    // One node per operation, with virtual tensors in between
+    vx_graph unfused_graph = vxCreateGraph( context );
+    ERROR_CHECK_OBJECT( unfused_graph );
+    vx_tensor cos_tensor          = vxCreateVirtualTensor( unfused_graph, 3, dims, VX_TYPE_INT16, internal_fixed_point_pos );
+    vx_tensor scale_offset_tensor = vxCreateVirtualTensor( unfused_graph, 3, dims, VX_TYPE_INT16, internal_fixed_point_pos );
+    ERROR_CHECK_OBJECT( cos_tensor );
+    ERROR_CHECK_OBJECT( scale_offset_tensor );
+    vx_node unfused_nodes[] =
+    {
+        addNodeToPerfReport( report, "unfused", CosKernel::CreateNode( unfused_graph, input_tensor, cos_tensor, cos_op ) ),
+        addNodeToPerfReport( report, "unfused", ScaleOffsetKernel::CreateNode( unfused_graph, cos_tensor, scale_offset_tensor, scale_offset_op ) ),
+        addNodeToPerfReport( report, "unfused", ClampKernel::CreateNode( unfused_graph, scale_offset_tensor, unfused_output, clamp_op ) ),
+    };
+    for( vx_size i = 0; i < sizeof( unfused_nodes ) / sizeof( unfused_nodes[0] ); i++ )
+    {
+        ERROR_CHECK_OBJECT( unfused_nodes[i] );
+        ERROR_CHECK_STATUS( vxReleaseNode( &unfused_nodes[i] ) );
+    }
+    ERROR_CHECK_STATUS( vxReleaseTensor( &cos_tensor ) );
+    ERROR_CHECK_STATUS( vxReleaseTensor( &scale_offset_tensor ) );
+    ERROR_CHECK_STATUS( vxVerifyGraph( unfused_graph ) );
+
+    ////////
+    // The same chain fused into one node
+    vx_graph fused_graph = vxCreateGraph( context );
+    ERROR_CHECK_OBJECT( fused_graph );
+    vx_node fused_node = addNodeToPerfReport( report, "fused", FusedKernel::CreateNode( fused_graph, input_tensor, fused_output, cos_op, scale_offset_op, clamp_op ) );
+    ERROR_CHECK_OBJECT( fused_node );
+    ERROR_CHECK_STATUS( vxReleaseNode( &fused_node ) );
+    ERROR_CHECK_STATUS( vxVerifyGraph( fused_graph ) );
+
+    double unfused_ms = timeGraph( unfused_graph, num_iterations, report );
+    double fused_ms   = timeGraph( fused_graph, num_iterations, report );
+    printf( "Chain: %s on %dx%dx%d INT16 tensors, %d iterations%s\n", ElementwiseChain< ElementwiseCos, ElementwiseScaleOffset, ElementwiseClamp >::Name().c_str(),
+            (int)dims[0], (int)dims[1], (int)dims[2], num_iterations, use_opencl ? "" : " on CPU" );
+    printf( "  unfused (3 nodes) %8.3f ms\n", unfused_ms );
+    printf( "  fused   (1 node)  %8.3f ms  (%.2fx)\n", fused_ms, unfused_ms / fused_ms );
+    // The unfused graph rounds the intermediate values to Q3.12, so the outputs
+    // may differ by one in the last place.
+    printf( "  max output difference: %d LSB\n", maxDifference( unfused_output, fused_output, dims ) );
+    benchmarkCosBatches( context, num_iterations, report );
+    printNodePerfReport( report );
+    releaseNodePerfReport( &report );
+
+    ERROR_CHECK_STATUS( vxReleaseGraph( &unfused_graph ) );
+    ERROR_CHECK_STATUS( vxReleaseGraph( &fused_graph ) );
+    ERROR_CHECK_STATUS( vxReleaseTensor( &input_tensor ) );
+    ERROR_CHECK_STATUS( vxReleaseTensor( &unfused_output ) );
+    ERROR_CHECK_STATUS( vxReleaseTensor( &fused_output ) );
+    ERROR_CHECK_STATUS( vxReleaseContext( &context ) );
+
+    return 0;
+}
@@ -34,6 +34,10 @@
 // Include OpenCV wrapper for image capture and display.
 #include "opencv_camera_display.h"
 
+////////
+// Include the per-node performance report (include/nodePerf.h).
+#include "nodePerf.h"
+
 ////////
 // The most important top-level OpenVX header files are "VX/vx.h" and "VX/vxu.h".
 // The "VX/vx.h" includes all headers needed to support functionality of the
@@ -148,6 +152,11 @@ int main( int argc, char * argv[] )
 //    vxRegisterLogCallback( context, log_callback, vx_false_e );
 //    vxAddLogEntry( ( vx_reference ) context, VX_FAILURE, "Hello there!\n" );
 
+    ////////
+    // Collect the time taken by every node of the three graphs below on every frame.
+    // Uncomment once the context is created in STEP 01.
+//    struct node_perf_report * nodeReport = createNodePerfReport( context );
+
 
     ////////
     // Create OpenVX image object for input RGB image.
@@ -220,20 +229,22 @@ int main( int argc, char * argv[] )
 
 
     ////////********
-    // Harris and optical flow algorithms require their own graph objects.
-    // The Harris graph needs to extract gray scale image out of input RGB,
-    // compute an initial set of keypoints, and compute an initial pyramid for use
-    // by the optical flow graph.
+    // The color conversion and the pyramid are the same whether a frame is used for
+    // Harris or for tracking, so they are computed once per frame by a front-end graph.
+    // The Harris and optical flow back-end graphs only consume its outputs: the gray
+    // image and the current pyramid from the pyramid delay object.
     //
     // TODO STEP 06:********
-    //   1. Create two graph objects: one for the Harris corner detector and
-    //      the other for feature tracking using optical flow using the
+    //   1. Create three graph objects: one for the front end, one for the Harris corner
+    //      detector and one for feature tracking using optical flow using the
     //      vxCreateGraph API.
-    //      We gave code for one graph; do similar for the other.
+    //      We gave code for one graph; do similar for the others.
     //   2. Use ERROR_CHECK_OBJECT to check the objects.
-    //      We gave one error check; do similar for the other.
-//    vx_graph graphHarris = vxCreateGraph( context );
+    //      We gave one error check; do similar for the others.
+//    vx_graph graphFront  = vxCreateGraph( context );
+//    vx_graph graphHarris = /* Fill in here */;
 //    vx_graph graphTrack  = /* Fill in here */;
+//    ERROR_CHECK_OBJECT( graphFront );
 //    ERROR_CHECK_OBJECT( graphHarris );
 //    ERROR_CHECK_OBJECT( graphTrack );
 
@@ -243,26 +254,20 @@ int main( int argc, char * argv[] )
     // from RGB image, which requires two steps:
     //   - perform RGB to IYUV color conversion
     //   - extract Y channel from IYUV image
-    // This requires two intermediate OpenVX image objects. Since you don't
-    // need to access these objects from the application, they can be virtual
-    // objects that can be created using the vxCreateVirtualImage API.
+    // The IYUV image is only used inside the front-end graph, so it can be a virtual
+    // object created using the vxCreateVirtualImage API. The gray image is passed
+    // from the front-end graph to the Harris graph, so it has to be a regular image.
     //
     // TODO STEP 07:********
     //   1. Create an IYUV image and a U8 image (for Y channel) with the same
     //      dimensions as the input RGB image. Note that the image formats for
     //      IYUV and U8 images are VX_DF_IMAGE_IYUV and VX_DF_IMAGE_U8.
-    //      Since virtual objects are specific to a graph, you
-    //      need to create two sets, one for each graph.
     //      We gave one fully in comments and you need to fill in missing
-    //      parameters for the others.
-//    vx_image harris_yuv_image       = vxCreateVirtualImage( graphHarris, width, height, VX_DF_IMAGE_IYUV );
-//    vx_image harris_gray_image      = vxCreateVirtualImage( graphHarris, /* Fill in parameters */ );
-//    vx_image opticalflow_yuv_image  = vxCreateVirtualImage( graphTrack,  /* Fill in parameters */ );
-//    vx_image opticalflow_gray_image = vxCreateVirtualImage( /* Fill in parameters */ );
-//    ERROR_CHECK_OBJECT( harris_yuv_image );
-//    ERROR_CHECK_OBJECT( harris_gray_image );
-//    ERROR_CHECK_OBJECT( opticalflow_yuv_image );
-//    ERROR_CHECK_OBJECT( opticalflow_gray_image );
+    //      parameters for the other.
+//    vx_image front_yuv_image = vxCreateVirtualImage( graphFront, width, height, VX_DF_IMAGE_IYUV );
+//    vx_image gray_image      = vxCreateImage( context, /* Fill in parameters */ );
+//    ERROR_CHECK_OBJECT( front_yuv_image );
+//    ERROR_CHECK_OBJECT( gray_image );
 
 
     ////////********
@@ -297,69 +302,74 @@ int main( int argc, char * argv[] )
 
     ////////********
     // Now all the objects have been created for building the graphs.
-    // First, build a graph that performs Harris corner detection and initial pyramid computation.
+    // First, build the front-end graph that computes the gray image and the pyramid
+    // of every frame, then a graph that performs Harris corner detection on it.
     // See "VX/vx_nodes.h" for APIs how to add nodes into a graph.
     //
     // TODO STEP 09:********
     //   1. Use vxColorConvertNode and vxChannelExtractNode APIs to get gray
     //      scale image for Harris and Pyramid computation from the input
-    //      RGB image. Add these nodes into the Harris graph.
+    //      RGB image. Add these nodes into the front-end graph.
     //      We gave code in comments with a missing parameter for you to fill in.
     //   2. Use vxGaussianPyramidNode API to add pyramid computation node.
     //      You need to use the current pyramid from the pyramid delay object.
     //      We gave code in comments with a missing parameter for you to fill in.
-    //   3. Use vxHarrisCornersNode API to add a Harris corners node.
+    //   3. Use vxHarrisCornersNode API to add a Harris corners node into the Harris graph.
     //      You need to use the current keypoints from keypoints delay object.
     //      We gave code in comments with few missing parameters for you to fill in.
     //   4. Use ERROR_CHECK_OBJECT to check proper creation of objects.
     //   5. Release node and virtual objects immediately since the graph
     //      retains references to them.
-    //   6. Call vxVerifyGraph to check for any errors in the graph.
+    //   6. Call vxVerifyGraph to check for any errors in the graphs.
     //      Fill in missing parameter in commented code.
+//    vx_node nodesFront[] =
+//    {
+//        addNodeToPerfReport( nodeReport, "Front", vxColorConvertNode( graphFront, input_rgb_image, front_yuv_image ) ),
+//        addNodeToPerfReport( nodeReport, "Front", vxChannelExtractNode( graphFront, /* Fill in parameter */, VX_CHANNEL_Y, gray_image ) ),
+//        addNodeToPerfReport( nodeReport, "Front", vxGaussianPyramidNode( graphFront, /* Fill in parameter */, currentPyramid ) )
+//    };
+//    for( vx_size i = 0; i < sizeof( nodesFront ) / sizeof( nodesFront[0] ); i++ )
+//    {
+//        ERROR_CHECK_OBJECT( nodesFront[i] );
+//        ERROR_CHECK_STATUS( vxReleaseNode( &nodesFront[i] ) );
+//    }
+//    ERROR_CHECK_STATUS( vxReleaseImage( &front_yuv_image ) );
+//    ERROR_CHECK_STATUS( vxVerifyGraph( /* Fill in parameter */ ) );
+//
 //    vx_node nodesHarris[] =
 //    {
-//        vxColorConvertNode( graphHarris, input_rgb_image, harris_yuv_image ),
-//        vxChannelExtractNode( graphHarris, /* Fill in parameter */, VX_CHANNEL_Y, harris_gray_image ),
-//        vxGaussianPyramidNode( graphHarris, /* Fill in parameter */, currentPyramid ),
-//        vxHarrisCornersNode( graphHarris, /* Fill in missing parameters */, currentKeypoints, NULL )
+//        addNodeToPerfReport( nodeReport, "Harris", vxHarrisCornersNode( graphHarris, /* Fill in missing parameters */, currentKeypoints, NULL ) )
 //    };
 //    for( vx_size i = 0; i < sizeof( nodesHarris ) / sizeof( nodesHarris[0] ); i++ )
 //    {
 //        ERROR_CHECK_OBJECT( nodesHarris[i] );
 //        ERROR_CHECK_STATUS( vxReleaseNode( &nodesHarris[i] ) );
 //    }
-//    ERROR_CHECK_STATUS( vxReleaseImage( &harris_yuv_image ) );
-//    ERROR_CHECK_STATUS( vxReleaseImage( &harris_gray_image ) );
 //    ERROR_CHECK_STATUS( vxVerifyGraph( /* Fill in parameter */ ) );
 
 
     ////////********
-    // Now, build a graph that computes image pyramid for the next frame,
-    // and tracks features using optical flow.
+    // Now, build a graph that tracks features using optical flow between the
+    // previous pyramid and the one computed by the front-end graph for this frame.
     //
     // TODO STEP 10:********
-    //   1. Color convert, channel extract, and Gaussian pyramid nodes are like above.
-    //      Add them to the tracking graph.
-    //   2. Use vxOpticalFlowPyrLKNode API to add an optical flow node. You need to
+    //   1. Use vxOpticalFlowPyrLKNode API to add an optical flow node. You need to
     //      use the current and previous keypoints from the keypoints delay object.
     //      Fill in the missing parameters in commented code.
-    //   3. As above, check for errors, release nodes and virtual objects,
-    //      and verify the graph.
+    //   2. As above, check for errors, release nodes, and verify the graph.
 //    vx_node nodesTrack[] =
 //    {
-//        vxColorConvertNode( graphTrack, input_rgb_image, opticalflow_yuv_image ),
-//        vxChannelExtractNode( graphTrack, /* Fill in parameters */ ),
-//        vxGaussianPyramidNode( graphTrack, /* Fill in parameter */, currentPyramid ),
-//        vxOpticalFlowPyrLKNode( graphTrack, /* Fill in parameters */ )
+//        addNodeToPerfReport( nodeReport, "Track", vxOpticalFlowPyrLKNode( graphTrack, /* Fill in parameters */ ) )
 //    };
 //    for( vx_size i = 0; i < sizeof( nodesTrack ) / sizeof( nodesTrack[0] ); i++ )
 //    {
 //        ERROR_CHECK_OBJECT( nodesTrack[i] );
 //        ERROR_CHECK_STATUS( vxReleaseNode( &nodesTrack[i] ) );
 //    }
-//    ERROR_CHECK_STATUS( vxReleaseImage( &opticalflow_yuv_image ) );
-//    ERROR_CHECK_STATUS( vxReleaseImage( &opticalflow_gray_image ) );
 //    ERROR_CHECK_STATUS( vxVerifyGraph( /* Fill in parameter */ ) );
+//
+//    // The graphs keep a reference to the gray image, so release it now.
+//    ERROR_CHECK_STATUS( vxReleaseImage( &gray_image ) );
 
 
     ////////
@@ -396,15 +406,17 @@ int main( int argc, char * argv[] )
 
 
         ////////********
-        // Now that input RGB image is ready, just run a graph.
+        // Now that input RGB image is ready, run the front-end graph and then a back-end graph.
         // Run Harris at the beginning to initialize the previous keypoints,
         // on other frames run the tracking graph.
         //
         // TODO STEP 12:********
-        //   1. Run a graph using vxProcessGraph API. Select Harris graph
+        //   1. Run the front-end graph using vxProcessGraph API.
+        //   2. Run a back-end graph using vxProcessGraph API. Select Harris graph
         //      if the frame_index == 0 (i.e., the first frame of the video
         //      sequence), otherwise, select the feature tracking graph.
-        //   2. Use ERROR_CHECK_STATUS for error checking.
+        //   3. Use ERROR_CHECK_STATUS for error checking.
+        //   4. Call sampleNodePerfReport( nodeReport ) after the graphs have run.
 
 
 
@@ -491,16 +503,20 @@ int main( int argc, char * argv[] )
     //
     // TODO STEP 15:********
     //   1. Use vxQueryGraph API with VX_GRAPH_PERFORMANCE to query graph performance.
-    //      We gave the attribute query for one graph in comments. Do the same for the second graph.
+    //      We gave the attribute query for one graph in comments. Do the same for the other graphs.
     //   2. Print the average and min execution times in milliseconds. Use the printf in comments.
-//    vx_perf_t perfHarris = { 0 }, perfTrack = { 0 };
-//    ERROR_CHECK_STATUS( vxQueryGraph( graphHarris, VX_GRAPH_PERFORMANCE, &perfHarris, sizeof( perfHarris ) ) );
-//    ERROR_CHECK_STATUS( vxQueryGraph( /* Fill in parameters here for get performance of the other graph */ );
+//    vx_perf_t perfFront = { 0 }, perfHarris = { 0 }, perfTrack = { 0 };
+//    ERROR_CHECK_STATUS( vxQueryGraph( graphFront, VX_GRAPH_PERFORMANCE, &perfFront, sizeof( perfFront ) ) );
+//    ERROR_CHECK_STATUS( vxQueryGraph( /* Fill in parameters here for get performance of the other graphs */ );
+//    ERROR_CHECK_STATUS( vxQueryGraph( /* Fill in parameters here for get performance of the other graphs */ );
 //    printf( "GraphName NumFrames Avg(ms) Min(ms)\n"
+//            "Front     %9d %7.3f %7.3f\n"
 //            "Harris    %9d %7.3f %7.3f\n"
 //            "Track     %9d %7.3f %7.3f\n",
+//            ( int )perfFront.num,  ( float )perfFront.avg  * 1e-6f, ( float )perfFront.min  * 1e-6f,
 //            ( int )perfHarris.num, ( float )perfHarris.avg * 1e-6f, ( float )perfHarris.min * 1e-6f,
 //            ( int )perfTrack.num,  ( float )perfTrack.avg  * 1e-6f, ( float )perfTrack.min  * 1e-6f );
+//    printNodePerfReport( nodeReport );
 
 
     ////////********
@@ -510,8 +526,10 @@ int main( int argc, char * argv[] )
     //
     // TODO STEP 16:********
     //   1. For releasing all other objects use vxRelease<Object> APIs.
-    //      You have to release 2 graph objects, 1 image object, 2 delay objects,
+    //      You have to release 3 graph objects, 1 image object, 2 delay objects,
     //      6 scalar objects, and 1 context object.
+//    releaseNodePerfReport( &nodeReport );
+//    ERROR_CHECK_STATUS( vxReleaseGraph( /* fill in */ ) );
 //    ERROR_CHECK_STATUS( vxReleaseGraph( /* fill in */ ) );
 //    ERROR_CHECK_STATUS( vxReleaseGraph( /* fill in */ ) );
 //    ERROR_CHECK_STATUS( vxReleaseImage( &input_rgb_image ) );
@@ -33,6 +33,10 @@
 // Include OpenCV wrapper for image capture and display.
 #include "opencv_camera_display.h"
 
+////////
+// Include the per-node performance report (include/nodePerf.h).
+#include "nodePerf.h"
+
 ////////
 // The most important top-level OpenVX header files are "VX/vx.h" and "VX/vxu.h".
 // The "VX/vx.h" includes all headers needed to support functionality of the
@@ -308,6 +312,10 @@ int main( int argc, char * argv[] )
     ERROR_CHECK_OBJECT( context );
     vxRegisterLogCallback( context, log_callback, vx_false_e );
 
+    ////////
+    // Collect the time taken by every node of the graph below on every frame.
+    struct node_perf_report * nodeReport = createNodePerfReport( context );
+
     ////////
     // Register user kernels with the context.
     //
@@ -350,9 +358,9 @@ int main( int argc, char * argv[] )
     //      We gave most of the code in comments; fill in parameters for user kernel.
     vx_node nodes[] =
     {
-        vxColorConvertNode(   graph, input_rgb_image, yuv_image ),
-        vxChannelExtractNode( graph, yuv_image, VX_CHANNEL_Y, output_filtered_image /* change to luma_image */ ),
-//        userMedianBlurNode(   graph, /* Fill in parameters */ )
+        addNodeToPerfReport( nodeReport, "Median", vxColorConvertNode(   graph, input_rgb_image, yuv_image ) ),
+        addNodeToPerfReport( nodeReport, "Median", vxChannelExtractNode( graph, yuv_image, VX_CHANNEL_Y, output_filtered_image /* change to luma_image */ ) ),
+//        addNodeToPerfReport( nodeReport, "Median", userMedianBlurNode(   graph, /* Fill in parameters */ ) )
     };
 //    for( vx_size i = 0; i < sizeof( nodes ) / sizeof( nodes[0] ); i++ )
 //    {
@@ -388,6 +396,7 @@ int main( int argc, char * argv[] )
         ////////
         // Now that input RGB image is ready, just run the graph.
         ERROR_CHECK_STATUS( vxProcessGraph( graph ) );
+        sampleNodePerfReport( nodeReport );
 
         ////////
         // Display the output filtered image.
@@ -425,10 +434,12 @@ int main( int argc, char * argv[] )
     printf( "GraphName NumFrames Avg(ms) Min(ms)\n"
             "Median    %9d %7.3f %7.3f\n",
             ( int )perf.num, ( float )perf.avg * 1e-6f, ( float )perf.min * 1e-6f );
+    printNodePerfReport( nodeReport );
 
     ////////********
     // To release an OpenVX object, you need to call vxRelease<Object> API which takes a pointer to the object.
     // If the release operation is successful, the OpenVX framework will reset the object to NULL.
+    releaseNodePerfReport( &nodeReport );
     ERROR_CHECK_STATUS( vxReleaseGraph( &graph ) );
     ERROR_CHECK_STATUS( vxReleaseImage( &input_rgb_image ) );
     ERROR_CHECK_STATUS( vxReleaseImage( &output_filtered_image ) );
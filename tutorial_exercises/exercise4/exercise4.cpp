@@ -32,6 +32,11 @@
 ////////
 // Include OpenCV wrapper for image capture and display.
 #include "opencv_camera_display.h"
+#include "tensor_image_convert.h"
+
+////////
+// Include the per-node performance report (include/nodePerf.h).
+#include "nodePerf.h"
 
 ////////
 // The top-level OpenVX header file is "VX/vx.h".
@@ -76,6 +81,8 @@ enum user_library_e
 enum user_kernel_e
 {
     USER_KERNEL_TENSOR_COS     = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x001,
+    USER_KERNEL_IMAGE_TO_TENSOR = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x002,
+    USER_KERNEL_TENSOR_TO_IMAGE = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x003,
 };
 
 ////////
@@ -439,114 +446,122 @@ int main( int argc, char * argv[] )
     ERROR_CHECK_OBJECT( context );
     vxRegisterLogCallback( context, log_callback, vx_false_e );
 
+    ////////
+    // Collect the time taken by every node of the graph below on every frame.
+    struct node_perf_report * nodeReport = createNodePerfReport( context );
+
     ////////
     // Register user kernels with the context.
     //
     // TODO:********
     //   1. Register user kernel with context by calling your implementation of "registerUserKernel()".
     ERROR_CHECK_STATUS( registerUserKernel( context ) );
+    ERROR_CHECK_STATUS( CTensorImageConvert::Register( context, USER_KERNEL_IMAGE_TO_TENSOR, USER_KERNEL_TENSOR_TO_IMAGE, true ) );
 
     ////////
-    // Create OpenVX tensor objects for input and output
+    // Create OpenVX image objects for the input and output RGB frames, and
+    // virtual tensor objects for input and output of the tensor_cos node.
+    // The tensors are only accessed inside the graph: the conversions between
+    // the RGB frames and the Q-format tensors are nodes of the graph too.
     //
     // TODO:********
-    //   1. Create tensor objects using tensor_dims, tensor_input_fixed_point_pos, and
-    //      tensor_output_fixed_point_pos
-    vx_tensor input_tensor   = vxCreateTensor( context, 3, tensor_dims, VX_TYPE_INT16, tensor_input_fixed_point_pos );
-    vx_tensor output_tensor  = vxCreateTensor( context, 3, tensor_dims, VX_TYPE_INT16, tensor_output_fixed_point_pos );
+    //   1. Create RGB image objects with the frame dimensions, and virtual tensor objects
+    //      using tensor_dims, tensor_input_fixed_point_pos, and tensor_output_fixed_point_pos
+    vx_graph graph = vxCreateGraph( context );
+    ERROR_CHECK_OBJECT( graph );
+    vx_image  input_image    = vxCreateImage( context, width, height, VX_DF_IMAGE_RGB );
+    vx_image  output_image   = vxCreateImage( context, width, height, VX_DF_IMAGE_RGB );
+    vx_tensor input_tensor   = vxCreateVirtualTensor( graph, 3, tensor_dims, VX_TYPE_INT16, tensor_input_fixed_point_pos );
+    vx_tensor output_tensor  = vxCreateVirtualTensor( graph, 3, tensor_dims, VX_TYPE_INT16, tensor_output_fixed_point_pos );
+    ERROR_CHECK_OBJECT( input_image );
+    ERROR_CHECK_OBJECT( output_image );
     ERROR_CHECK_OBJECT( input_tensor );
     ERROR_CHECK_OBJECT( output_tensor );
 
     ////////
-    // Create, build, and verify the graph with user kernel node.
+    // Create, build, and verify the graph with user kernel nodes:
+    //   input_image -> image_to_tensor -> tensor_cos -> tensor_to_image -> output_image
+    // image_to_tensor converts 0..255 to Q10.5 [-4..3.96875 range] with
+    // pixel / 32 - 4, and tensor_to_image converts Q8.7 [-1..1 range] back
+    // to 0..255 with value * 128 + 128 and saturation. The output image is
+    // written in BGR order for display by OpenCV.
     //
     // TODO:********
-    //   1. Build a graph with just one node created using userTensorCosNode()
-    vx_graph graph = vxCreateGraph( context );
-    ERROR_CHECK_OBJECT( graph );
-    vx_node cos_node = userTensorCosNode( graph, input_tensor, output_tensor );
-    ERROR_CHECK_OBJECT( cos_node );
-    ERROR_CHECK_STATUS( vxReleaseNode( &cos_node ) );
+    //   1. Build a graph with image_to_tensor, userTensorCosNode(), and tensor_to_image nodes
+#if ENABLE_BGR_INGEST
+    // Read the BGR frame directly, picking the channels in reverse order.
+    vx_uint32 input_channel_order = TENSOR_IMAGE_CHANNEL_ORDER_BGR;
+#else
+    vx_uint32 input_channel_order = TENSOR_IMAGE_CHANNEL_ORDER_RGB;
+#endif
+    vx_node nodes[] =
+    {
+        addNodeToPerfReport( nodeReport, "Cosine", CTensorImageConvert::ImageToTensorNode( graph, input_image, input_tensor, 1.0f / 32, -4.0f, input_channel_order ) ),
+        addNodeToPerfReport( nodeReport, "Cosine", userTensorCosNode( graph, input_tensor, output_tensor ) ),
+        addNodeToPerfReport( nodeReport, "Cosine", CTensorImageConvert::TensorToImageNode( graph, output_tensor, output_image, 128.0f, 128.0f, TENSOR_IMAGE_CHANNEL_ORDER_BGR ) ),
+    };
+    for( vx_size i = 0; i < sizeof( nodes ) / sizeof( nodes[0] ); i++ )
+    {
+        ERROR_CHECK_OBJECT( nodes[i] );
+        ERROR_CHECK_STATUS( vxReleaseNode( &nodes[i] ) );
+    }
+    ERROR_CHECK_STATUS( vxReleaseTensor( &input_tensor ) );
+    ERROR_CHECK_STATUS( vxReleaseTensor( &output_tensor ) );
     ERROR_CHECK_STATUS( vxVerifyGraph( graph ) );
 
     ////////
     // Process the video sequence frame by frame until the end of sequence or aborted.
-    cv::Mat bgrMatForOutputDisplay( height, width, CV_8UC3 );
+    vx_rectangle_t rect = { 0, 0, width, height };
     for( int frame_index = 0; !gui.AbortRequested(); frame_index++ )
     {
         ////////
-        // Copy input RGB frame from OpenCV into input_tensor with UINT8 to Q10.5 (INT16) conversion.
-        // In order to do this, vxMapTensorPatch API (see "vx_ext_amd.h").
+        // Copy input RGB frame from OpenCV into input_image. The conversion
+        // to Q10.5 (INT16) is done in the graph.
         //
-         // TODO:********
-         //   1. Use vxMapTensorPatch API for access to input tensor object for writing
-         //   2. Copy UINT8 data from OpenCV RGB image to tensor object
-         //   3. Use vxUnmapTensorPatch API to return control of buffer back to framework
-        vx_uint8 * cv_rgb_image_buffer = gui.GetBuffer();
-        vx_size rgb_stride             = gui.GetStride();
-        vx_size zeros[3]               = { 0 };
-        vx_size tensor_stride[3];
-        vx_map_id map_id;
-        vx_uint8 * buf;
-        ERROR_CHECK_STATUS( vxMapTensorPatch( input_tensor,
-                                              3, zeros, tensor_dims,
-                                              &map_id, tensor_stride,
-                                              (void **)&buf, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, 0 ) );
-        for( vx_size c = 0; c < 3; c++ )
-        {
-            for( vx_size y = 0; y < height; y++ )
-            {
-                const vx_uint8 * img = cv_rgb_image_buffer + y * rgb_stride + c;
-                vx_int16 * inp = (vx_int16 *)(buf + y * tensor_stride[1] + c * tensor_stride[2]);
-                for( vx_size x = 0; x < width; x++ )
-                {
-                    // convert 0..255 to Q10.5 [-4..3.96875 range] fixed-point format
-                    inp[x] = (vx_int16)img[x * 3] - 128;
-                }
-            }
-        }
-        ERROR_CHECK_STATUS( vxUnmapTensorPatch( input_tensor, map_id ) );
-
+        // TODO:********
+        //   1. Use vxCopyImagePatch API to copy the OpenCV frame into the input image
+        vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
+        addr.dim_x    = width;
+        addr.dim_y    = height;
+        addr.stride_x = 3;
+        addr.scale_x  = VX_SCALE_UNITY;
+        addr.scale_y  = VX_SCALE_UNITY;
+        addr.step_x   = 1;
+        addr.step_y   = 1;
+#if ENABLE_BGR_INGEST
+        addr.stride_y = gui.GetStrideBGR();
+        void * ptr    = gui.GetBufferBGR();
+#else
+        addr.stride_y = gui.GetStride();
+        void * ptr    = gui.GetBuffer();
+#endif
+        ERROR_CHECK_STATUS( vxCopyImagePatch( input_image, &rect, 0, &addr, ptr, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST ) );
 
         ////////
-        // Now that input tensor is ready, just run the graph.
+        // Now that input image is ready, just run the graph.
         //
         // TODO:********
-        //   1. Call vxProcessGraph to execute the tensor_cos kernel in graph
+        //   1. Call vxProcessGraph to execute the nodes in graph
         ERROR_CHECK_STATUS( vxProcessGraph( graph ) );
+        sampleNodePerfReport( nodeReport );
 
         ////////
-        // Display the output tensor object as RGB image
+        // Display the output image, which is already in BGR order
         //
         // TODO:********
-        //   1. Use vxMapTensorPatch API for access to output tensor object for reading
-        //   2. Copy tensor object data into OpenCV RGB image
-        //   3. Use vxUnmapTensorPatch API to return control of buffer back to framework
-        ERROR_CHECK_STATUS( vxMapTensorPatch( output_tensor,
-                                              3, zeros, tensor_dims,
-                                              &map_id, tensor_stride,
-                                              (void **)&buf, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, 0 ) );
-        vx_uint8 * cv_bgr_image_buffer = bgrMatForOutputDisplay.data;
-        vx_size bgr_stride             = bgrMatForOutputDisplay.step;
-        for( vx_size c = 0; c < 3; c++ )
-        {
-            for( vx_size y = 0; y < height; y++ )
-            {
-                const vx_int16 * out = (const vx_int16 *)(buf + y * tensor_stride[1] + c * tensor_stride[2]);
-                vx_uint8 * img = cv_bgr_image_buffer + y * bgr_stride + (2 - c); // (2 - c) for RGB to BGR conversion
-                for( vx_size x = 0; x < width; x++ )
-                {
-                    // scale convert Q8.7 [-1..1 range] fixed-point format to 0..255 with saturation
-                    vx_int16 value = out[x] + 128;
-                    value = value > 255 ? 255 : value; // saturation needed
-                    img[x * 3] = (vx_uint8)value;
-                }
-            }
-        }
+        //   1. Use vxMapImagePatch API for access to output image object for reading
+        //   2. Wrap the buffer as an OpenCV image for display
+        //   3. Use vxUnmapImagePatch API to return control of buffer back to framework
+        vx_map_id map_id;
+        vx_imagepatch_addressing_t output_addr;
+        void * output_ptr;
+        ERROR_CHECK_STATUS( vxMapImagePatch( output_image, &rect, 0, &map_id, &output_addr, &output_ptr,
+                                             VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X ) );
 #if ENABLE_DISPLAY
+        cv::Mat bgrMatForOutputDisplay( height, width, CV_8UC3, output_ptr, output_addr.stride_y );
         cv::imshow( "Cosine", bgrMatForOutputDisplay );
 #endif
-        ERROR_CHECK_STATUS( vxUnmapTensorPatch( output_tensor, map_id ) );
+        ERROR_CHECK_STATUS( vxUnmapImagePatch( output_image, map_id ) );
 
         ////////
         // Display the results and grab the next input RGB frame for the next iteration.
@@ -562,15 +577,20 @@ int main( int argc, char * argv[] )
         }
     }
 
+    ////////
+    // Print the time taken by each node.
+    printNodePerfReport( nodeReport );
+
     ////////
     // To release an OpenVX object, you need to call vxRelease<Object> API which takes a pointer to the object.
     // If the release operation is successful, the OpenVX framework will reset the object to NULL.
     //
     // TODO:****
-    //   1. Release graph and tensor objects
+    //   1. Release graph and image objects
     ERROR_CHECK_STATUS( vxReleaseGraph( &graph ) );
-    ERROR_CHECK_STATUS( vxReleaseTensor( &input_tensor ) );
-    ERROR_CHECK_STATUS( vxReleaseTensor( &output_tensor ) );
+    ERROR_CHECK_STATUS( vxReleaseImage( &input_image ) );
+    ERROR_CHECK_STATUS( vxReleaseImage( &output_image ) );
+    releaseNodePerfReport( &nodeReport );
     ERROR_CHECK_STATUS( vxReleaseContext( &context ) );
 
     return 0;
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+/*!
+ * \file   channel_swap.h
+ * \brief  red/blue channel swap of a BGR frame inside a graph
+ *
+ * OpenVX has no BGR image format, so a BGR frame captured by OpenCV is
+ * wrapped as a VX_DF_IMAGE_RGB image with its red and blue channels swapped.
+ * AddNodes() puts the swap that cv::cvtColor would do on the host into the
+ * graph instead: three channel extract nodes and a channel combine node,
+ * writing a virtual RGB image. This is a full-frame pass on every frame,
+ * it just runs in the graph rather than in the capture code.
+ */
+
+#ifndef __channel_swap_h__
+#define __channel_swap_h__
+
+#include <VX/vx.h>
+
+class CChannelSwap
+{
+public:
+    // Add the swap nodes for bgr_image to graph and return the virtual RGB
+    // image they write, or NULL on failure. The caller releases the image.
+    static vx_image AddNodes( vx_graph graph, vx_image bgr_image, vx_uint32 width, vx_uint32 height )
+    {
+        vx_image rgb_image = vxCreateVirtualImage( graph, width, height, VX_DF_IMAGE_RGB );
+        vx_image channels[3] = { NULL, NULL, NULL };
+        vx_status status = vxGetStatus( ( vx_reference )rgb_image );
+        for( int c = 0; c < 3 && status == VX_SUCCESS; c++ )
+        {
+            channels[c] = vxCreateVirtualImage( graph, width, height, VX_DF_IMAGE_U8 );
+            status = vxGetStatus( ( vx_reference )channels[c] );
+        }
+        if( status == VX_SUCCESS )
+        {
+            vx_node nodes[] =
+            {
+                vxChannelExtractNode( graph, bgr_image, VX_CHANNEL_R, channels[2] ),
+                vxChannelExtractNode( graph, bgr_image, VX_CHANNEL_G, channels[1] ),
+                vxChannelExtractNode( graph, bgr_image, VX_CHANNEL_B, channels[0] ),
+                vxChannelCombineNode( graph, channels[0], channels[1], channels[2], NULL, rgb_image )
+            };
+            for( vx_size i = 0; i < sizeof( nodes ) / sizeof( nodes[0] ); i++ )
+            {
+                vx_status node_status = vxGetStatus( ( vx_reference )nodes[i] );
+                if( node_status == VX_SUCCESS )
+                {
+                    vxReleaseNode( &nodes[i] );
+                }
+                else if( status == VX_SUCCESS )
+                {
+                    status = node_status;
+                }
+            }
+        }
+        for( int c = 0; c < 3; c++ )
+        {
+            if( channels[c] )
+            {
+                vxReleaseImage( &channels[c] );
+            }
+        }
+        if( status != VX_SUCCESS && rgb_image )
+        {
+            vxReleaseImage( &rgb_image );
+            rgb_image = NULL;
+        }
+        return rgb_image;
+    }
+};
+
+#endif
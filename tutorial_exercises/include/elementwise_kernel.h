@@ -0,0 +1,580 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+/*!
+ * \file   elementwise_kernel.h
+ * \brief  user kernels for chains of element-wise operators on Q-format tensors
+ *
+ * An operator is a small struct that describes one element-wise function of
+ * a float value twice: as C++ (operator()) and as an OpenCL C expression
+ * (OpenCL()), with its constant parameters. CElementwiseKernel< Op1, Op2, ... >
+ * is a user kernel that applies Op1, then Op2, ... to every element of a
+ * VX_TYPE_INT16 tensor in a single node, so a chain of pointwise operations
+ * reads and writes the tensors once instead of once per operation, and the
+ * intermediate results are not rounded to 16 bits.
+ *
+ * Both implementations are generated from the chain:
+ *  - on the CPU, the initialize callback tabulates the whole chain for the
+ *    65536 possible inputs (CTensorLutInt16), so any chain costs one table
+ *    lookup per element;
+ *  - with the AMD OpenCL extension, the code generation callback nests the
+ *    OpenCL expressions of the operators into a single OpenCL kernel that
+ *    processes up to 16 elements per work-item with vloadn/vstoren.
+ *
+ * The kernel parameters are:
+ *   parameter #0  --  input tensor  of format VX_TYPE_INT16, up to 4 dimensions
+ *   parameter #1  --  output tensor of format VX_TYPE_INT16 with the same dimensions
+ *   parameter #2  --  array of VX_TYPE_FLOAT32 with the operator parameters, in chain order
+ *
+ * Typical use:
+ *   typedef CElementwiseKernel< ElementwiseCos, ElementwiseClamp > CosClamp;
+ *   CosClamp::Register( context, USER_KERNEL_COS_CLAMP, true );
+ *   vx_node node = CosClamp::CreateNode( graph, input, output, ElementwiseCos(), ElementwiseClamp( 0, 1 ) );
+ */
+
+#ifndef __elementwise_kernel_h__
+#define __elementwise_kernel_h__
+
+#include <VX/vx.h>
+#include <vx_ext_amd.h>
+#include "tensor_lut_int16.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+////////
+// Operators. Each one has:
+//   Name()           - identifier used in the kernel name
+//   NUM_PARAMS       - number of float parameters
+//   Load() / Store() - read and write the parameters from and to an array
+//   operator()       - the function on the host
+//   OpenCL()         - the function applied to the OpenCL expression x, which is
+//                      a float or a floatn: scalar parameters must mix with both
+
+// Format a float as an OpenCL C literal that reads back as the same value
+inline std::string ElementwiseLiteral( vx_float32 value )
+{
+    char text[32];
+    sprintf( text, "%.9ef", value );
+    return text;
+}
+
+// Pick the number of VX_TYPE_INT16 elements that an OpenCL work-item processes
+// along a run of extent contiguous elements: the widest of 16, 8, 4, and 2 that
+// the run fills at least once, preferring a width whose size in bytes divides
+// the other strides (input_stride[1..num_strides-1], same for output) so that
+// all the vectors are equally aligned. vloadn/vstoren only need element
+// alignment, so an unaligned width still works. Stride 0 is the element stride;
+// the kernel falls back to 1 element when either tensor is not contiguous.
+inline vx_uint32 ElementwiseVectorWidth( vx_size extent, const vx_size input_stride[], const vx_size output_stride[], vx_size num_strides )
+{
+    vx_uint32 vector_width = 1;
+    if( input_stride[0] == sizeof( vx_int16 ) && output_stride[0] == sizeof( vx_int16 ) )
+    {
+        for( vx_uint32 pass = 0; pass < 2 && vector_width == 1; pass++ )
+        {
+            for( vx_uint32 width = 16; width >= 2 && vector_width == 1; width >>= 1 )
+            {
+                bool aligned = true;
+                for( vx_size i = 1; i < num_strides; i++ )
+                    aligned = aligned && input_stride[i]  % ( width * sizeof( vx_int16 ) ) == 0
+                                      && output_stride[i] % ( width * sizeof( vx_int16 ) ) == 0;
+                if( extent >= width && ( aligned || pass == 1 ) )
+                    vector_width = width;
+            }
+        }
+    }
+    return vector_width;
+}
+
+// Pick a local work size of up to 64 along the rows and up to 256 work-items in
+// total for a 3-dimensional global_work, and round the global work up to a
+// multiple of it. Returns true when the global work was padded, in which case
+// the kernel must skip the work-items outside global_work.
+inline bool ElementwiseWorkSize( const vx_size global_work[3], vx_size opencl_global_work[], vx_size opencl_local_work[] )
+{
+    vx_size local_work[3] = { 1, 1, 1 };
+    while( local_work[0] < 64 && local_work[0] < global_work[0] )
+        local_work[0] <<= 1;
+    while( local_work[0] * local_work[1] < 256 && local_work[1] < global_work[1] )
+        local_work[1] <<= 1;
+    bool padded = false;
+    for( int i = 0; i < 3; i++ )
+    {
+        opencl_local_work[i]  = local_work[i];
+        opencl_global_work[i] = ( global_work[i] + local_work[i] - 1 ) / local_work[i] * local_work[i];
+        padded = padded || opencl_global_work[i] != global_work[i];
+    }
+    return padded;
+}
+
+struct ElementwiseCos
+{
+    enum { NUM_PARAMS = 0 };
+    static std::string Name() { return "cos"; }
+    void Load( const vx_float32 * params ) { }
+    void Store( vx_float32 * params ) const { }
+    vx_float32 operator()( vx_float32 x ) const { return cosf( x ); }
+    std::string OpenCL( const std::string & x ) const { return "native_cos(" + x + ")"; }
+};
+
+// min( max( alpha * x + beta, 0 ), 1 )
+struct ElementwiseHardSigmoid
+{
+    enum { NUM_PARAMS = 2 };
+    vx_float32 alpha, beta;
+    ElementwiseHardSigmoid( vx_float32 alpha_ = 0.2f, vx_float32 beta_ = 0.5f ) : alpha( alpha_ ), beta( beta_ ) { }
+    static std::string Name() { return "hard_sigmoid"; }
+    void Load( const vx_float32 * params ) { alpha = params[0]; beta = params[1]; }
+    void Store( vx_float32 * params ) const { params[0] = alpha; params[1] = beta; }
+    vx_float32 operator()( vx_float32 x ) const { return fminf( fmaxf( alpha * x + beta, 0.0f ), 1.0f ); }
+    std::string OpenCL( const std::string & x ) const
+    {
+        return "fmin(fmax((" + x + ") * " + ElementwiseLiteral( alpha ) + " + " + ElementwiseLiteral( beta ) + ", 0.0f), 1.0f)";
+    }
+};
+
+// scale * x + offset
+struct ElementwiseScaleOffset
+{
+    enum { NUM_PARAMS = 2 };
+    vx_float32 scale, offset;
+    ElementwiseScaleOffset( vx_float32 scale_ = 1.0f, vx_float32 offset_ = 0.0f ) : scale( scale_ ), offset( offset_ ) { }
+    static std::string Name() { return "scale_offset"; }
+    void Load( const vx_float32 * params ) { scale = params[0]; offset = params[1]; }
+    void Store( vx_float32 * params ) const { params[0] = scale; params[1] = offset; }
+    vx_float32 operator()( vx_float32 x ) const { return scale * x + offset; }
+    std::string OpenCL( const std::string & x ) const
+    {
+        return "((" + x + ") * " + ElementwiseLiteral( scale ) + " + " + ElementwiseLiteral( offset ) + ")";
+    }
+};
+
+// min( max( x, low ), high )
+struct ElementwiseClamp
+{
+    enum { NUM_PARAMS = 2 };
+    vx_float32 low, high;
+    ElementwiseClamp( vx_float32 low_ = 0.0f, vx_float32 high_ = 1.0f ) : low( low_ ), high( high_ ) { }
+    static std::string Name() { return "clamp"; }
+    void Load( const vx_float32 * params ) { low = params[0]; high = params[1]; }
+    void Store( vx_float32 * params ) const { params[0] = low; params[1] = high; }
+    vx_float32 operator()( vx_float32 x ) const { return fminf( fmaxf( x, low ), high ); }
+    std::string OpenCL( const std::string & x ) const
+    {
+        return "clamp(" + x + ", " + ElementwiseLiteral( low ) + ", " + ElementwiseLiteral( high ) + ")";
+    }
+};
+
+////////
+// A chain of operators, applied first to last, is itself an operator
+template< class... Ops > struct ElementwiseChain;
+
+template<> struct ElementwiseChain<>
+{
+    enum { NUM_PARAMS = 0 };
+    static std::string Name() { return ""; }
+    void Load( const vx_float32 * params ) { }
+    void Store( vx_float32 * params ) const { }
+    vx_float32 operator()( vx_float32 x ) const { return x; }
+    std::string OpenCL( const std::string & x ) const { return x; }
+};
+
+template< class Op, class... Rest > struct ElementwiseChain< Op, Rest... >
+{
+    typedef ElementwiseChain< Rest... > Tail;
+    enum { NUM_PARAMS = Op::NUM_PARAMS + Tail::NUM_PARAMS };
+    Op   op;
+    Tail rest;
+    static std::string Name()
+    {
+        std::string tail = Tail::Name();
+        return tail.empty() ? Op::Name() : Op::Name() + "." + tail;
+    }
+    void Load( const vx_float32 * params ) { op.Load( params ); rest.Load( params + Op::NUM_PARAMS ); }
+    void Store( vx_float32 * params ) const { op.Store( params ); rest.Store( params + Op::NUM_PARAMS ); }
+    vx_float32 operator()( vx_float32 x ) const { return rest( op( x ) ); }
+    std::string OpenCL( const std::string & x ) const { return rest.OpenCL( op.OpenCL( x ) ); }
+};
+
+////////
+// The user kernel for a chain of operators
+template< class... Ops >
+class CElementwiseKernel
+{
+public:
+    typedef ElementwiseChain< Ops... > Chain;
+
+    // "app.userkernels.elementwise.<op>.<op>..."
+    static std::string Name()
+    {
+        return "app.userkernels.elementwise." + Chain::Name();
+    }
+
+    // Register the kernel with kernel_enum as its enumeration. With use_opencl,
+    // the kernel also registers the AMD OpenCL code generation callbacks, and the
+    // framework may run it on the GPU.
+    static vx_status Register( vx_context context, vx_enum kernel_enum, bool use_opencl )
+    {
+        vx_kernel kernel = vxAddUserKernel( context, Name().c_str(), kernel_enum,
+                                            HostSideFunction, 3, Validator, Initialize, Deinitialize );
+        vx_status status = vxGetStatus( ( vx_reference ) kernel );
+        if( status == VX_SUCCESS && use_opencl )
+        {
+            amd_kernel_query_target_support_f query_target_support_f = QueryTargetSupport;
+            amd_kernel_opencl_codegen_callback_f opencl_codegen_callback_f = OpenCLCodegen;
+            status = vxSetKernelAttribute( kernel, VX_KERNEL_ATTRIBUTE_AMD_QUERY_TARGET_SUPPORT,
+                                           &query_target_support_f, sizeof( query_target_support_f ) );
+            if( status == VX_SUCCESS )
+            {
+                status = vxSetKernelAttribute( kernel, VX_KERNEL_ATTRIBUTE_AMD_OPENCL_CODEGEN_CALLBACK,
+                                               &opencl_codegen_callback_f, sizeof( opencl_codegen_callback_f ) );
+            }
+        }
+        if( status == VX_SUCCESS )
+            status = vxAddParameterToKernel( kernel, 0, VX_INPUT,  VX_TYPE_TENSOR, VX_PARAMETER_STATE_REQUIRED );
+        if( status == VX_SUCCESS )
+            status = vxAddParameterToKernel( kernel, 1, VX_OUTPUT, VX_TYPE_TENSOR, VX_PARAMETER_STATE_REQUIRED );
+        if( status == VX_SUCCESS )
+            status = vxAddParameterToKernel( kernel, 2, VX_INPUT,  VX_TYPE_ARRAY,  VX_PARAMETER_STATE_REQUIRED );
+        if( status == VX_SUCCESS )
+            status = vxFinalizeKernel( kernel );
+        if( status == VX_SUCCESS )
+        {
+            status = vxReleaseKernel( &kernel );
+            vxAddLogEntry( ( vx_reference ) context, VX_SUCCESS, "OK: registered user kernel %s\n", Name().c_str() );
+        }
+        return status;
+    }
+
+    // Create a node that applies the operators, given with their parameters in
+    // chain order, to input and writes output. The parameters are copied into
+    // an array owned by the node.
+    static vx_node CreateNode( vx_graph graph, vx_tensor input, vx_tensor output, const Ops &... ops )
+    {
+        vx_context context = vxGetContext( ( vx_reference ) graph );
+        vx_float32 params[Chain::NUM_PARAMS + 1];
+        StoreParams( params, ops... );
+
+        vx_kernel kernel = vxGetKernelByName( context, Name().c_str() );
+        vx_array  array  = vxCreateArray( context, VX_TYPE_FLOAT32, Chain::NUM_PARAMS + 1 );
+        vx_node   node   = vxCreateGenericNode( graph, kernel );
+        vx_status status = vxGetStatus( ( vx_reference ) node );
+        if( status == VX_SUCCESS && Chain::NUM_PARAMS > 0 )
+            status = vxAddArrayItems( array, Chain::NUM_PARAMS, params, sizeof( vx_float32 ) );
+        if( status == VX_SUCCESS )
+            status = vxSetParameterByIndex( node, 0, ( vx_reference ) input );
+        if( status == VX_SUCCESS )
+            status = vxSetParameterByIndex( node, 1, ( vx_reference ) output );
+        if( status == VX_SUCCESS )
+            status = vxSetParameterByIndex( node, 2, ( vx_reference ) array );
+        if( status != VX_SUCCESS && vxGetStatus( ( vx_reference ) node ) == VX_SUCCESS )
+        {
+            vxAddLogEntry( ( vx_reference ) graph, status, "ERROR: %s node creation failed\n", Name().c_str() );
+            vxReleaseNode( &node );
+        }
+        vxReleaseArray( &array );
+        vxReleaseKernel( &kernel );
+        return node;
+    }
+
+protected:
+    // Everything the host side function needs, built by Initialize
+    struct LocalData
+    {
+        Chain           chain;
+        CTensorLutInt16 lut;
+    };
+
+    static void StoreParams( vx_float32 * params )
+    {
+    }
+
+    template< class Op, class... Rest >
+    static void StoreParams( vx_float32 * params, const Op & op, const Rest &... rest )
+    {
+        op.Store( params );
+        StoreParams( params + Op::NUM_PARAMS, rest... );
+    }
+
+    // Read the operator parameters from the array of parameter #2
+    static vx_status ReadChain( vx_array array, Chain & chain )
+    {
+        vx_size num_items = 0;
+        vx_status status = vxQueryArray( array, VX_ARRAY_NUMITEMS, &num_items, sizeof( num_items ) );
+        if( status != VX_SUCCESS )
+            return status;
+        if( num_items != Chain::NUM_PARAMS )
+            return VX_ERROR_INVALID_PARAMETERS;
+        vx_float32 params[Chain::NUM_PARAMS + 1];
+        if( num_items > 0 )
+        {
+            status = vxCopyArrayRange( array, 0, num_items, sizeof( vx_float32 ), params, VX_READ_ONLY, VX_MEMORY_TYPE_HOST );
+            if( status != VX_SUCCESS )
+                return status;
+        }
+        chain.Load( params );
+        return VX_SUCCESS;
+    }
+
+    static vx_status QueryTensor( vx_tensor tensor, vx_size & num_of_dims, vx_size dims[4], vx_uint8 & fixed_point_pos )
+    {
+        vx_status status = vxQueryTensor( tensor, VX_TENSOR_NUMBER_OF_DIMS, &num_of_dims, sizeof( num_of_dims ) );
+        if( status != VX_SUCCESS )
+            return status;
+        if( num_of_dims < 1 || num_of_dims > 4 )
+            return VX_ERROR_INVALID_DIMENSION;
+        for( vx_size i = 0; i < 4; i++ )
+            dims[i] = 1;
+        status = vxQueryTensor( tensor, VX_TENSOR_DIMS, dims, num_of_dims * sizeof( vx_size ) );
+        if( status != VX_SUCCESS )
+            return status;
+        return vxQueryTensor( tensor, VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof( fixed_point_pos ) );
+    }
+
+    ////////
+    // Input tensor must be VX_TYPE_INT16 with up to 4 dimensions, and the array
+    // must hold the NUM_PARAMS operator parameters as VX_TYPE_FLOAT32. The output
+    // tensor gets the dimensions of the input and keeps its own fixed-point position.
+    static vx_status VX_CALLBACK Validator( vx_node node, const vx_reference parameters[], vx_uint32 num, vx_meta_format metas[] )
+    {
+        vx_size num_of_dims, dims[4];
+        vx_uint8 input_fixed_point_pos, output_fixed_point_pos;
+        vx_enum data_type = VX_TYPE_INVALID, item_type = VX_TYPE_INVALID;
+        vx_size num_items = 0;
+        vx_status status = QueryTensor( ( vx_tensor ) parameters[0], num_of_dims, dims, input_fixed_point_pos );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( ( vx_tensor ) parameters[0], VX_TENSOR_DATA_TYPE, &data_type, sizeof( data_type ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( ( vx_tensor ) parameters[1], VX_TENSOR_FIXED_POINT_POSITION, &output_fixed_point_pos, sizeof( output_fixed_point_pos ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryArray( ( vx_array ) parameters[2], VX_ARRAY_ITEMTYPE, &item_type, sizeof( item_type ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryArray( ( vx_array ) parameters[2], VX_ARRAY_NUMITEMS, &num_items, sizeof( num_items ) );
+        if( status != VX_SUCCESS )
+            return status;
+        if( data_type != VX_TYPE_INT16 )
+            return VX_ERROR_INVALID_FORMAT;
+        if( item_type != VX_TYPE_FLOAT32 || num_items != Chain::NUM_PARAMS )
+            return VX_ERROR_INVALID_PARAMETERS;
+
+        status = vxSetMetaFormatAttribute( metas[1], VX_TENSOR_NUMBER_OF_DIMS, &num_of_dims, sizeof( num_of_dims ) );
+        if( status == VX_SUCCESS )
+            status = vxSetMetaFormatAttribute( metas[1], VX_TENSOR_DIMS, dims, num_of_dims * sizeof( vx_size ) );
+        if( status == VX_SUCCESS )
+            status = vxSetMetaFormatAttribute( metas[1], VX_TENSOR_DATA_TYPE, &data_type, sizeof( data_type ) );
+        if( status == VX_SUCCESS )
+            status = vxSetMetaFormatAttribute( metas[1], VX_TENSOR_FIXED_POINT_POSITION, &output_fixed_point_pos, sizeof( output_fixed_point_pos ) );
+        return status;
+    }
+
+    ////////
+    // Tabulate the chain for the fixed-point positions of the node's tensors,
+    // and keep it in the node local data.
+    static vx_status VX_CALLBACK Initialize( vx_node node, const vx_reference * refs, vx_uint32 num )
+    {
+        vx_size num_of_dims, dims[4];
+        vx_uint8 input_fixed_point_pos, output_fixed_point_pos;
+        vx_status status = QueryTensor( ( vx_tensor ) refs[0], num_of_dims, dims, input_fixed_point_pos );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( ( vx_tensor ) refs[1], VX_TENSOR_FIXED_POINT_POSITION, &output_fixed_point_pos, sizeof( output_fixed_point_pos ) );
+        LocalData * data = new LocalData;
+        if( status == VX_SUCCESS )
+            status = ReadChain( ( vx_array ) refs[2], data->chain );
+        if( status != VX_SUCCESS )
+        {
+            delete data;
+            return status;
+        }
+        data->lut.Build( input_fixed_point_pos, output_fixed_point_pos, data->chain );
+
+        vx_size size = 0; // the local data is allocated and freed by the kernel
+        status = vxSetNodeAttribute( node, VX_NODE_LOCAL_DATA_SIZE, &size, sizeof( size ) );
+        if( status == VX_SUCCESS )
+            status = vxSetNodeAttribute( node, VX_NODE_LOCAL_DATA_PTR, &data, sizeof( data ) );
+        if( status != VX_SUCCESS )
+            delete data;
+        return status;
+    }
+
+    static vx_status VX_CALLBACK Deinitialize( vx_node node, const vx_reference * refs, vx_uint32 num )
+    {
+        LocalData * data = NULL;
+        vx_status status = vxQueryNode( node, VX_NODE_LOCAL_DATA_PTR, &data, sizeof( data ) );
+        if( status == VX_SUCCESS )
+        {
+            delete data;
+            data = NULL;
+            status = vxSetNodeAttribute( node, VX_NODE_LOCAL_DATA_PTR, &data, sizeof( data ) );
+        }
+        return status;
+    }
+
+    ////////
+    // Look the input elements up in the table of the chain
+    static vx_status VX_CALLBACK HostSideFunction( vx_node node, const vx_reference * refs, vx_uint32 num )
+    {
+        vx_tensor input  = ( vx_tensor ) refs[0];
+        vx_tensor output = ( vx_tensor ) refs[1];
+        vx_size num_of_dims, dims[4];
+        vx_uint8 input_fixed_point_pos, output_fixed_point_pos;
+        LocalData * data = NULL;
+        vx_status status = QueryTensor( input, num_of_dims, dims, input_fixed_point_pos );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( output, VX_TENSOR_FIXED_POINT_POSITION, &output_fixed_point_pos, sizeof( output_fixed_point_pos ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryNode( node, VX_NODE_LOCAL_DATA_PTR, &data, sizeof( data ) );
+        if( status != VX_SUCCESS )
+            return status;
+        if( !data || !data->lut.Matches( input_fixed_point_pos, output_fixed_point_pos ) )
+            return VX_FAILURE;
+
+        vx_size zeros[4] = { 0 };
+        vx_size stride_input[4] = { 0 }, stride_output[4] = { 0 };
+        vx_map_id map_input, map_output;
+        vx_uint8 * buf_input, * buf_output;
+        status = vxMapTensorPatch( input, num_of_dims, zeros, dims, &map_input, stride_input,
+                                   ( void ** ) &buf_input, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0 );
+        if( status != VX_SUCCESS )
+            return status;
+        status = vxMapTensorPatch( output, num_of_dims, zeros, dims, &map_output, stride_output,
+                                   ( void ** ) &buf_output, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, 0 );
+        if( status == VX_SUCCESS )
+        {
+            data->lut.Apply( buf_input, stride_input, buf_output, stride_output, dims );
+            status = vxUnmapTensorPatch( output, map_output );
+        }
+        vx_status unmap_status = vxUnmapTensorPatch( input, map_input );
+        return status != VX_SUCCESS ? status : unmap_status;
+    }
+
+    ////////
+    // The AMD OpenCL extension callbacks: the kernel runs on the CPU or the GPU
+    static vx_status VX_CALLBACK QueryTargetSupport( vx_graph graph, vx_node node, vx_bool use_opencl_1_2,
+                                                     vx_uint32 & supported_target_affinity )
+    {
+        supported_target_affinity = AGO_TARGET_AFFINITY_CPU | AGO_TARGET_AFFINITY_GPU;
+        return VX_SUCCESS;
+    }
+
+    // Each work-item processes vector_width consecutive elements along dims[0]
+    // with vloadn/vstoren, and the operators are nested into one expression on
+    // the float input values. Dimensions 2 and 3 share global_work[2].
+    static vx_status VX_CALLBACK OpenCLCodegen(
+        vx_node node, const vx_reference parameters[], vx_uint32 num, bool opencl_load_function,
+        char opencl_kernel_function_name[64], std::string & opencl_kernel_code, std::string & opencl_build_options,
+        vx_uint32 & opencl_work_dim, vx_size opencl_global_work[], vx_size opencl_local_work[],
+        vx_uint32 & opencl_local_buffer_usage_mask, vx_uint32 & opencl_local_buffer_size_in_bytes )
+    {
+        vx_tensor input  = ( vx_tensor ) parameters[0];
+        vx_tensor output = ( vx_tensor ) parameters[1];
+        vx_size num_of_dims, dims[4];
+        vx_uint8 input_fixed_point_pos, output_fixed_point_pos;
+        vx_size input_stride[4] = { 0 }, output_stride[4] = { 0 };
+        Chain chain;
+        vx_status status = QueryTensor( input, num_of_dims, dims, input_fixed_point_pos );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( output, VX_TENSOR_FIXED_POINT_POSITION, &output_fixed_point_pos, sizeof( output_fixed_point_pos ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( input,  VX_TENSOR_STRIDE_OPENCL, input_stride, num_of_dims * sizeof( vx_size ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( output, VX_TENSOR_STRIDE_OPENCL, output_stride, num_of_dims * sizeof( vx_size ) );
+        if( status == VX_SUCCESS )
+            status = ReadChain( ( vx_array ) parameters[2], chain );
+        if( status != VX_SUCCESS )
+            return status;
+
+        // The last work-item of each row handles the odd tail one element at a time;
+        // the kernel skips the work-items of the padded global work.
+        vx_uint32 vector_width = ElementwiseVectorWidth( dims[0], input_stride, output_stride, 4 );
+        vx_size tail = dims[0] % vector_width;
+        vx_size global_work[3] = { ( dims[0] + vector_width - 1 ) / vector_width, dims[1], dims[2] * dims[3] };
+        bool padded = ElementwiseWorkSize( global_work, opencl_global_work, opencl_local_work );
+        opencl_work_dim = 3;
+
+        std::string vtype = "";
+        char item[1024];
+        if( vector_width > 1 )
+        {
+            sprintf( item, "%u", vector_width );
+            vtype = item;
+        }
+        std::string to_float = ElementwiseLiteral( 1.0f / ( vx_float32 )( 1 << input_fixed_point_pos ) );
+        std::string to_int16 = ElementwiseLiteral( ( vx_float32 )( 1 << output_fixed_point_pos ) );
+        opencl_kernel_code =
+            "__kernel void elementwise(__global uchar * t0_buf, uint t0_offset, uint4 t0_stride,\n"
+            "                          __global uchar * t1_buf, uint t1_offset, uint4 t1_stride,\n"
+            "                          __global uchar * a2_buf, uint a2_offset, uint a2_numitems)\n"
+            "{\n"
+            "  uint i0 = get_global_id(0);\n"
+            "  uint i1 = get_global_id(1);\n"
+            "  uint i2 = get_global_id(2);\n";
+        if( padded )
+        {
+            sprintf( item,
+                "  if(i0 >= %u || i1 >= %u || i2 >= %u) return;\n" // global_work[]
+                , ( vx_uint32 ) global_work[0], ( vx_uint32 ) global_work[1], ( vx_uint32 ) global_work[2] );
+            opencl_kernel_code += item;
+        }
+        sprintf( item,
+            "  uint i3 = i2 / %u;\n" // dims[2]
+            "  i2 = i2 %% %u;\n"     // dims[2]
+            "  __global short * x = (__global short *)(t0_buf + t0_offset + i0 * %u + i1 * %u + i2 * %u + i3 * %u);\n" // vector_width * 2, input_stride[1..3]
+            "  __global short * y = (__global short *)(t1_buf + t1_offset + i0 * %u + i1 * %u + i2 * %u + i3 * %u);\n" // vector_width * 2, output_stride[1..3]
+            , ( vx_uint32 ) dims[2], ( vx_uint32 ) dims[2]
+            , ( vx_uint32 )( vector_width * input_stride[0] ),  ( vx_uint32 ) input_stride[1],  ( vx_uint32 ) input_stride[2],  ( vx_uint32 ) input_stride[3]
+            , ( vx_uint32 )( vector_width * output_stride[0] ), ( vx_uint32 ) output_stride[1], ( vx_uint32 ) output_stride[2], ( vx_uint32 ) output_stride[3] );
+        opencl_kernel_code += item;
+        if( tail > 0 )
+        {
+            sprintf( item,
+                "  if(i0 == %u) {\n"                 // global_work[0] - 1
+                "    for(uint i = 0; i < %u; i++) {\n" // tail
+                "      float fvalue = "
+                , ( vx_uint32 )( global_work[0] - 1 ), ( vx_uint32 ) tail );
+            opencl_kernel_code += item;
+            opencl_kernel_code += chain.OpenCL( "convert_float(x[i]) * " + to_float ) + ";\n"
+                                  "      y[i] = convert_short(fvalue * " + to_int16 + " + 0.5f);\n"
+                                  "    }\n"
+                                  "    return;\n"
+                                  "  }\n";
+        }
+        if( vector_width > 1 )
+            opencl_kernel_code += "  short" + vtype + " ivalue = vload" + vtype + "(0, x);\n";
+        else
+            opencl_kernel_code += "  short ivalue = *x;\n";
+        opencl_kernel_code += "  float" + vtype + " fvalue = " + chain.OpenCL( "convert_float" + vtype + "(ivalue) * " + to_float ) + ";\n";
+        std::string result = "convert_short" + vtype + "(fvalue * " + to_int16 + " + 0.5f)";
+        if( vector_width > 1 )
+            opencl_kernel_code += "  vstore" + vtype + "(" + result + ", 0, y);\n";
+        else
+            opencl_kernel_code += "  *y = " + result + ";\n";
+        opencl_kernel_code += "}\n";
+        strcpy( opencl_kernel_function_name, "elementwise" );
+        return VX_SUCCESS;
+    }
+};
+
+#endif
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+/*!
+ * \file   feature_redetector.h
+ * \brief  adaptive Harris re-detection for a keypoint tracker
+ *
+ * The image is divided into a grid of cells. After each optical flow step,
+ * Update() counts the keypoints still tracked in every cell, and runs Harris
+ * only on the cells that have fallen below a fraction of the keypoints they
+ * had when last detected. Each cell has its own small graph on an ROI of the
+ * gray image (vxCreateImageFromROI), so a frame that loses features in one
+ * corner pays for detection in that corner only. The surviving and the new
+ * keypoints are written back into the keypoint array, ready to be tracked.
+ */
+
+#ifndef __feature_redetector_h__
+#define __feature_redetector_h__
+
+#include <VX/vx.h>
+#include <vector>
+
+class CFeatureRedetector
+{
+public:
+    CFeatureRedetector()
+        : m_grid_x( 0 ), m_grid_y( 0 ), m_keep_ratio( 0 ), m_min_distance( 0 ),
+          m_capacity( 0 ), m_redetected_cells( 0 )
+    {
+    }
+
+    ~CFeatureRedetector()
+    {
+        Release();
+    }
+
+    // Set up one Harris graph per cell of a grid_x by grid_y grid on gray_image,
+    // which must be a non-virtual U8 image holding the frame being tracked. A
+    // cell is re-detected when fewer than keep_ratio of its keypoints survive.
+    vx_status Create( vx_context context, vx_image gray_image, vx_size max_keypoints,
+                      vx_uint32 grid_x, vx_uint32 grid_y, vx_float32 keep_ratio,
+                      vx_scalar strength_thresh, vx_scalar min_distance, vx_scalar sensitivity,
+                      vx_int32 gradient_size, vx_int32 block_size )
+    {
+        vx_uint32 width, height;
+        vx_status status = vxQueryImage( gray_image, VX_IMAGE_WIDTH, &width, sizeof( width ) );
+        if( status == VX_SUCCESS )
+        {
+            status = vxQueryImage( gray_image, VX_IMAGE_HEIGHT, &height, sizeof( height ) );
+        }
+        if( status == VX_SUCCESS )
+        {
+            status = vxCopyScalar( min_distance, &m_min_distance, VX_READ_ONLY, VX_MEMORY_TYPE_HOST );
+        }
+        if( status != VX_SUCCESS )
+        {
+            return status;
+        }
+        if( grid_x == 0 || grid_y == 0 || grid_x > width || grid_y > height )
+        {
+            return VX_ERROR_INVALID_PARAMETERS;
+        }
+
+        m_grid_x     = grid_x;
+        m_grid_y     = grid_y;
+        m_keep_ratio = keep_ratio;
+        m_capacity   = max_keypoints;
+        m_cells.resize( grid_x * grid_y );
+
+        // Grow each ROI by a margin so that corners near the edge of a cell
+        // are not lost to the border of the Harris window.
+        vx_uint32 margin = ( vx_uint32 )( gradient_size / 2 + block_size / 2 + 1 );
+        for( vx_uint32 cy = 0; cy < grid_y; cy++ )
+        {
+            for( vx_uint32 cx = 0; cx < grid_x; cx++ )
+            {
+                Cell & cell = m_cells[cy * grid_x + cx];
+                cell.rect.start_x = width  *  cx      / grid_x;
+                cell.rect.start_y = height *  cy      / grid_y;
+                cell.rect.end_x   = width  * ( cx + 1 ) / grid_x;
+                cell.rect.end_y   = height * ( cy + 1 ) / grid_y;
+                cell.roi_rect.start_x = cell.rect.start_x > margin ? cell.rect.start_x - margin : 0;
+                cell.roi_rect.start_y = cell.rect.start_y > margin ? cell.rect.start_y - margin : 0;
+                cell.roi_rect.end_x   = cell.rect.end_x + margin < width  ? cell.rect.end_x + margin : width;
+                cell.roi_rect.end_y   = cell.rect.end_y + margin < height ? cell.rect.end_y + margin : height;
+
+                cell.roi       = vxCreateImageFromROI( gray_image, &cell.roi_rect );
+                cell.keypoints = vxCreateArray( context, VX_TYPE_KEYPOINT, max_keypoints );
+                cell.graph     = vxCreateGraph( context );
+                status = vxGetStatus( ( vx_reference )cell.roi );
+                if( status == VX_SUCCESS )
+                {
+                    status = vxGetStatus( ( vx_reference )cell.keypoints );
+                }
+                if( status == VX_SUCCESS )
+                {
+                    status = vxGetStatus( ( vx_reference )cell.graph );
+                }
+                if( status == VX_SUCCESS )
+                {
+                    vx_node node = vxHarrisCornersNode( cell.graph, cell.roi, strength_thresh, min_distance,
+                                                        sensitivity, gradient_size, block_size,
+                                                        cell.keypoints, NULL );
+                    status = vxGetStatus( ( vx_reference )node );
+                    if( status == VX_SUCCESS )
+                    {
+                        status = vxReleaseNode( &node );
+                    }
+                }
+                if( status == VX_SUCCESS )
+                {
+                    status = vxVerifyGraph( cell.graph );
+                }
+                if( status != VX_SUCCESS )
+                {
+                    Release();
+                    return status;
+                }
+            }
+        }
+        return VX_SUCCESS;
+    }
+
+    // Take the keypoints from a full-frame detection as the reference count of each cell.
+    vx_status Reset( vx_array keypoints )
+    {
+        vx_status status = ReadKeypoints( keypoints );
+        if( status != VX_SUCCESS )
+        {
+            return status;
+        }
+        for( size_t i = 0; i < m_cells.size(); i++ )
+        {
+            m_cells[i].expected = m_cells[i].count;
+            m_cells[i].age      = 0;
+        }
+        return VX_SUCCESS;
+    }
+
+    // Drop the keypoints that optical flow lost, re-detect the cells that lost
+    // too many, and replace the contents of keypoints with the result.
+    vx_status Update( vx_array keypoints, vx_uint32 * cells_redetected )
+    {
+        vx_uint32 redetected = 0;
+        vx_status status = ReadKeypoints( keypoints );
+        for( size_t i = 0; status == VX_SUCCESS && i < m_cells.size(); i++ )
+        {
+            Cell & cell = m_cells[i];
+            cell.age++;
+            if( cell.expected == 0 ? cell.age < EMPTY_CELL_RETRY : cell.count >= m_keep_ratio * cell.expected )
+            {
+                continue;
+            }
+            status = vxProcessGraph( cell.graph );
+            if( status == VX_SUCCESS )
+            {
+                status = AddCellKeypoints( cell );
+            }
+            cell.expected = cell.count;
+            cell.age      = 0;
+            redetected++;
+        }
+        if( status == VX_SUCCESS )
+        {
+            status = vxTruncateArray( keypoints, 0 );
+        }
+        if( status == VX_SUCCESS && !m_points.empty() )
+        {
+            status = vxAddArrayItems( keypoints, m_points.size(), m_points.data(), sizeof( vx_keypoint_t ) );
+        }
+        m_redetected_cells += redetected;
+        if( cells_redetected )
+        {
+            *cells_redetected = redetected;
+        }
+        return status;
+    }
+
+    // Total number of cells re-detected since Create.
+    vx_size GetRedetectedCellCount()
+    {
+        return m_redetected_cells;
+    }
+
+    void Release()
+    {
+        for( size_t i = 0; i < m_cells.size(); i++ )
+        {
+            Cell & cell = m_cells[i];
+            if( cell.graph )
+            {
+                vxReleaseGraph( &cell.graph );
+            }
+            if( cell.keypoints )
+            {
+                vxReleaseArray( &cell.keypoints );
+            }
+            if( cell.roi )
+            {
+                vxReleaseImage( &cell.roi );
+            }
+        }
+        m_cells.clear();
+        m_points.clear();
+    }
+
+protected:
+    // A cell where Harris found nothing is searched again after this many frames.
+    enum { EMPTY_CELL_RETRY = 30 };
+
+    struct Cell
+    {
+        Cell() : roi( nullptr ), keypoints( nullptr ), graph( nullptr ), count( 0 ), expected( 0 ), age( 0 ) { }
+        vx_rectangle_t  rect;       // area of the image owned by the cell
+        vx_rectangle_t  roi_rect;   // area searched by Harris: rect plus a margin
+        vx_image        roi;
+        vx_array        keypoints;
+        vx_graph        graph;
+        vx_size         count;      // keypoints currently tracked in the cell
+        vx_size         expected;   // keypoints after the last detection in the cell
+        vx_uint32       age;        // frames since the last detection in the cell
+    };
+
+    vx_size CellIndex( vx_float32 x, vx_float32 y )
+    {
+        vx_uint32 width  = m_cells.back().rect.end_x;
+        vx_uint32 height = m_cells.back().rect.end_y;
+        vx_uint32 cx = x <= 0 ? 0 : ( vx_uint32 )x * m_grid_x / width;
+        vx_uint32 cy = y <= 0 ? 0 : ( vx_uint32 )y * m_grid_y / height;
+        return ( cy < m_grid_y ? cy : m_grid_y - 1 ) * m_grid_x + ( cx < m_grid_x ? cx : m_grid_x - 1 );
+    }
+
+    // Copy the keypoints that are still tracked into m_points and count them per cell.
+    vx_status ReadKeypoints( vx_array keypoints )
+    {
+        vx_size num_items = 0;
+        m_points.clear();
+        for( size_t i = 0; i < m_cells.size(); i++ )
+        {
+            m_cells[i].count = 0;
+        }
+        vx_status status = vxQueryArray( keypoints, VX_ARRAY_NUMITEMS, &num_items, sizeof( num_items ) );
+        if( status != VX_SUCCESS || num_items == 0 )
+        {
+            return status;
+        }
+        vx_size stride;
+        vx_map_id map_id;
+        vx_uint8 * buf;
+        status = vxMapArrayRange( keypoints, 0, num_items, &map_id, &stride, ( void ** )&buf,
+                                  VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0 );
+        if( status != VX_SUCCESS )
+        {
+            return status;
+        }
+        m_points.reserve( num_items );
+        for( vx_size i = 0; i < num_items; i++ )
+        {
+            const vx_keypoint_t * kp = ( const vx_keypoint_t * )( buf + i * stride );
+            if( kp->tracking_status )
+            {
+                m_points.push_back( *kp );
+                m_cells[CellIndex( ( vx_float32 )kp->x, ( vx_float32 )kp->y )].count++;
+            }
+        }
+        return vxUnmapArrayRange( keypoints, map_id );
+    }
+
+    // Append the corners Harris found inside the cell, skipping those closer
+    // than min_distance to a keypoint that is still being tracked there.
+    vx_status AddCellKeypoints( Cell & cell )
+    {
+        vx_size num_items = 0;
+        vx_status status = vxQueryArray( cell.keypoints, VX_ARRAY_NUMITEMS, &num_items, sizeof( num_items ) );
+        if( status != VX_SUCCESS || num_items == 0 )
+        {
+            return status;
+        }
+        vx_size stride;
+        vx_map_id map_id;
+        vx_uint8 * buf;
+        status = vxMapArrayRange( cell.keypoints, 0, num_items, &map_id, &stride, ( void ** )&buf,
+                                  VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0 );
+        if( status != VX_SUCCESS )
+        {
+            return status;
+        }
+        size_t tracked = m_points.size();
+        vx_float32 min_distance2 = m_min_distance * m_min_distance;
+        for( vx_size i = 0; i < num_items && m_points.size() < m_capacity; i++ )
+        {
+            vx_keypoint_t kp = *( const vx_keypoint_t * )( buf + i * stride );
+            kp.x += cell.roi_rect.start_x;
+            kp.y += cell.roi_rect.start_y;
+            if( kp.x < ( vx_int32 )cell.rect.start_x || kp.x >= ( vx_int32 )cell.rect.end_x ||
+                kp.y < ( vx_int32 )cell.rect.start_y || kp.y >= ( vx_int32 )cell.rect.end_y )
+            {
+                continue;
+            }
+            bool too_close = false;
+            for( size_t j = 0; j < tracked && !too_close; j++ )
+            {
+                vx_float32 dx = ( vx_float32 )( m_points[j].x - kp.x );
+                vx_float32 dy = ( vx_float32 )( m_points[j].y - kp.y );
+                too_close = dx * dx + dy * dy < min_distance2;
+            }
+            if( !too_close )
+            {
+                kp.tracking_status = 1;
+                m_points.push_back( kp );
+                cell.count++;
+            }
+        }
+        return vxUnmapArrayRange( cell.keypoints, map_id );
+    }
+
+    vx_uint32                   m_grid_x, m_grid_y;
+    vx_float32                  m_keep_ratio;
+    vx_float32                  m_min_distance;
+    vx_size                     m_capacity;
+    vx_size                     m_redetected_cells;
+    std::vector<Cell>           m_cells;
+    std::vector<vx_keypoint_t>  m_points;    // keypoints to be tracked from the next frame
+};
+
+#endif
@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+/*!
+ * \file   median_filter_u8.h
+ * \brief  self-contained median filter for U8 images
+ *
+ * Two paths, both replicating the edge pixels like cv::medianBlur:
+ *  - 3x3 and 5x5 run a sorting network of min/max operations on as many
+ *    pixels at a time as the vector registers hold. The instruction set is
+ *    chosen at compile time: AVX2 (32 pixels), SSE2 or NEON (16 pixels),
+ *    or plain C++ (1 pixel) when none of them is enabled.
+ *  - Larger kernels use the constant-time histogram algorithm of Perreault
+ *    and Hebert: one histogram per column, updated by one pixel in and one
+ *    out per row, and a kernel histogram that slides by one column in and
+ *    one out per pixel. Histograms are split into 16 coarse and 256 fine
+ *    bins, and a fine segment is only brought up to date when the median
+ *    falls into it, so the cost per pixel does not depend on ksize.
+ * The rows are split into bands that are filtered on the threads of
+ * CRowThreadPool.
+ */
+
+#ifndef __median_filter_u8_h__
+#define __median_filter_u8_h__
+
+#include <VX/vx.h>
+#include "row_thread_pool.h"
+#include <algorithm>
+#include <vector>
+#include <string.h>
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+#include <arm_neon.h>
+#endif
+
+class CMedianFilterU8
+{
+public:
+    // Filter a width x height U8 image from src into dst with a ksize x ksize
+    // median. ksize must be odd, from 3 to 255. The rows are split between
+    // num_threads threads; 0 uses one thread per processor core.
+    static vx_status Process( const vx_uint8 * src, vx_size src_stride,
+                              vx_uint8 * dst, vx_size dst_stride,
+                              vx_uint32 width, vx_uint32 height, vx_int32 ksize,
+                              vx_uint32 num_threads = 0 )
+    {
+        if( !src || !dst || ksize < 3 || ksize > 255 || ( ksize & 1 ) == 0 )
+        {
+            return VX_ERROR_INVALID_PARAMETERS;
+        }
+        if( width == 0 || height == 0 )
+        {
+            return VX_SUCCESS;
+        }
+        // Each band pays for filling its own line buffers or column histograms,
+        // so do not split the image into bands of fewer than MIN_BAND_ROWS rows.
+        const Band image = { src, src_stride, dst, dst_stride, width, height, ksize, 0, 0 };
+        CRowThreadPool::ForRows( height, width, [&image]( size_t y0, size_t y1 )
+        {
+            Band band = image;
+            band.y0 = ( vx_uint32 ) y0;
+            band.y1 = ( vx_uint32 ) y1;
+            ProcessBand( band );
+        }, num_threads, MIN_BAND_ROWS );
+        return VX_SUCCESS;
+    }
+
+protected:
+    enum { MIN_BAND_ROWS = 16 };
+
+    // Rows [y0, y1) of the image, filtered by one thread
+    struct Band
+    {
+        const vx_uint8 * src;
+        vx_size          src_stride;
+        vx_uint8 *       dst;
+        vx_size          dst_stride;
+        vx_uint32        width;
+        vx_uint32        height;
+        vx_int32         ksize;
+        vx_uint32        y0;
+        vx_uint32        y1;
+    };
+
+    ////////
+    // A vector of pixels with the operations needed by the sorting networks:
+    // unaligned load and store, and Sort( a, b ) which leaves the smaller
+    // value of every lane in a and the larger one in b.
+#if defined( __AVX2__ )
+    struct Vector
+    {
+        enum { LANES = 32 };
+        __m256i v;
+        static Vector Load( const vx_uint8 * ptr ) { Vector r; r.v = _mm256_loadu_si256( ( const __m256i * ) ptr ); return r; }
+        void Store( vx_uint8 * ptr ) const { _mm256_storeu_si256( ( __m256i * ) ptr, v ); }
+        static void Sort( Vector & a, Vector & b ) { __m256i t = _mm256_min_epu8( a.v, b.v ); b.v = _mm256_max_epu8( a.v, b.v ); a.v = t; }
+    };
+#elif defined( __SSE2__ ) || defined( _M_X64 )
+    struct Vector
+    {
+        enum { LANES = 16 };
+        __m128i v;
+        static Vector Load( const vx_uint8 * ptr ) { Vector r; r.v = _mm_loadu_si128( ( const __m128i * ) ptr ); return r; }
+        void Store( vx_uint8 * ptr ) const { _mm_storeu_si128( ( __m128i * ) ptr, v ); }
+        static void Sort( Vector & a, Vector & b ) { __m128i t = _mm_min_epu8( a.v, b.v ); b.v = _mm_max_epu8( a.v, b.v ); a.v = t; }
+    };
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+    struct Vector
+    {
+        enum { LANES = 16 };
+        uint8x16_t v;
+        static Vector Load( const vx_uint8 * ptr ) { Vector r; r.v = vld1q_u8( ptr ); return r; }
+        void Store( vx_uint8 * ptr ) const { vst1q_u8( ptr, v ); }
+        static void Sort( Vector & a, Vector & b ) { uint8x16_t t = vminq_u8( a.v, b.v ); b.v = vmaxq_u8( a.v, b.v ); a.v = t; }
+    };
+#endif
+
+    // One pixel at a time: the whole image without SIMD, or the last few
+    // pixels of rows narrower than a vector.
+    struct Pixel
+    {
+        enum { LANES = 1 };
+        vx_uint8 v;
+        static Pixel Load( const vx_uint8 * ptr ) { Pixel r; r.v = *ptr; return r; }
+        void Store( vx_uint8 * ptr ) const { *ptr = v; }
+        static void Sort( Pixel & a, Pixel & b ) { vx_uint8 t = std::min( a.v, b.v ); b.v = std::max( a.v, b.v ); a.v = t; }
+    };
+
+#if !defined( __AVX2__ ) && !defined( __SSE2__ ) && !defined( _M_X64 ) && !defined( __ARM_NEON ) && !defined( __ARM_NEON__ )
+    typedef Pixel Vector;
+#endif
+
+    ////////
+    // The comparators of a sorting network for 25 values that are needed to
+    // find the median (index 12). The network is Batcher's merge exchange
+    // (Knuth, TAOCP vol. 3, algorithm 5.2.2M), and comparators that cannot
+    // change the value that ends up at index 12 are dropped, walking the
+    // network backwards from that index.
+    struct Comparator { vx_uint8 a, b; };
+
+    static const std::vector< Comparator > & Median25Network()
+    {
+        static const std::vector< Comparator > network = BuildMedianNetwork( 25 );
+        return network;
+    }
+
+    static std::vector< Comparator > BuildMedianNetwork( int n )
+    {
+        std::vector< Comparator > sort;
+        int t = 0;
+        while( ( 1 << t ) < n )
+        {
+            t++;
+        }
+        for( int p = 1 << ( t - 1 ); p > 0; p >>= 1 )
+        {
+            int q = 1 << ( t - 1 ), r = 0, d = p;
+            for( ;; )
+            {
+                for( int i = 0; i < n - d; i++ )
+                {
+                    if( ( i & p ) == r )
+                    {
+                        Comparator c = { ( vx_uint8 ) i, ( vx_uint8 ) ( i + d ) };
+                        sort.push_back( c );
+                    }
+                }
+                if( q == p )
+                {
+                    break;
+                }
+                d = q - p;
+                q >>= 1;
+                r = p;
+            }
+        }
+
+        std::vector< bool > needed( n, false );
+        needed[n / 2] = true;
+        std::vector< Comparator > median;
+        for( size_t i = sort.size(); i-- > 0; )
+        {
+            if( needed[sort[i].a] || needed[sort[i].b] )
+            {
+                needed[sort[i].a] = needed[sort[i].b] = true;
+                median.push_back( sort[i] );
+            }
+        }
+        std::reverse( median.begin(), median.end() );
+        return median;
+    }
+
+    // Median of the 3x3 or 5x5 neighborhoods of the T::LANES pixels starting
+    // at column x of out. rows[] point at the ksize padded input rows, whose
+    // element 0 is column -ksize/2 of the image.
+    template< class T >
+    static void FilterNetwork( const vx_uint8 * const * rows, vx_int32 ksize, vx_uint32 x, vx_uint8 * out )
+    {
+        T p[25];
+        int n = 0;
+        for( int dy = 0; dy < ksize; dy++ )
+        {
+            for( int dx = 0; dx < ksize; dx++ )
+            {
+                p[n++] = T::Load( rows[dy] + x + dx );
+            }
+        }
+        if( ksize == 3 )
+        {
+            // The 19 comparator median of 9 values (Paeth)
+            T::Sort( p[1], p[2] ); T::Sort( p[4], p[5] ); T::Sort( p[7], p[8] );
+            T::Sort( p[0], p[1] ); T::Sort( p[3], p[4] ); T::Sort( p[6], p[7] );
+            T::Sort( p[1], p[2] ); T::Sort( p[4], p[5] ); T::Sort( p[7], p[8] );
+            T::Sort( p[0], p[3] ); T::Sort( p[5], p[8] ); T::Sort( p[4], p[7] );
+            T::Sort( p[3], p[6] ); T::Sort( p[1], p[4] ); T::Sort( p[2], p[5] );
+            T::Sort( p[4], p[7] ); T::Sort( p[4], p[2] ); T::Sort( p[6], p[4] );
+            T::Sort( p[4], p[2] );
+            p[4].Store( out + x );
+        }
+        else
+        {
+            const std::vector< Comparator > & network = Median25Network();
+            for( const Comparator & c : network )
+            {
+                T::Sort( p[c.a], p[c.b] );
+            }
+            p[12].Store( out + x );
+        }
+    }
+
+    static void ProcessBand( Band band )
+    {
+        if( band.ksize <= 5 )
+        {
+            ProcessBandNetwork( band );
+        }
+        else
+        {
+            ProcessBandHistogram( band );
+        }
+    }
+
+    static vx_uint32 Clamp( vx_int64 value, vx_uint32 size )
+    {
+        return ( vx_uint32 ) std::min< vx_int64 >( std::max< vx_int64 >( value, 0 ), size - 1 );
+    }
+
+    static void ProcessBandNetwork( const Band & band )
+    {
+        // Keep ksize input rows, padded with ksize/2 replicated pixels on both
+        // sides, in a ring indexed by row number, so that each output row only
+        // pads the one input row that enters the neighborhood.
+        const vx_int32  radius = band.ksize / 2;
+        const vx_uint32 padded_width = band.width + 2 * radius;
+        std::vector< vx_uint8 >  lines( band.ksize * padded_width );
+        std::vector< vx_uint32 > line_row( band.ksize, ~0u );
+        const vx_uint8 * rows[5];
+        for( vx_uint32 y = band.y0; y < band.y1; y++ )
+        {
+            for( vx_int32 dy = -radius; dy <= radius; dy++ )
+            {
+                vx_int64  row  = ( vx_int64 ) y + dy;
+                vx_uint32 slot = ( vx_uint32 )( ( row + band.ksize ) % band.ksize );
+                vx_uint32 src_row = Clamp( row, band.height );
+                vx_uint8 * line = &lines[slot * padded_width];
+                if( line_row[slot] != src_row )
+                {
+                    const vx_uint8 * src = band.src + src_row * band.src_stride;
+                    memset( line, src[0], radius );
+                    memcpy( line + radius, src, band.width );
+                    memset( line + radius + band.width, src[band.width - 1], radius );
+                    line_row[slot] = src_row;
+                }
+                rows[dy + radius] = line;
+            }
+
+            vx_uint8 * out = band.dst + y * band.dst_stride;
+            vx_uint32 x = 0;
+            for( ; x + Vector::LANES <= band.width; x += Vector::LANES )
+            {
+                FilterNetwork< Vector >( rows, band.ksize, x, out );
+            }
+            if( x < band.width )
+            {
+                if( band.width >= ( vx_uint32 ) Vector::LANES )
+                {
+                    // Redo the last full vector of the row rather than finish it
+                    // one pixel at a time
+                    FilterNetwork< Vector >( rows, band.ksize, band.width - Vector::LANES, out );
+                }
+                else
+                {
+                    for( ; x < band.width; x++ )
+                    {
+                        FilterNetwork< Pixel >( rows, band.ksize, x, out );
+                    }
+                }
+            }
+        }
+    }
+
+    static void ProcessBandHistogram( const Band & band )
+    {
+        // Column histograms cover padded columns, where padded column px is
+        // image column px - radius, clamped. A count never exceeds ksize, and
+        // the kernel histogram never exceeds ksize * ksize, so 16 bits are
+        // enough for ksize up to 255.
+        const vx_int32  ksize  = band.ksize;
+        const vx_int32  radius = ksize / 2;
+        const vx_uint32 padded_width = band.width + 2 * radius;
+        const vx_int32  rank = ksize * ksize / 2;
+        std::vector< vx_uint16 > column_coarse( padded_width * 16, 0 );
+        std::vector< vx_uint16 > column_fine( padded_width * 256, 0 );
+        std::vector< vx_uint32 > src_x( padded_width );
+        for( vx_uint32 px = 0; px < padded_width; px++ )
+        {
+            src_x[px] = Clamp( ( vx_int64 ) px - radius, band.width );
+        }
+
+        for( vx_int32 dy = -radius; dy <= radius; dy++ )
+        {
+            const vx_uint8 * src = band.src + Clamp( ( vx_int64 ) band.y0 + dy, band.height ) * band.src_stride;
+            for( vx_uint32 px = 0; px < padded_width; px++ )
+            {
+                vx_uint8 v = src[src_x[px]];
+                column_coarse[px * 16 + ( v >> 4 )]++;
+                column_fine[px * 256 + v]++;
+            }
+        }
+
+        for( vx_uint32 y = band.y0; y < band.y1; y++ )
+        {
+            if( y > band.y0 )
+            {
+                const vx_uint8 * src_out = band.src + Clamp( ( vx_int64 ) y - radius - 1, band.height ) * band.src_stride;
+                const vx_uint8 * src_in  = band.src + Clamp( ( vx_int64 ) y + radius, band.height ) * band.src_stride;
+                for( vx_uint32 px = 0; px < padded_width; px++ )
+                {
+                    vx_uint8 v_out = src_out[src_x[px]];
+                    vx_uint8 v_in  = src_in[src_x[px]];
+                    column_coarse[px * 16 + ( v_out >> 4 )]--;
+                    column_fine[px * 256 + v_out]--;
+                    column_coarse[px * 16 + ( v_in >> 4 )]++;
+                    column_fine[px * 256 + v_in]++;
+                }
+            }
+
+            // The kernel histogram of output column x is the sum of padded
+            // columns x to x + ksize - 1. fine_column[b] is the output column
+            // for which the fine bins of coarse bin b were last summed.
+            vx_uint16 coarse[16] = { 0 };
+            vx_uint16 fine[16][16];
+            vx_int32  fine_column[16];
+            for( vx_int32 b = 0; b < 16; b++ )
+            {
+                fine_column[b] = -ksize;
+            }
+            for( vx_int32 px = 0; px < ksize; px++ )
+            {
+                const vx_uint16 * column = &column_coarse[px * 16];
+                for( vx_int32 b = 0; b < 16; b++ )
+                {
+                    coarse[b] += column[b];
+                }
+            }
+
+            vx_uint8 * out = band.dst + y * band.dst_stride;
+            for( vx_int32 x = 0; x < ( vx_int32 ) band.width; x++ )
+            {
+                if( x > 0 )
+                {
+                    const vx_uint16 * column_in  = &column_coarse[( x + ksize - 1 ) * 16];
+                    const vx_uint16 * column_out = &column_coarse[( x - 1 ) * 16];
+                    for( vx_int32 b = 0; b < 16; b++ )
+                    {
+                        coarse[b] += column_in[b] - column_out[b];
+                    }
+                }
+
+                vx_int32 count = 0, b = 0;
+                while( count + coarse[b] <= rank )
+                {
+                    count += coarse[b++];
+                }
+
+                vx_uint16 * bins = fine[b];
+                if( fine_column[b] <= x - ksize )
+                {
+                    // No column in common with the last update: sum from scratch
+                    memset( bins, 0, sizeof( fine[b] ) );
+                    for( vx_int32 px = x; px < x + ksize; px++ )
+                    {
+                        const vx_uint16 * column = &column_fine[px * 256 + b * 16];
+                        for( vx_int32 i = 0; i < 16; i++ )
+                        {
+                            bins[i] += column[i];
+                        }
+                    }
+                }
+                else
+                {
+                    for( vx_int32 px = fine_column[b]; px < x; px++ )
+                    {
+                        const vx_uint16 * column_in  = &column_fine[( px + ksize ) * 256 + b * 16];
+                        const vx_uint16 * column_out = &column_fine[px * 256 + b * 16];
+                        for( vx_int32 i = 0; i < 16; i++ )
+                        {
+                            bins[i] += column_in[i] - column_out[i];
+                        }
+                    }
+                }
+                fine_column[b] = x;
+
+                vx_int32 i = 0;
+                while( count + bins[i] <= rank )
+                {
+                    count += bins[i++];
+                }
+                out[x] = ( vx_uint8 )( b * 16 + i );
+            }
+        }
+    }
+};
+
+#endif
@@ -42,9 +42,47 @@
 #define DEFAULT_WAITKEY_DELAY  1  /* waitKey delay time in milliseconds after each frame processing */
 #endif
 
+#ifndef ENABLE_BENCHMARK
+#define ENABLE_BENCHMARK       0  /* headless timing run: no drawing, no display, no keyboard */
+#endif
+
+#ifndef BENCHMARK_FRAMES
+#define BENCHMARK_FRAMES       0  /* number of frames to time in benchmark mode (0: whole sequence) */
+#endif
+
+#ifndef BENCHMARK_WARMUP
+#define BENCHMARK_WARMUP       10 /* number of frames processed before timing starts in benchmark mode */
+#endif
+
 #ifndef ENABLE_DISPLAY
+#if ENABLE_BENCHMARK
+#define ENABLE_DISPLAY         0
+#else
 #define ENABLE_DISPLAY         1  /* display results using OpenCV GUI */
 #endif
+#endif
+
+#ifndef ENABLE_BGR_INGEST
+#define ENABLE_BGR_INGEST      0  /* skip BGR to RGB conversion; use GetBufferBGR and swap channels in the graph */
+#endif
+
+#ifndef CAPTURE_THREAD_DEPTH
+#define CAPTURE_THREAD_DEPTH   0  /* frames decoded ahead on a capture thread (0: decode inside Grab) */
+#endif
+
+#if CAPTURE_THREAD_DEPTH > 0
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+#endif
+
+#if ENABLE_BENCHMARK
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
+#endif
 
 class CGuiModule
 {
@@ -59,6 +97,7 @@ public:
             printf( "ERROR: unable to open: %s\n", captureFile );
             exit( 1 );
         }
+        StartCapture( false );
         printf( "OK: FILE %s %dx%d\n", captureFile, GetWidth(), GetHeight());
 #if ENABLE_DISPLAY
         cv::namedWindow(m_windowName);
@@ -75,15 +114,37 @@ public:
             printf( "ERROR: CAMERA#%d not available\n", captureDevice );
             exit( 1 );
         }
+        StartCapture( true );
         printf( "OK: CAMERA#%d %dx%d\n", captureDevice, GetWidth(), GetHeight());
 #if ENABLE_DISPLAY
         cv::namedWindow(m_windowName);
 #endif
     }
 
+    ~CGuiModule()
+    {
+#if CAPTURE_THREAD_DEPTH > 0
+        {
+            std::lock_guard<std::mutex>  lock( m_lock );
+            m_stop = true;
+        }
+        m_emptied.notify_all();
+        if( m_thread.joinable() )
+        {
+            m_thread.join();
+        }
+        printf( "OK: capture thread decoded %lu frames, dropped %lu\n", m_decoded, m_dropped );
+#endif
+#if ENABLE_BENCHMARK
+        std::vector<CGuiModule *> &  pending = PendingBenchmarks();
+        pending.erase( std::remove( pending.begin(), pending.end(), this ), pending.end() );
+        PrintBenchmark();
+#endif
+    }
+
     int GetWidth()
     {
-        return (int) m_cap.get( cv::CAP_PROP_FRAME_WIDTH );
+        return m_width;
     }
 
     int GetHeight()
@@ -91,10 +152,11 @@ public:
 #if 1 // TBD: workaround for reported OpenCV+Windows bug that returns width instead of height
 		return 480;
 #else
-        return (int) m_cap.get( cv::CAP_PROP_FRAME_HEIGHT );
+        return m_height;
 #endif
     }
 
+    // RGB copy of the frame: not available when ENABLE_BGR_INGEST is set.
     int GetStride()
     {
         return (int) m_imgRGB.step;
@@ -105,34 +167,69 @@ public:
         return m_imgRGB.data;
     }
 
+    // Frame as decoded, in BGR order. The buffer can change on every Grab.
+    int GetStrideBGR()
+    {
+        return (int) m_imgBGR.step;
+    }
+
+    unsigned char * GetBufferBGR()
+    {
+        return m_imgBGR.data;
+    }
+
     bool Grab()
     {
-        m_cap >> m_imgBGR;
-        if( m_imgBGR.empty() )
+        bool  ok = GrabFrame();
+#if ENABLE_BENCHMARK
+        if( !ok )
         {
-            return false;
+            EndFrame();
         }
-        cv::cvtColor( m_imgBGR, m_imgRGB, cv::COLOR_BGR2RGB );
-        return true;
+#endif
+        return ok;
+    }
+
+    // Number of frames decoded from the input so far, and the number of those
+    // that the capture thread overwrote before Grab could take them (camera only).
+    unsigned long GetDecodedCount()
+    {
+#if CAPTURE_THREAD_DEPTH > 0
+        std::lock_guard<std::mutex>  lock( m_lock );
+#endif
+        return m_decoded;
+    }
+
+    unsigned long GetDroppedCount()
+    {
+#if CAPTURE_THREAD_DEPTH > 0
+        std::lock_guard<std::mutex>  lock( m_lock );
+#endif
+        return m_dropped;
     }
 
     void DrawText( int x, int y, const char * text )
     {
+#if !ENABLE_BENCHMARK
         cv::putText( m_imgBGR, text, cv::Point( x, y ),
                      cv::FONT_HERSHEY_COMPLEX_SMALL, 0.8, cv::Scalar( 128, 0, 0 ), 1, cv::LineTypes::LINE_AA );
 #if !ENABLE_DISPLAY
         printf("text: %s\n", text);
+#endif
 #endif
     }
 
     void DrawPoint( int x, int y )
     {
+#if !ENABLE_BENCHMARK
         cv::Point  center( x, y );
         cv::circle( m_imgBGR, center, 1, cv::Scalar( 0, 0, 255 ), 2 );
+#endif
     }
 
     void DrawArrow( int x0, int y0, int x1, int y1 )
     {
+#if !ENABLE_BENCHMARK
         DrawPoint( x0, y0 );
         float  dx = (float) ( x1 - x0 ), dy = (float) ( y1 - y0 ), arrow_len = sqrtf( dx * dx + dy * dy );
         if(( arrow_len >= 3.0f ) && ( arrow_len <= 50.0f ) )
@@ -143,6 +240,7 @@ public:
             cv::line( m_imgBGR, cv::Point( x1, y1 ), cv::Point( x1 - (int) ( tip_len * cosf( angle + (float) CV_PI / 6 )), y1 - (int) ( tip_len * sinf( angle + (float) CV_PI / 6 ))), color, 1 );
             cv::line( m_imgBGR, cv::Point( x1, y1 ), cv::Point( x1 - (int) ( tip_len * cosf( angle - (float) CV_PI / 6 )), y1 - (int) ( tip_len * sinf( angle - (float) CV_PI / 6 ))), color, 1 );
         }
+#endif
     }
 
     void Show()
@@ -154,6 +252,18 @@ public:
 
     bool AbortRequested()
     {
+#if ENABLE_BENCHMARK
+        // Called at the start of every frame: close the timing of the previous
+        // frame and stop once BENCHMARK_FRAMES frames have been timed.
+        EndFrame();
+        if(( BENCHMARK_FRAMES > 0 ) && ( (int) m_frameTimes.size() >= BENCHMARK_FRAMES ))
+        {
+            return true;
+        }
+        m_frameStart   = std::chrono::steady_clock::now();
+        m_frameStarted = true;
+        return false;
+#elif ENABLE_DISPLAY
         char  key = cv::waitKey( DEFAULT_WAITKEY_DELAY );
         if( key == ' ' )
         {
@@ -164,6 +274,9 @@ public:
             return true;
         }
         return false;
+#else
+        return false;
+#endif
     }
 
     void WaitForKey()
@@ -174,10 +287,220 @@ public:
     }
 
 protected:
+    bool GrabFrame()
+    {
+#if CAPTURE_THREAD_DEPTH > 0
+        // Take the oldest decoded frame out of the ring and give the buffers
+        // of the previous frame back to the capture thread in its place.
+        std::unique_lock<std::mutex>  lock( m_lock );
+        while( m_count == 0 && !m_finished )
+        {
+            m_filled.wait( lock );
+        }
+        if( m_count == 0 )
+        {
+            return false;
+        }
+        std::swap( m_imgBGR, m_ring[m_tail].bgr );
+#if !ENABLE_BGR_INGEST
+        std::swap( m_imgRGB, m_ring[m_tail].rgb );
+#endif
+        m_tail = ( m_tail + 1 ) % CAPTURE_THREAD_DEPTH;
+        m_count--;
+        m_emptied.notify_one();
+        return true;
+#else
+        m_cap >> m_imgBGR;
+        if( m_imgBGR.empty() )
+        {
+            return false;
+        }
+#if !ENABLE_BGR_INGEST
+        cv::cvtColor( m_imgBGR, m_imgRGB, cv::COLOR_BGR2RGB );
+#endif
+        m_decoded++;
+        return true;
+#endif
+    }
+
+    void StartCapture( bool live )
+    {
+        // cv::VideoCapture is not thread-safe, so query it before the capture thread owns it.
+        m_width   = (int) m_cap.get( cv::CAP_PROP_FRAME_WIDTH );
+        m_height  = (int) m_cap.get( cv::CAP_PROP_FRAME_HEIGHT );
+        m_live    = live;
+        m_decoded = 0;
+        m_dropped = 0;
+#if ENABLE_BENCHMARK
+        m_frameStarted = false;
+        m_warmupFrames = 0;
+        if( BENCHMARK_FRAMES > 0 )
+        {
+            m_frameTimes.reserve( BENCHMARK_FRAMES );
+        }
+        // The ERROR_CHECK macros of the exercises call exit(), which skips the
+        // destructor: print the frames timed so far from an atexit handler then.
+        // The list is created first so that it is destroyed after the handler ran.
+        std::vector<CGuiModule *> &  pending = PendingBenchmarks();
+        static bool  registered = atexit( PrintPendingBenchmarks ) == 0;
+        (void) registered;
+        pending.push_back( this );
+#endif
+#if CAPTURE_THREAD_DEPTH > 0
+        m_head     = 0;
+        m_tail     = 0;
+        m_count    = 0;
+        m_finished = false;
+        m_stop     = false;
+        m_thread   = std::thread( &CGuiModule::CaptureFrames, this );
+#endif
+    }
+
+#if ENABLE_BENCHMARK
+    // A frame is timed from one AbortRequested to the next (or to the Grab
+    // that finds the end of the sequence), so it covers the processing of
+    // the frame and the Grab of the next one. Warmup frames are not kept.
+    void EndFrame()
+    {
+        if( m_frameStarted )
+        {
+            std::chrono::duration<double, std::milli>  elapsed = std::chrono::steady_clock::now() - m_frameStart;
+            if( m_warmupFrames < BENCHMARK_WARMUP )
+            {
+                m_warmupFrames++;
+            }
+            else
+            {
+                m_frameTimes.push_back( elapsed.count() );
+            }
+            m_frameStarted = false;
+        }
+    }
+
+    // Modules whose benchmark has not been printed by their destructor yet
+    static std::vector<CGuiModule *> & PendingBenchmarks()
+    {
+        static std::vector<CGuiModule *>  pending;
+        return pending;
+    }
+
+    static void PrintPendingBenchmarks()
+    {
+        std::vector<CGuiModule *> &  pending = PendingBenchmarks();
+        for( size_t i = 0; i < pending.size(); i++ )
+        {
+            printf( "BENCHMARK: %s stopped before the end of the run\n", pending[i]->m_windowName.c_str() );
+            pending[i]->PrintBenchmark();
+        }
+        pending.clear();
+    }
+
+    void PrintBenchmark()
+    {
+        size_t  count = m_frameTimes.size();
+        double  total = 0;
+        for( size_t i = 0; i < count; i++ )
+        {
+            printf( "FRAME %6d %9.3f ms\n", (int) i, m_frameTimes[i] );
+            total += m_frameTimes[i];
+        }
+        if( count == 0 )
+        {
+            printf( "BENCHMARK: no frames timed after %d warmup frames\n", m_warmupFrames );
+            return;
+        }
+        std::vector<double>  sorted( m_frameTimes );
+        std::sort( sorted.begin(), sorted.end() );
+        printf( "BENCHMARK: %d frames (after %d warmup) Avg(ms) Min(ms) P50(ms) P95(ms) Max(ms) FPS\n"
+                "BENCHMARK: %7.3f %7.3f %7.3f %7.3f %7.3f %7.2f\n",
+                (int) count, m_warmupFrames, total / count, sorted[0], sorted[count / 2],
+                sorted[( count * 95 ) / 100 < count ? ( count * 95 ) / 100 : count - 1], sorted[count - 1],
+                total > 0 ? count * 1000.0 / total : 0.0 );
+    }
+#endif
+
+#if CAPTURE_THREAD_DEPTH > 0
+    // Capture thread: decode and convert each frame into its own buffers, then
+    // swap them into the ring. A file waits for Grab when the ring is full; a
+    // camera keeps running and overwrites the oldest frame instead.
+    void CaptureFrames()
+    {
+        cv::Mat  bgr, rgb;
+        std::unique_lock<std::mutex>  lock( m_lock );
+        while( !m_stop )
+        {
+            lock.unlock();
+            m_cap >> bgr;
+            bool  ok = !bgr.empty();
+#if !ENABLE_BGR_INGEST
+            if( ok )
+            {
+                cv::cvtColor( bgr, rgb, cv::COLOR_BGR2RGB );
+            }
+#endif
+            lock.lock();
+            if( !ok )
+            {
+                break;
+            }
+            m_decoded++;
+            while( !m_stop && !m_live && m_count == CAPTURE_THREAD_DEPTH )
+            {
+                m_emptied.wait( lock );
+            }
+            if( m_stop )
+            {
+                break;
+            }
+            if( m_count == CAPTURE_THREAD_DEPTH )
+            {
+                m_tail = ( m_tail + 1 ) % CAPTURE_THREAD_DEPTH;
+                m_count--;
+                m_dropped++;
+            }
+            std::swap( bgr, m_ring[m_head].bgr );
+#if !ENABLE_BGR_INGEST
+            std::swap( rgb, m_ring[m_head].rgb );
+#endif
+            m_head = ( m_head + 1 ) % CAPTURE_THREAD_DEPTH;
+            m_count++;
+            m_filled.notify_one();
+        }
+        m_finished = true;
+        m_filled.notify_all();
+    }
+#endif
+
     std::string       m_windowName;
     cv::VideoCapture  m_cap;
     cv::Mat           m_imgBGR;
     cv::Mat           m_imgRGB;
+    int               m_width;
+    int               m_height;
+    bool              m_live;
+    unsigned long     m_decoded;
+    unsigned long     m_dropped;
+#if ENABLE_BENCHMARK
+    std::chrono::steady_clock::time_point  m_frameStart;
+    bool                                   m_frameStarted;
+    int                                    m_warmupFrames;
+    std::vector<double>                    m_frameTimes;   // milliseconds per timed frame
+#endif
+#if CAPTURE_THREAD_DEPTH > 0
+    struct CaptureSlot
+    {
+        cv::Mat  bgr;
+        cv::Mat  rgb;
+    };
+    CaptureSlot              m_ring[CAPTURE_THREAD_DEPTH];
+    int                      m_head, m_tail, m_count;   // next slot to fill, next slot to grab, filled slots
+    bool                     m_finished;
+    bool                     m_stop;
+    std::mutex               m_lock;
+    std::condition_variable  m_filled;
+    std::condition_variable  m_emptied;
+    std::thread              m_thread;
+#endif
 };
 
 #endif
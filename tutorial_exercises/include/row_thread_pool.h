@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+
+/*!
+ * \file   row_thread_pool.h
+ * \brief  persistent thread pool that splits the rows of a CPU kernel into bands
+ *
+ * CRowThreadPool::ForRows( num_rows, row_elements, function ) runs
+ * function( begin, end ) on bands of the rows [0, num_rows), one band per
+ * thread, with the calling thread taking part. The worker threads are started
+ * once, on first use, and wait for work between calls, so a node that runs
+ * every frame does not create and join threads every time.
+ *
+ * A band is not split off for less than MIN_BAND_ELEMENTS elements. When the
+ * pool is already busy with a call from another thread, for example a node of
+ * another graph running at the same time, the caller processes all the rows
+ * itself: the cores are taken anyway.
+ *
+ * Only the standard library is used, so the header also serves the samples
+ * that do not include OpenVX.
+ */
+
+#ifndef __row_thread_pool_h__
+#define __row_thread_pool_h__
+
+#include <stddef.h>
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CRowThreadPool
+{
+public:
+    enum { MIN_BAND_ELEMENTS = 16384 };
+
+    // Run function( begin, end ) on bands of [0, num_rows) of row_elements
+    // elements each. num_threads of 0 uses one thread per processor core, and
+    // min_band_rows lets a caller with a setup cost per band ask for taller bands.
+    template< class Function >
+    static void ForRows( size_t num_rows, size_t row_elements, const Function & function,
+                         unsigned num_threads = 0, size_t min_band_rows = 1 )
+    {
+        CRowThreadPool & pool = Instance();
+        size_t max_bands = std::min( num_rows / std::max< size_t >( min_band_rows, 1 ),
+                                     num_rows * row_elements / MIN_BAND_ELEMENTS );
+        if( num_threads == 0 || num_threads > pool.m_workers.size() + 1 )
+        {
+            num_threads = ( unsigned )( pool.m_workers.size() + 1 );
+        }
+        size_t num_bands = std::min< size_t >( num_threads, max_bands );
+        std::unique_lock< std::mutex > busy( pool.m_busy, std::defer_lock );
+        if( num_bands < 2 || !busy.try_lock() )
+        {
+            function( 0, num_rows );
+            return;
+        }
+        Job job = std::cref( function );
+        pool.Run( job, num_rows, num_bands );
+    }
+
+protected:
+    typedef std::function< void( size_t, size_t ) > Job;
+
+    static CRowThreadPool & Instance()
+    {
+        static CRowThreadPool pool;
+        return pool;
+    }
+
+    CRowThreadPool()
+        : m_job( NULL ), m_num_rows( 0 ), m_num_bands( 0 ), m_next_band( 0 ), m_done_bands( 0 ),
+          m_generation( 0 ), m_stop( false )
+    {
+        unsigned num_threads = std::max( 1u, std::thread::hardware_concurrency() );
+        for( unsigned i = 1; i < num_threads; i++ )
+        {
+            m_workers.push_back( std::thread( &CRowThreadPool::Work, this ) );
+        }
+    }
+
+    ~CRowThreadPool()
+    {
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for( std::thread & worker : m_workers )
+        {
+            worker.join();
+        }
+    }
+
+    // Publish a job to the workers, take part in it, and wait for all its bands
+    void Run( const Job & job, size_t num_rows, size_t num_bands )
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        m_job        = &job;
+        m_num_rows   = num_rows;
+        m_num_bands  = num_bands;
+        m_next_band  = 0;
+        m_done_bands = 0;
+        m_generation++;
+        m_wake.notify_all();
+        RunBands( lock );
+        m_done.wait( lock, [this] { return m_done_bands == m_num_bands; } );
+        m_job = NULL;
+    }
+
+    // Process the bands of the current job that nobody has taken yet; the lock
+    // is held on entry and on return, and released while a band runs
+    void RunBands( std::unique_lock< std::mutex > & lock )
+    {
+        while( m_job && m_next_band < m_num_bands )
+        {
+            const Job & job = *m_job;
+            size_t band  = m_next_band++;
+            size_t begin = m_num_rows * band / m_num_bands;
+            size_t end   = m_num_rows * ( band + 1 ) / m_num_bands;
+            lock.unlock();
+            job( begin, end );
+            lock.lock();
+            if( ++m_done_bands == m_num_bands )
+            {
+                m_done.notify_one();
+            }
+        }
+    }
+
+    void Work()
+    {
+        unsigned long long generation = 0;
+        std::unique_lock< std::mutex > lock( m_mutex );
+        for( ;; )
+        {
+            m_wake.wait( lock, [&] { return m_stop || m_generation != generation; } );
+            if( m_stop )
+            {
+                return;
+            }
+            generation = m_generation;
+            RunBands( lock );
+        }
+    }
+
+    std::vector< std::thread > m_workers;
+    std::mutex                 m_busy;       // held by the caller whose job the pool runs
+    std::mutex                 m_mutex;      // guards everything below
+    std::condition_variable    m_wake;
+    std::condition_variable    m_done;
+    const Job *                m_job;
+    size_t                     m_num_rows;
+    size_t                     m_num_bands;
+    size_t                     m_next_band;
+    size_t                     m_done_bands;
+    unsigned long long         m_generation;
+    bool                       m_stop;
+};
+
+#endif
@@ -0,0 +1,583 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+/*!
+ * \file   tensor_image_convert.h
+ * \brief  user kernels converting between RGB images and planar Q-format tensors
+ *
+ * Two user kernels, so that the conversions of exercises 3 and 4 run inside
+ * the graph, next to the tensor nodes, instead of in a host loop:
+ *
+ *   app.userkernels.image_to_tensor
+ *     parameter #0  --  input image of format VX_DF_IMAGE_RGB (width x height)
+ *     parameter #1  --  output tensor of format VX_TYPE_INT16 [width x height x 3]
+ *     parameter #2  --  scalar VX_TYPE_FLOAT32 scale
+ *     parameter #3  --  scalar VX_TYPE_FLOAT32 offset
+ *     parameter #4  --  scalar VX_TYPE_UINT32 channel order (TENSOR_IMAGE_CHANNEL_ORDER_RGB or _BGR)
+ *   tensor value = pixel * scale + offset, in the fixed-point position of the tensor
+ *
+ *   app.userkernels.tensor_to_image
+ *     parameter #0  --  input tensor of format VX_TYPE_INT16 [width x height x 3]
+ *     parameter #1  --  output image of format VX_DF_IMAGE_RGB (width x height)
+ *     parameters #2 to #4 as above
+ *   pixel = tensor value * scale + offset, saturated to 0..255
+ *
+ * Values are rounded to nearest even and saturated. With the BGR channel
+ * order, tensor channel 0 is the last byte of each pixel, so a BGR buffer
+ * from OpenCV can be copied into the RGB image as is, and the output image
+ * can be displayed by OpenCV without conversion.
+ *
+ * On the CPU, each kernel precomputes the conversion of every possible
+ * input value (256 pixels or 65536 tensor values) and looks it up, with the
+ * rows split between the threads of CRowThreadPool. With use_opencl, they also register AMD
+ * OpenCL code generation callbacks: the framework passes an image to the
+ * OpenCL kernel as (uint width, uint height, __global uchar * buf, uint
+ * stride, uint offset), a tensor as (__global uchar * buf, uint offset,
+ * uint4 stride), and a scalar by value.
+ */
+
+#ifndef __tensor_image_convert_h__
+#define __tensor_image_convert_h__
+
+#include <VX/vx.h>
+#include <vx_ext_amd.h>
+#include "row_thread_pool.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+enum tensor_image_channel_order_e
+{
+    TENSOR_IMAGE_CHANNEL_ORDER_RGB = 0, // tensor channel c is byte c of the pixel
+    TENSOR_IMAGE_CHANNEL_ORDER_BGR = 1, // tensor channel c is byte 2 - c of the pixel
+};
+
+class CTensorImageConvert
+{
+public:
+    // Register both kernels. With use_opencl, they also register the AMD OpenCL
+    // code generation callbacks, and the framework may run them on the GPU.
+    static vx_status Register( vx_context context, vx_enum image_to_tensor_enum, vx_enum tensor_to_image_enum, bool use_opencl )
+    {
+        vx_status status = RegisterKernel( context, "app.userkernels.image_to_tensor", image_to_tensor_enum, use_opencl,
+                                           ImageToTensorFunction, ImageToTensorValidator, ImageToTensorInitialize, ImageToTensorCodegen,
+                                           VX_TYPE_IMAGE, VX_TYPE_TENSOR );
+        if( status == VX_SUCCESS )
+        {
+            status = RegisterKernel( context, "app.userkernels.tensor_to_image", tensor_to_image_enum, use_opencl,
+                                     TensorToImageFunction, TensorToImageValidator, TensorToImageInitialize, TensorToImageCodegen,
+                                     VX_TYPE_TENSOR, VX_TYPE_IMAGE );
+        }
+        return status;
+    }
+
+    static vx_node ImageToTensorNode( vx_graph graph, vx_image input, vx_tensor output,
+                                      vx_float32 scale, vx_float32 offset, vx_uint32 channel_order )
+    {
+        return CreateNode( graph, "app.userkernels.image_to_tensor", ( vx_reference ) input, ( vx_reference ) output,
+                           scale, offset, channel_order );
+    }
+
+    static vx_node TensorToImageNode( vx_graph graph, vx_tensor input, vx_image output,
+                                      vx_float32 scale, vx_float32 offset, vx_uint32 channel_order )
+    {
+        return CreateNode( graph, "app.userkernels.tensor_to_image", ( vx_reference ) input, ( vx_reference ) output,
+                           scale, offset, channel_order );
+    }
+
+protected:
+    // The conversion parameters of a node
+    struct Conversion
+    {
+        vx_float32 scale;
+        vx_float32 offset;
+        vx_uint32  channel_order;
+        vx_uint8   fixed_point_pos;
+    };
+
+    // Table of the last conversion of a node, kept in the node local data
+    struct LocalData
+    {
+        Conversion              conversion;
+        std::vector< vx_int16 > to_tensor; // pixel value -> tensor value
+        std::vector< vx_uint8 > to_image;  // ( vx_uint16 ) tensor value -> pixel value
+    };
+
+    static vx_status RegisterKernel( vx_context context, const char * name, vx_enum kernel_enum, bool use_opencl,
+                                     vx_kernel_f function, vx_kernel_validate_f validator, vx_kernel_initialize_f initialize,
+                                     amd_kernel_opencl_codegen_callback_f opencl_codegen_callback_f,
+                                     vx_enum input_type, vx_enum output_type )
+    {
+        vx_kernel kernel = vxAddUserKernel( context, name, kernel_enum, function, 5, validator, initialize, Deinitialize );
+        vx_status status = vxGetStatus( ( vx_reference ) kernel );
+        if( status == VX_SUCCESS && use_opencl )
+        {
+            amd_kernel_query_target_support_f query_target_support_f = QueryTargetSupport;
+            status = vxSetKernelAttribute( kernel, VX_KERNEL_ATTRIBUTE_AMD_QUERY_TARGET_SUPPORT,
+                                           &query_target_support_f, sizeof( query_target_support_f ) );
+            if( status == VX_SUCCESS )
+            {
+                status = vxSetKernelAttribute( kernel, VX_KERNEL_ATTRIBUTE_AMD_OPENCL_CODEGEN_CALLBACK,
+                                               &opencl_codegen_callback_f, sizeof( opencl_codegen_callback_f ) );
+            }
+        }
+        if( status == VX_SUCCESS )
+            status = vxAddParameterToKernel( kernel, 0, VX_INPUT,  input_type,     VX_PARAMETER_STATE_REQUIRED );
+        if( status == VX_SUCCESS )
+            status = vxAddParameterToKernel( kernel, 1, VX_OUTPUT, output_type,    VX_PARAMETER_STATE_REQUIRED );
+        for( vx_uint32 index = 2; status == VX_SUCCESS && index < 5; index++ )
+            status = vxAddParameterToKernel( kernel, index, VX_INPUT, VX_TYPE_SCALAR, VX_PARAMETER_STATE_REQUIRED );
+        if( status == VX_SUCCESS )
+            status = vxFinalizeKernel( kernel );
+        if( status == VX_SUCCESS )
+        {
+            status = vxReleaseKernel( &kernel );
+            vxAddLogEntry( ( vx_reference ) context, VX_SUCCESS, "OK: registered user kernel %s\n", name );
+        }
+        return status;
+    }
+
+    static vx_node CreateNode( vx_graph graph, const char * name, vx_reference input, vx_reference output,
+                               vx_float32 scale, vx_float32 offset, vx_uint32 channel_order )
+    {
+        vx_context context = vxGetContext( ( vx_reference ) graph );
+        vx_kernel kernel   = vxGetKernelByName( context, name );
+        vx_node   node     = vxCreateGenericNode( graph, kernel );
+        vx_scalar scalars[3] =
+        {
+            vxCreateScalar( context, VX_TYPE_FLOAT32, &scale ),
+            vxCreateScalar( context, VX_TYPE_FLOAT32, &offset ),
+            vxCreateScalar( context, VX_TYPE_UINT32,  &channel_order ),
+        };
+        vx_status status = vxGetStatus( ( vx_reference ) node );
+        if( status == VX_SUCCESS )
+            status = vxSetParameterByIndex( node, 0, input );
+        if( status == VX_SUCCESS )
+            status = vxSetParameterByIndex( node, 1, output );
+        for( vx_uint32 i = 0; i < 3; i++ )
+        {
+            if( status == VX_SUCCESS )
+                status = vxSetParameterByIndex( node, 2 + i, ( vx_reference ) scalars[i] );
+            vxReleaseScalar( &scalars[i] );
+        }
+        if( status != VX_SUCCESS && vxGetStatus( ( vx_reference ) node ) == VX_SUCCESS )
+        {
+            vxAddLogEntry( ( vx_reference ) graph, status, "ERROR: %s node creation failed\n", name );
+            vxReleaseNode( &node );
+        }
+        vxReleaseKernel( &kernel );
+        return node;
+    }
+
+    // Read parameters #2 to #4 and the fixed-point position of the tensor
+    static vx_status ReadConversion( const vx_reference * refs, vx_tensor tensor, Conversion & conversion )
+    {
+        vx_status status = vxCopyScalar( ( vx_scalar ) refs[2], &conversion.scale, VX_READ_ONLY, VX_MEMORY_TYPE_HOST );
+        if( status == VX_SUCCESS )
+            status = vxCopyScalar( ( vx_scalar ) refs[3], &conversion.offset, VX_READ_ONLY, VX_MEMORY_TYPE_HOST );
+        if( status == VX_SUCCESS )
+            status = vxCopyScalar( ( vx_scalar ) refs[4], &conversion.channel_order, VX_READ_ONLY, VX_MEMORY_TYPE_HOST );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( tensor, VX_TENSOR_FIXED_POINT_POSITION, &conversion.fixed_point_pos, sizeof( conversion.fixed_point_pos ) );
+        return status;
+    }
+
+    // Compute the table of the node's own kernel: to_tensor for image_to_tensor,
+    // to_image for tensor_to_image.
+    static void BuildTable( LocalData * data, const Conversion & conversion, bool to_tensor )
+    {
+        vx_float32 one = ( vx_float32 )( 1 << conversion.fixed_point_pos );
+        if( to_tensor )
+        {
+            data->to_tensor.resize( 256 );
+            for( vx_int32 pixel = 0; pixel < 256; pixel++ )
+            {
+                vx_float32 value = nearbyintf( ( pixel * conversion.scale + conversion.offset ) * one );
+                data->to_tensor[pixel] = ( vx_int16 ) std::min( std::max( value, -32768.0f ), 32767.0f );
+            }
+        }
+        else
+        {
+            data->to_image.resize( 65536 );
+            for( vx_int32 value = -32768; value < 32768; value++ )
+            {
+                vx_float32 pixel = nearbyintf( value / one * conversion.scale + conversion.offset );
+                data->to_image[( vx_uint16 ) value] = ( vx_uint8 ) std::min( std::max( pixel, 0.0f ), 255.0f );
+            }
+        }
+        data->conversion = conversion;
+    }
+
+    ////////
+    // Build the table for the parameters of the node, and keep it in the node
+    // local data: the local data attributes can only be set during initialization.
+    static vx_status Initialize( vx_node node, const vx_reference * refs, bool to_tensor )
+    {
+        Conversion conversion;
+        vx_status status = ReadConversion( refs, ( vx_tensor )( to_tensor ? refs[1] : refs[0] ), conversion );
+        if( status != VX_SUCCESS )
+            return status;
+        LocalData * data = new LocalData;
+        BuildTable( data, conversion, to_tensor );
+
+        vx_size size = 0; // the local data is allocated and freed by the kernel
+        status = vxSetNodeAttribute( node, VX_NODE_LOCAL_DATA_SIZE, &size, sizeof( size ) );
+        if( status == VX_SUCCESS )
+            status = vxSetNodeAttribute( node, VX_NODE_LOCAL_DATA_PTR, &data, sizeof( data ) );
+        if( status != VX_SUCCESS )
+            delete data;
+        return status;
+    }
+
+    static vx_status VX_CALLBACK ImageToTensorInitialize( vx_node node, const vx_reference * refs, vx_uint32 num )
+    {
+        return Initialize( node, refs, true );
+    }
+
+    static vx_status VX_CALLBACK TensorToImageInitialize( vx_node node, const vx_reference * refs, vx_uint32 num )
+    {
+        return Initialize( node, refs, false );
+    }
+
+    // Get the table of the node, recomputing it in place if the scalars have
+    // been changed since the node was initialized.
+    static vx_status GetLocalData( vx_node node, const Conversion & conversion, bool to_tensor, LocalData *& data )
+    {
+        vx_status status = vxQueryNode( node, VX_NODE_LOCAL_DATA_PTR, &data, sizeof( data ) );
+        if( status != VX_SUCCESS )
+            return status;
+        if( !data )
+            return VX_FAILURE;
+        if( data->conversion.scale           != conversion.scale ||
+            data->conversion.offset          != conversion.offset ||
+            data->conversion.fixed_point_pos != conversion.fixed_point_pos )
+        {
+            BuildTable( data, conversion, to_tensor );
+        }
+        return VX_SUCCESS;
+    }
+
+    static vx_status VX_CALLBACK Deinitialize( vx_node node, const vx_reference * refs, vx_uint32 num )
+    {
+        LocalData * data = NULL;
+        vx_status status = vxQueryNode( node, VX_NODE_LOCAL_DATA_PTR, &data, sizeof( data ) );
+        if( status == VX_SUCCESS && data )
+        {
+            delete data;
+            data = NULL;
+            status = vxSetNodeAttribute( node, VX_NODE_LOCAL_DATA_PTR, &data, sizeof( data ) );
+        }
+        return status;
+    }
+
+    ////////
+    // Both kernels have an RGB image of width x height on one side, and an
+    // INT16 tensor of [width x height x 3] on the other.
+    static vx_status ValidateScalars( const vx_reference parameters[] )
+    {
+        const vx_enum types[3] = { VX_TYPE_FLOAT32, VX_TYPE_FLOAT32, VX_TYPE_UINT32 };
+        for( vx_uint32 i = 0; i < 3; i++ )
+        {
+            vx_enum type = VX_TYPE_INVALID;
+            vx_status status = vxQueryScalar( ( vx_scalar ) parameters[2 + i], VX_SCALAR_TYPE, &type, sizeof( type ) );
+            if( status != VX_SUCCESS )
+                return status;
+            if( type != types[i] )
+                return VX_ERROR_INVALID_TYPE;
+        }
+        return VX_SUCCESS;
+    }
+
+    static vx_status VX_CALLBACK ImageToTensorValidator( vx_node node, const vx_reference parameters[], vx_uint32 num, vx_meta_format metas[] )
+    {
+        vx_uint32 width = 0, height = 0;
+        vx_df_image format = VX_DF_IMAGE_VIRT;
+        vx_uint8 fixed_point_pos = 0;
+        vx_status status = ValidateScalars( parameters );
+        if( status == VX_SUCCESS )
+            status = vxQueryImage( ( vx_image ) parameters[0], VX_IMAGE_FORMAT, &format, sizeof( format ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryImage( ( vx_image ) parameters[0], VX_IMAGE_WIDTH, &width, sizeof( width ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryImage( ( vx_image ) parameters[0], VX_IMAGE_HEIGHT, &height, sizeof( height ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( ( vx_tensor ) parameters[1], VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof( fixed_point_pos ) );
+        if( status != VX_SUCCESS )
+            return status;
+        if( format != VX_DF_IMAGE_RGB )
+            return VX_ERROR_INVALID_FORMAT;
+
+        vx_size num_of_dims = 3;
+        vx_size dims[3] = { width, height, 3 };
+        vx_enum data_type = VX_TYPE_INT16;
+        status = vxSetMetaFormatAttribute( metas[1], VX_TENSOR_NUMBER_OF_DIMS, &num_of_dims, sizeof( num_of_dims ) );
+        if( status == VX_SUCCESS )
+            status = vxSetMetaFormatAttribute( metas[1], VX_TENSOR_DIMS, dims, sizeof( dims ) );
+        if( status == VX_SUCCESS )
+            status = vxSetMetaFormatAttribute( metas[1], VX_TENSOR_DATA_TYPE, &data_type, sizeof( data_type ) );
+        if( status == VX_SUCCESS )
+            status = vxSetMetaFormatAttribute( metas[1], VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof( fixed_point_pos ) );
+        return status;
+    }
+
+    static vx_status VX_CALLBACK TensorToImageValidator( vx_node node, const vx_reference parameters[], vx_uint32 num, vx_meta_format metas[] )
+    {
+        vx_size num_of_dims = 0;
+        vx_size dims[3] = { 0 };
+        vx_enum data_type = VX_TYPE_INVALID;
+        vx_status status = ValidateScalars( parameters );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( ( vx_tensor ) parameters[0], VX_TENSOR_NUMBER_OF_DIMS, &num_of_dims, sizeof( num_of_dims ) );
+        if( status == VX_SUCCESS && num_of_dims != 3 )
+            status = VX_ERROR_INVALID_DIMENSION;
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( ( vx_tensor ) parameters[0], VX_TENSOR_DIMS, dims, sizeof( dims ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( ( vx_tensor ) parameters[0], VX_TENSOR_DATA_TYPE, &data_type, sizeof( data_type ) );
+        if( status != VX_SUCCESS )
+            return status;
+        if( dims[2] != 3 )
+            return VX_ERROR_INVALID_DIMENSION;
+        if( data_type != VX_TYPE_INT16 )
+            return VX_ERROR_INVALID_FORMAT;
+
+        vx_uint32 width = ( vx_uint32 ) dims[0], height = ( vx_uint32 ) dims[1];
+        vx_df_image format = VX_DF_IMAGE_RGB;
+        status = vxSetMetaFormatAttribute( metas[1], VX_IMAGE_FORMAT, &format, sizeof( format ) );
+        if( status == VX_SUCCESS )
+            status = vxSetMetaFormatAttribute( metas[1], VX_IMAGE_WIDTH, &width, sizeof( width ) );
+        if( status == VX_SUCCESS )
+            status = vxSetMetaFormatAttribute( metas[1], VX_IMAGE_HEIGHT, &height, sizeof( height ) );
+        return status;
+    }
+
+    ////////
+    // Host side functions: map the image and the tensor, and look every
+    // value up in the table of the node.
+    static vx_status MapBoth( vx_image image, vx_enum image_usage, vx_tensor tensor, vx_enum tensor_usage,
+                              vx_uint32 & width, vx_uint32 & height,
+                              vx_map_id & image_map, vx_imagepatch_addressing_t & image_addr, vx_uint8 *& image_buf,
+                              vx_map_id & tensor_map, vx_size tensor_stride[3], vx_uint8 *& tensor_buf )
+    {
+        vx_status status = vxQueryImage( image, VX_IMAGE_WIDTH, &width, sizeof( width ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryImage( image, VX_IMAGE_HEIGHT, &height, sizeof( height ) );
+        if( status != VX_SUCCESS )
+            return status;
+        vx_rectangle_t rect = { 0, 0, width, height };
+        status = vxMapImagePatch( image, &rect, 0, &image_map, &image_addr, ( void ** ) &image_buf, image_usage, VX_MEMORY_TYPE_HOST, VX_NOGAP_X );
+        if( status != VX_SUCCESS )
+            return status;
+        vx_size zeros[3] = { 0 };
+        vx_size dims[3] = { width, height, 3 };
+        status = vxMapTensorPatch( tensor, 3, zeros, dims, &tensor_map, tensor_stride, ( void ** ) &tensor_buf, tensor_usage, VX_MEMORY_TYPE_HOST, 0 );
+        if( status != VX_SUCCESS )
+            vxUnmapImagePatch( image, image_map );
+        return status;
+    }
+
+    static vx_status VX_CALLBACK ImageToTensorFunction( vx_node node, const vx_reference * refs, vx_uint32 num )
+    {
+        vx_image  image  = ( vx_image ) refs[0];
+        vx_tensor tensor = ( vx_tensor ) refs[1];
+        Conversion conversion;
+        LocalData * data = NULL;
+        vx_status status = ReadConversion( refs, tensor, conversion );
+        if( status == VX_SUCCESS )
+            status = GetLocalData( node, conversion, true, data );
+        vx_uint32 width, height;
+        vx_map_id image_map, tensor_map;
+        vx_imagepatch_addressing_t image_addr;
+        vx_uint8 * image_buf, * tensor_buf;
+        vx_size tensor_stride[3];
+        if( status == VX_SUCCESS )
+            status = MapBoth( image, VX_READ_ONLY, tensor, VX_WRITE_ONLY, width, height,
+                              image_map, image_addr, image_buf, tensor_map, tensor_stride, tensor_buf );
+        if( status != VX_SUCCESS )
+            return status;
+
+        const vx_int16 * table = &data->to_tensor[0];
+        vx_uint32 channel[3] = { 0, 1, 2 };
+        if( conversion.channel_order == TENSOR_IMAGE_CHANNEL_ORDER_BGR )
+            std::swap( channel[0], channel[2] );
+        CRowThreadPool::ForRows( height, width * 3, [&]( size_t y0, size_t y1 )
+        {
+            for( vx_uint32 y = ( vx_uint32 ) y0; y < y1; y++ )
+            {
+                const vx_uint8 * src = image_buf + y * image_addr.stride_y;
+                vx_int16 * dst[3];
+                for( vx_uint32 c = 0; c < 3; c++ )
+                    dst[c] = ( vx_int16 * )( tensor_buf + y * tensor_stride[1] + c * tensor_stride[2] );
+                for( vx_uint32 x = 0; x < width; x++, src += 3 )
+                {
+                    dst[0][x] = table[src[channel[0]]];
+                    dst[1][x] = table[src[channel[1]]];
+                    dst[2][x] = table[src[channel[2]]];
+                }
+            }
+        } );
+
+        status = vxUnmapTensorPatch( tensor, tensor_map );
+        vx_status unmap_status = vxUnmapImagePatch( image, image_map );
+        return status != VX_SUCCESS ? status : unmap_status;
+    }
+
+    static vx_status VX_CALLBACK TensorToImageFunction( vx_node node, const vx_reference * refs, vx_uint32 num )
+    {
+        vx_tensor tensor = ( vx_tensor ) refs[0];
+        vx_image  image  = ( vx_image ) refs[1];
+        Conversion conversion;
+        LocalData * data = NULL;
+        vx_status status = ReadConversion( refs, tensor, conversion );
+        if( status == VX_SUCCESS )
+            status = GetLocalData( node, conversion, false, data );
+        vx_uint32 width, height;
+        vx_map_id image_map, tensor_map;
+        vx_imagepatch_addressing_t image_addr;
+        vx_uint8 * image_buf, * tensor_buf;
+        vx_size tensor_stride[3];
+        if( status == VX_SUCCESS )
+            status = MapBoth( image, VX_WRITE_ONLY, tensor, VX_READ_ONLY, width, height,
+                              image_map, image_addr, image_buf, tensor_map, tensor_stride, tensor_buf );
+        if( status != VX_SUCCESS )
+            return status;
+
+        const vx_uint8 * table = &data->to_image[0];
+        vx_uint32 channel[3] = { 0, 1, 2 };
+        if( conversion.channel_order == TENSOR_IMAGE_CHANNEL_ORDER_BGR )
+            std::swap( channel[0], channel[2] );
+        CRowThreadPool::ForRows( height, width * 3, [&]( size_t y0, size_t y1 )
+        {
+            for( vx_uint32 y = ( vx_uint32 ) y0; y < y1; y++ )
+            {
+                vx_uint8 * dst = image_buf + y * image_addr.stride_y;
+                const vx_int16 * src[3];
+                for( vx_uint32 c = 0; c < 3; c++ )
+                    src[c] = ( const vx_int16 * )( tensor_buf + y * tensor_stride[1] + c * tensor_stride[2] );
+                for( vx_uint32 x = 0; x < width; x++, dst += 3 )
+                {
+                    dst[channel[0]] = table[( vx_uint16 ) src[0][x]];
+                    dst[channel[1]] = table[( vx_uint16 ) src[1][x]];
+                    dst[channel[2]] = table[( vx_uint16 ) src[2][x]];
+                }
+            }
+        } );
+
+        status = vxUnmapImagePatch( image, image_map );
+        vx_status unmap_status = vxUnmapTensorPatch( tensor, tensor_map );
+        return status != VX_SUCCESS ? status : unmap_status;
+    }
+
+    ////////
+    // The AMD OpenCL extension callbacks: one work-item per pixel
+    static vx_status VX_CALLBACK QueryTargetSupport( vx_graph graph, vx_node node, vx_bool use_opencl_1_2,
+                                                     vx_uint32 & supported_target_affinity )
+    {
+        supported_target_affinity = AGO_TARGET_AFFINITY_CPU | AGO_TARGET_AFFINITY_GPU;
+        return VX_SUCCESS;
+    }
+
+    static vx_status Codegen( const vx_reference parameters[], bool to_tensor,
+                              char opencl_kernel_function_name[64], std::string & opencl_kernel_code,
+                              vx_uint32 & opencl_work_dim, vx_size opencl_global_work[] )
+    {
+        vx_tensor tensor = ( vx_tensor )( to_tensor ? parameters[1] : parameters[0] );
+        vx_size dims[3] = { 0 }, stride[3] = { 0 };
+        vx_uint8 fixed_point_pos = 0;
+        vx_status status = vxQueryTensor( tensor, VX_TENSOR_DIMS, dims, sizeof( dims ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( tensor, VX_TENSOR_STRIDE_OPENCL, stride, sizeof( stride ) );
+        if( status == VX_SUCCESS )
+            status = vxQueryTensor( tensor, VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof( fixed_point_pos ) );
+        if( status != VX_SUCCESS )
+            return status;
+
+        char item[4096];
+        const char * image_args  = "uint i_width, uint i_height, __global uchar * i_buf, uint i_stride, uint i_offset";
+        const char * tensor_args = "__global uchar * t_buf, uint t_offset, uint4 t_stride";
+        sprintf( item,
+            "__kernel void %s(%s,\n"
+            "                 %s,\n"
+            "                 float scale, float offset, uint channel_order)\n"
+            "{\n"
+            "  uint x = get_global_id(0);\n"
+            "  uint y = get_global_id(1);\n"
+            "  __global uchar * pixel = i_buf + i_offset + y * i_stride + x * 3;\n"
+            "  __global short * value = (__global short *)(t_buf + t_offset + x * 2 + y * %u);\n" // stride[1]
+            "  uint c0 = channel_order ? 2 : 0, c2 = 2 - c0;\n"
+            "  float one = %d.0f;\n" // 1 << fixed_point_pos
+            , to_tensor ? "image_to_tensor" : "tensor_to_image"
+            , to_tensor ? image_args : tensor_args
+            , to_tensor ? tensor_args : image_args
+            , ( vx_uint32 ) stride[1], 1 << fixed_point_pos );
+        opencl_kernel_code = item;
+        if( to_tensor )
+        {
+            sprintf( item,
+                "  value[0]    = convert_short_sat_rte(mad((float)pixel[c0], scale, offset) * one);\n"
+                "  value[%u]   = convert_short_sat_rte(mad((float)pixel[1],  scale, offset) * one);\n" // stride[2] / 2
+                "  value[%u]   = convert_short_sat_rte(mad((float)pixel[c2], scale, offset) * one);\n" // stride[2]
+                "}\n"
+                , ( vx_uint32 )( stride[2] / 2 ), ( vx_uint32 ) stride[2] );
+        }
+        else
+        {
+            sprintf( item,
+                "  pixel[c0] = convert_uchar_sat_rte(mad((float)value[0],  scale / one, offset));\n"
+                "  pixel[1]  = convert_uchar_sat_rte(mad((float)value[%u], scale / one, offset));\n" // stride[2] / 2
+                "  pixel[c2] = convert_uchar_sat_rte(mad((float)value[%u], scale / one, offset));\n" // stride[2]
+                "}\n"
+                , ( vx_uint32 )( stride[2] / 2 ), ( vx_uint32 ) stride[2] );
+        }
+        opencl_kernel_code += item;
+        strcpy( opencl_kernel_function_name, to_tensor ? "image_to_tensor" : "tensor_to_image" );
+
+        opencl_work_dim = 2;
+        opencl_global_work[0] = dims[0];
+        opencl_global_work[1] = dims[1];
+        return VX_SUCCESS;
+    }
+
+    static vx_status VX_CALLBACK ImageToTensorCodegen(
+        vx_node node, const vx_reference parameters[], vx_uint32 num, bool opencl_load_function,
+        char opencl_kernel_function_name[64], std::string & opencl_kernel_code, std::string & opencl_build_options,
+        vx_uint32 & opencl_work_dim, vx_size opencl_global_work[], vx_size opencl_local_work[],
+        vx_uint32 & opencl_local_buffer_usage_mask, vx_uint32 & opencl_local_buffer_size_in_bytes )
+    {
+        return Codegen( parameters, true, opencl_kernel_function_name, opencl_kernel_code, opencl_work_dim, opencl_global_work );
+    }
+
+    static vx_status VX_CALLBACK TensorToImageCodegen(
+        vx_node node, const vx_reference parameters[], vx_uint32 num, bool opencl_load_function,
+        char opencl_kernel_function_name[64], std::string & opencl_kernel_code, std::string & opencl_build_options,
+        vx_uint32 & opencl_work_dim, vx_size opencl_global_work[], vx_size opencl_local_work[],
+        vx_uint32 & opencl_local_buffer_usage_mask, vx_uint32 & opencl_local_buffer_size_in_bytes )
+    {
+        return Codegen( parameters, false, opencl_kernel_function_name, opencl_kernel_code, opencl_work_dim, opencl_global_work );
+    }
+};
+
+#endif
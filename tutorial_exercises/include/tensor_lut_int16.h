@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+/*!
+ * \file   tensor_lut_int16.h
+ * \brief  lookup-table evaluation of element-wise functions on Q-format tensors
+ *
+ * An element-wise function of a VX_TYPE_INT16 tensor only ever sees 65536
+ * different inputs, so for given input and output fixed-point positions it
+ * can be computed once for all of them into a table. Apply() then replaces
+ * the per-element math with one table load, 16 elements at a time with
+ * AVX2 gathers when the compiler targets AVX2, and splits the rows of the
+ * tensor (dims[1] to dims[3]) between the threads of CRowThreadPool.
+ */
+
+#ifndef __tensor_lut_int16_h__
+#define __tensor_lut_int16_h__
+
+#include <VX/vx.h>
+#include "row_thread_pool.h"
+#include <vector>
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#endif
+
+class CTensorLutInt16
+{
+public:
+    CTensorLutInt16()
+        : m_input_fixed_point_pos( 0 ), m_output_fixed_point_pos( 0 ), m_valid( false )
+    {
+    }
+
+    // Check whether the table was built for these fixed-point positions
+    bool Matches( vx_uint8 input_fixed_point_pos, vx_uint8 output_fixed_point_pos ) const
+    {
+        return m_valid &&
+               m_input_fixed_point_pos  == input_fixed_point_pos &&
+               m_output_fixed_point_pos == output_fixed_point_pos;
+    }
+
+    // Tabulate output = function( input ) for every int16 input, with the same
+    // conversions as the per-element code of the tutorial kernels: the input is
+    // scaled by 1/(1 << input_fixed_point_pos), and the result is scaled by
+    // (1 << output_fixed_point_pos), added 0.5, and converted without saturation.
+    // function is a function pointer or any object with vx_float32 operator()( vx_float32 ).
+    template< class Function >
+    void Build( vx_uint8 input_fixed_point_pos, vx_uint8 output_fixed_point_pos,
+                const Function & function )
+    {
+        vx_float32 input_to_float_multiplier  = 1.0f / ( vx_float32 )( 1 << input_fixed_point_pos );
+        vx_float32 output_to_int16_multiplier = ( vx_float32 )( 1 << output_fixed_point_pos );
+        // One extra entry so that a 32-bit gather of the last entry stays in the table
+        m_table.assign( 65536 + 1, 0 );
+        for( vx_int32 value = -32768; value <= 32767; value++ )
+        {
+            m_table[( vx_uint16 ) value] = ( vx_int16 )( function( ( vx_float32 ) value * input_to_float_multiplier ) * output_to_int16_multiplier + 0.5f );
+        }
+        m_input_fixed_point_pos  = input_fixed_point_pos;
+        m_output_fixed_point_pos = output_fixed_point_pos;
+        m_valid = true;
+    }
+
+    // Look up every element of a mapped input tensor into a mapped output
+    // tensor with the same dims[4] (unused dimensions set to 1). num_threads
+    // of 0 uses one thread per processor core.
+    void Apply( const vx_uint8 * input, const vx_size input_stride[4],
+                vx_uint8 * output, const vx_size output_stride[4],
+                const vx_size dims[4], vx_uint32 num_threads = 0 ) const
+    {
+        const Rows tensor = { this, input, input_stride, output, output_stride, dims, 0, 0 };
+        CRowThreadPool::ForRows( dims[1] * dims[2] * dims[3], dims[0], [&tensor]( size_t begin, size_t end )
+        {
+            Rows rows = tensor;
+            rows.begin = begin;
+            rows.end   = end;
+            ApplyRows( rows );
+        }, num_threads );
+    }
+
+protected:
+    // Rows [begin, end) of the tensor, numbered over dims[1] * dims[2] * dims[3]
+    struct Rows
+    {
+        const CTensorLutInt16 * lut;
+        const vx_uint8 *        input;
+        const vx_size *         input_stride;
+        vx_uint8 *              output;
+        const vx_size *         output_stride;
+        const vx_size *         dims;
+        vx_size                 begin;
+        vx_size                 end;
+    };
+
+    static void ApplyRows( Rows rows )
+    {
+        const vx_int16 * table = &rows.lut->m_table[0];
+        for( vx_size row = rows.begin; row < rows.end; row++ )
+        {
+            vx_size dim1 = row % rows.dims[1];
+            vx_size dim2 = ( row / rows.dims[1] ) % rows.dims[2];
+            vx_size dim3 = row / rows.dims[1] / rows.dims[2];
+            const vx_int16 * ibuf = ( const vx_int16 * )( rows.input +
+                                                         dim3 * rows.input_stride[3] +
+                                                         dim2 * rows.input_stride[2] +
+                                                         dim1 * rows.input_stride[1] );
+            vx_int16 * obuf = ( vx_int16 * )( rows.output +
+                                              dim3 * rows.output_stride[3] +
+                                              dim2 * rows.output_stride[2] +
+                                              dim1 * rows.output_stride[1] );
+            vx_size dim0 = 0;
+#if defined( __AVX2__ )
+            // Zero-extend 16 inputs to 32-bit table indices, gather 32 bits at
+            // each index (the entry in the low half, since x86 is little-endian),
+            // and pack the low halves back into 16 outputs in their original order.
+            const __m256i mask = _mm256_set1_epi32( 0xffff );
+            for( ; dim0 + 16 <= rows.dims[0]; dim0 += 16 )
+            {
+                __m128i ivalue0 = _mm_loadu_si128( ( const __m128i * )( ibuf + dim0 ) );
+                __m128i ivalue1 = _mm_loadu_si128( ( const __m128i * )( ibuf + dim0 + 8 ) );
+                __m256i ovalue0 = _mm256_i32gather_epi32( ( const int * ) table, _mm256_cvtepu16_epi32( ivalue0 ), 2 );
+                __m256i ovalue1 = _mm256_i32gather_epi32( ( const int * ) table, _mm256_cvtepu16_epi32( ivalue1 ), 2 );
+                __m256i ovalue  = _mm256_packus_epi32( _mm256_and_si256( ovalue0, mask ), _mm256_and_si256( ovalue1, mask ) );
+                _mm256_storeu_si256( ( __m256i * )( obuf + dim0 ), _mm256_permute4x64_epi64( ovalue, 0xd8 ) );
+            }
+#endif
+            for( ; dim0 < rows.dims[0]; dim0++ )
+            {
+                obuf[dim0] = table[( vx_uint16 ) ibuf[dim0]];
+            }
+        }
+    }
+
+    std::vector< vx_int16 > m_table;
+    vx_uint8                m_input_fixed_point_pos;
+    vx_uint8                m_output_fixed_point_pos;
+    bool                    m_valid;
+};
+
+#endif
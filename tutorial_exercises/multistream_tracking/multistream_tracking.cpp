@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and/or associated documentation files (the
+ * "Materials"), to deal in the Materials without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Materials, and to
+ * permit persons to whom the Materials are furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+/*!
+ * \file    multistream_tracking.cpp
+ * \example multistream_tracking
+ * \brief   Runs the feature tracker of solution_exercise1 on several video
+ *          streams in one OpenVX context, and reports how the aggregate
+ *          frame rate scales with the number of streams when the graphs of
+ *          the streams are run one after another or scheduled concurrently.
+ */
+
+////////
+// Include OpenCV wrapper for image capture, and the re-detection component
+// that keeps the keypoints dense while tracking. The frames are never shown,
+// and a CGuiModule is created per stream for every run of the benchmark, so
+// the display is turned off to not open a window each time.
+#ifdef ENABLE_DISPLAY
+#undef ENABLE_DISPLAY
+#endif
+#define ENABLE_DISPLAY 0
+#include "opencv_camera_display.h"
+#include "feature_redetector.h"
+#include "nodePerf.h"
+
+#include <VX/vx.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+
+////////
+// Useful macros for OpenVX error checking:
+//   ERROR_CHECK_STATUS     - check whether the status is VX_SUCCESS
+#define ERROR_CHECK_STATUS( status ) { \
+        vx_status status_ = (status); \
+        if(status_ != VX_SUCCESS) { \
+            printf("ERROR: failed with status = (%d) at " __FILE__ "#%d\n", status_, __LINE__); \
+            exit(1); \
+        } \
+    }
+
+//   ERROR_CHECK_OBJECT     - check whether the object creation is successful
+#define ERROR_CHECK_OBJECT( obj ) { \
+        vx_status status_ = vxGetStatus((vx_reference)(obj)); \
+        if(status_ != VX_SUCCESS) { \
+            printf("ERROR: failed with status = (%d) at " __FILE__ "#%d\n", status_, __LINE__); \
+            exit(1); \
+        } \
+    }
+
+////////
+// CTrackingStream holds one video source and the graphs of the feature tracker
+// of solution_exercise1 for it: a front-end graph that computes the gray image
+// and the pyramid of each frame, a Harris graph for the first frame, and an
+// optical flow graph for the others. All streams share the context.
+//
+// With ENABLE_BGR_INGEST the BGR frame is copied as if it were RGB: only the
+// luma weights of red and blue are swapped, which does not matter for tracking.
+class CTrackingStream
+{
+public:
+    // The nodes are added to report under graph_name, unless report is NULL.
+    CTrackingStream( vx_context context, const char * source,
+                     struct node_perf_report * report, const char * graph_name )
+        : m_gui( source ), m_frame( 0 )
+    {
+        ////////
+        // Tracker configuration, as in solution_exercise1.
+        vx_uint32  width                   = m_gui.GetWidth();
+        vx_uint32  height                  = m_gui.GetHeight();
+        vx_size    max_keypoint_count      = 10000;
+        vx_float32 harris_strength_thresh  = 0.0005f;
+        vx_float32 harris_min_distance     = 5.0f;
+        vx_float32 harris_sensitivity      = 0.04f;
+        vx_int32   harris_gradient_size    = 3;
+        vx_int32   harris_block_size       = 3;
+        vx_uint32  lk_pyramid_levels       = 6;
+        vx_float32 lk_pyramid_scale        = VX_SCALE_PYRAMID_HALF;
+        vx_enum    lk_termination          = VX_TERM_CRITERIA_BOTH;
+        vx_float32 lk_epsilon              = 0.01f;
+        vx_uint32  lk_num_iterations       = 5;
+        vx_bool    lk_use_initial_estimate = vx_false_e;
+        vx_uint32  lk_window_dimension     = 6;
+        vx_float32 trackable_kp_ratio_thr  = 0.8f;
+        vx_uint32  redetect_grid_x         = 4;
+        vx_uint32  redetect_grid_y         = 4;
+
+        m_width  = width;
+        m_height = height;
+        m_input  = vxCreateImage( context, width, height, VX_DF_IMAGE_RGB );
+        ERROR_CHECK_OBJECT( m_input );
+
+        vx_pyramid pyramidExemplar = vxCreatePyramid( context, lk_pyramid_levels,
+                                                      lk_pyramid_scale, width, height, VX_DF_IMAGE_U8 );
+        ERROR_CHECK_OBJECT( pyramidExemplar );
+        m_pyramidDelay = vxCreateDelay( context, ( vx_reference )pyramidExemplar, 2 );
+        ERROR_CHECK_OBJECT( m_pyramidDelay );
+        ERROR_CHECK_STATUS( vxReleasePyramid( &pyramidExemplar ) );
+        vx_array keypointsExemplar = vxCreateArray( context, VX_TYPE_KEYPOINT, max_keypoint_count );
+        ERROR_CHECK_OBJECT( keypointsExemplar );
+        m_keypointsDelay = vxCreateDelay( context, ( vx_reference )keypointsExemplar, 2 );
+        ERROR_CHECK_OBJECT( m_keypointsDelay );
+        ERROR_CHECK_STATUS( vxReleaseArray( &keypointsExemplar ) );
+        vx_pyramid currentPyramid    = ( vx_pyramid ) vxGetReferenceFromDelay( m_pyramidDelay, 0 );
+        vx_pyramid previousPyramid   = ( vx_pyramid ) vxGetReferenceFromDelay( m_pyramidDelay, -1 );
+        vx_array   currentKeypoints  = ( vx_array )   vxGetReferenceFromDelay( m_keypointsDelay, 0 );
+        vx_array   previousKeypoints = ( vx_array )   vxGetReferenceFromDelay( m_keypointsDelay, -1 );
+        ERROR_CHECK_OBJECT( currentPyramid );
+        ERROR_CHECK_OBJECT( previousPyramid );
+        ERROR_CHECK_OBJECT( currentKeypoints );
+        ERROR_CHECK_OBJECT( previousKeypoints );
+
+        m_graphFront  = vxCreateGraph( context );
+        m_graphHarris = vxCreateGraph( context );
+        m_graphTrack  = vxCreateGraph( context );
+        ERROR_CHECK_OBJECT( m_graphFront );
+        ERROR_CHECK_OBJECT( m_graphHarris );
+        ERROR_CHECK_OBJECT( m_graphTrack );
+        vx_image yuv_image  = vxCreateVirtualImage( m_graphFront, width, height, VX_DF_IMAGE_IYUV );
+        vx_image gray_image = vxCreateImage( context, width, height, VX_DF_IMAGE_U8 );
+        ERROR_CHECK_OBJECT( yuv_image );
+        ERROR_CHECK_OBJECT( gray_image );
+
+        vx_scalar strength_thresh      = vxCreateScalar( context, VX_TYPE_FLOAT32, &harris_strength_thresh );
+        vx_scalar min_distance         = vxCreateScalar( context, VX_TYPE_FLOAT32, &harris_min_distance );
+        vx_scalar sensitivity          = vxCreateScalar( context, VX_TYPE_FLOAT32, &harris_sensitivity );
+        vx_scalar epsilon              = vxCreateScalar( context, VX_TYPE_FLOAT32, &lk_epsilon );
+        vx_scalar num_iterations       = vxCreateScalar( context, VX_TYPE_UINT32,  &lk_num_iterations );
+        vx_scalar use_initial_estimate = vxCreateScalar( context, VX_TYPE_BOOL,    &lk_use_initial_estimate );
+        ERROR_CHECK_OBJECT( strength_thresh );
+        ERROR_CHECK_OBJECT( min_distance );
+        ERROR_CHECK_OBJECT( sensitivity );
+        ERROR_CHECK_OBJECT( epsilon );
+        ERROR_CHECK_OBJECT( num_iterations );
+        ERROR_CHECK_OBJECT( use_initial_estimate );
+
+        vx_node nodes[] =
+        {
+            addNodeToPerfReport( report, graph_name, vxColorConvertNode( m_graphFront, m_input, yuv_image ) ),
+            addNodeToPerfReport( report, graph_name, vxChannelExtractNode( m_graphFront, yuv_image, VX_CHANNEL_Y, gray_image ) ),
+            addNodeToPerfReport( report, graph_name, vxGaussianPyramidNode( m_graphFront, gray_image, currentPyramid ) ),
+            addNodeToPerfReport( report, graph_name, vxHarrisCornersNode( m_graphHarris, gray_image, strength_thresh, min_distance, sensitivity,
+                                                                          harris_gradient_size, harris_block_size, currentKeypoints, NULL ) ),
+            addNodeToPerfReport( report, graph_name, vxOpticalFlowPyrLKNode( m_graphTrack, previousPyramid, currentPyramid,
+                                                                             previousKeypoints, previousKeypoints, currentKeypoints,
+                                                                             lk_termination, epsilon, num_iterations,
+                                                                             use_initial_estimate, lk_window_dimension ) )
+        };
+        for( vx_size i = 0; i < sizeof( nodes ) / sizeof( nodes[0] ); i++ )
+        {
+            ERROR_CHECK_OBJECT( nodes[i] );
+            ERROR_CHECK_STATUS( vxReleaseNode( &nodes[i] ) );
+        }
+        ERROR_CHECK_STATUS( vxVerifyGraph( m_graphFront ) );
+        ERROR_CHECK_STATUS( vxVerifyGraph( m_graphHarris ) );
+        ERROR_CHECK_STATUS( vxVerifyGraph( m_graphTrack ) );
+        ERROR_CHECK_STATUS( m_redetector.Create( context, gray_image, max_keypoint_count,
+                                                 redetect_grid_x, redetect_grid_y, trackable_kp_ratio_thr,
+                                                 strength_thresh, min_distance, sensitivity,
+                                                 harris_gradient_size, harris_block_size ) );
+
+        ERROR_CHECK_STATUS( vxReleaseImage( &yuv_image ) );
+        ERROR_CHECK_STATUS( vxReleaseImage( &gray_image ) );
+        ERROR_CHECK_STATUS( vxReleaseScalar( &strength_thresh ) );
+        ERROR_CHECK_STATUS( vxReleaseScalar( &min_distance ) );
+        ERROR_CHECK_STATUS( vxReleaseScalar( &sensitivity ) );
+        ERROR_CHECK_STATUS( vxReleaseScalar( &epsilon ) );
+        ERROR_CHECK_STATUS( vxReleaseScalar( &num_iterations ) );
+        ERROR_CHECK_STATUS( vxReleaseScalar( &use_initial_estimate ) );
+    }
+
+    ~CTrackingStream()
+    {
+        m_redetector.Release();
+        ERROR_CHECK_STATUS( vxReleaseGraph( &m_graphFront ) );
+        ERROR_CHECK_STATUS( vxReleaseGraph( &m_graphHarris ) );
+        ERROR_CHECK_STATUS( vxReleaseGraph( &m_graphTrack ) );
+        ERROR_CHECK_STATUS( vxReleaseDelay( &m_pyramidDelay ) );
+        ERROR_CHECK_STATUS( vxReleaseDelay( &m_keypointsDelay ) );
+        ERROR_CHECK_STATUS( vxReleaseImage( &m_input ) );
+    }
+
+    // Read the next frame of the source into the input image.
+    // Returns false at the end of the sequence.
+    bool Grab()
+    {
+        if( !m_gui.Grab() )
+        {
+            return false;
+        }
+        vx_rectangle_t region = { 0, 0, m_width, m_height };
+        vx_imagepatch_addressing_t layout = VX_IMAGEPATCH_ADDR_INIT;
+        layout.stride_x = 3;
+#if ENABLE_BGR_INGEST
+        layout.stride_y = m_gui.GetStrideBGR();
+        void * buffer   = m_gui.GetBufferBGR();
+#else
+        layout.stride_y = m_gui.GetStride();
+        void * buffer   = m_gui.GetBuffer();
+#endif
+        ERROR_CHECK_STATUS( vxCopyImagePatch( m_input, &region, 0, &layout, buffer,
+                                              VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST ) );
+        return true;
+    }
+
+    // The graph that runs first on each frame, and the one that runs after it.
+    vx_graph GetFrontGraph()
+    {
+        return m_graphFront;
+    }
+
+    vx_graph GetBackGraph()
+    {
+        return m_frame == 0 ? m_graphHarris : m_graphTrack;
+    }
+
+    // Re-detect where keypoints were lost, and age the delays for the next frame.
+    void EndFrame()
+    {
+        vx_array currentKeypoints = ( vx_array )vxGetReferenceFromDelay( m_keypointsDelay, 0 );
+        ERROR_CHECK_OBJECT( currentKeypoints );
+        if( m_frame == 0 )
+        {
+            ERROR_CHECK_STATUS( m_redetector.Reset( currentKeypoints ) );
+        }
+        else
+        {
+            ERROR_CHECK_STATUS( m_redetector.Update( currentKeypoints, NULL ) );
+        }
+        ERROR_CHECK_STATUS( vxAgeDelay( m_pyramidDelay ) );
+        ERROR_CHECK_STATUS( vxAgeDelay( m_keypointsDelay ) );
+        m_frame++;
+    }
+
+protected:
+    CGuiModule         m_gui;
+    vx_uint32          m_width, m_height;
+    int                m_frame;
+    vx_image           m_input;
+    vx_delay           m_pyramidDelay, m_keypointsDelay;
+    vx_graph           m_graphFront, m_graphHarris, m_graphTrack;
+    CFeatureRedetector m_redetector;
+};
+
+////////
+// processFrame() runs the graphs of every stream on its current frame.
+// Round-robin runs the graphs of one stream after the other with vxProcessGraph.
+// Concurrent schedules the front-end graphs of all streams with vxScheduleGraph,
+// then schedules the back-end graph of each stream as soon as its front end is
+// done, so that the implementation can run the streams in parallel.
+void processFrame( std::vector<std::unique_ptr<CTrackingStream>> & streams, bool concurrent )
+{
+    if( concurrent )
+    {
+        for( size_t i = 0; i < streams.size(); i++ )
+        {
+            ERROR_CHECK_STATUS( vxScheduleGraph( streams[i]->GetFrontGraph() ) );
+        }
+        for( size_t i = 0; i < streams.size(); i++ )
+        {
+            ERROR_CHECK_STATUS( vxWaitGraph( streams[i]->GetFrontGraph() ) );
+            ERROR_CHECK_STATUS( vxScheduleGraph( streams[i]->GetBackGraph() ) );
+        }
+        for( size_t i = 0; i < streams.size(); i++ )
+        {
+            ERROR_CHECK_STATUS( vxWaitGraph( streams[i]->GetBackGraph() ) );
+        }
+    }
+    else
+    {
+        for( size_t i = 0; i < streams.size(); i++ )
+        {
+            ERROR_CHECK_STATUS( vxProcessGraph( streams[i]->GetFrontGraph() ) );
+            ERROR_CHECK_STATUS( vxProcessGraph( streams[i]->GetBackGraph() ) );
+        }
+    }
+    for( size_t i = 0; i < streams.size(); i++ )
+    {
+        streams[i]->EndFrame();
+    }
+}
+
+////////
+// main() measures the aggregate frame rate for 1 to max-streams streams.
+// Command-line usage:
+//   % multistream_tracking [<max-streams> [<frames> [<video-sequence> ...]]]
+// max-streams defaults to the number of processor cores, and frames (per stream)
+// to 100. Stream i reads the video sequence (i modulo the number of sequences);
+// when none is specified, all streams read "PETS09-S1-L1-View001.avi".
+// Capture and the copy into OpenVX are included in the time: the streams are
+// grabbed one after the other before the graphs are scheduled, even in
+// concurrent mode, unless built with CAPTURE_THREAD_DEPTH to decode each stream
+// on its own thread. The results are printed as one table at the end.
+int main( int argc, char * argv[] )
+{
+    int max_streams = argc > 1 ? atoi( argv[1] ) : ( int )std::thread::hardware_concurrency();
+    int num_frames  = argc > 2 ? atoi( argv[2] ) : 100;
+    std::vector<const char *> sources;
+    for( int i = 3; i < argc; i++ )
+    {
+        sources.push_back( argv[i] );
+    }
+    if( sources.empty() )
+    {
+        sources.push_back( NULL );
+    }
+    if( max_streams < 1 )
+    {
+        max_streams = 1;
+    }
+
+    vx_context context = vxCreateContext();
+    ERROR_CHECK_OBJECT( context );
+
+    // Only the nodes of the max-streams runs are reported, to keep the report short.
+    struct node_perf_report * report = createNodePerfReport( context );
+
+    double base_fps[2] = { 0, 0 };
+    std::vector<std::string> results;
+    for( int num_streams = 1; num_streams <= max_streams; num_streams++ )
+    {
+        for( int mode = 0; mode < 2; mode++ )
+        {
+            bool concurrent = mode == 1;
+            std::vector<std::unique_ptr<CTrackingStream>> streams;
+            struct node_perf_report * stream_report = num_streams == max_streams ? report : NULL;
+            for( int i = 0; i < num_streams; i++ )
+            {
+                streams.emplace_back( new CTrackingStream( context, sources[i % sources.size()], stream_report,
+                                                           concurrent ? "Concurrent" : "RoundRobin" ) );
+            }
+
+            // The first frame runs Harris on every stream; it is not timed.
+            bool ok = true;
+            for( size_t i = 0; ok && i < streams.size(); i++ )
+            {
+                ok = streams[i]->Grab();
+            }
+            if( !ok )
+            {
+                printf( "ERROR: input has no video\n" );
+                return 1;
+            }
+            processFrame( streams, concurrent );
+
+            // Stop at the requested number of frames, or when any stream ends.
+            int frames = 0;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            while( frames < num_frames )
+            {
+                for( size_t i = 0; ok && i < streams.size(); i++ )
+                {
+                    ok = streams[i]->Grab();
+                }
+                if( !ok )
+                {
+                    break;
+                }
+                processFrame( streams, concurrent );
+                sampleNodePerfReport( stream_report );
+                frames++;
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            double fps = elapsed.count() > 0 ? frames * num_streams / elapsed.count() : 0.0;
+            if( num_streams == 1 )
+            {
+                base_fps[mode] = fps;
+            }
+            char line[128];
+            sprintf( line, "%7d %-10s %9d %9.3f %9.2f %7.2fx",
+                     num_streams, concurrent ? "Concurrent" : "RoundRobin", frames * num_streams,
+                     elapsed.count(), fps, base_fps[mode] > 0 ? fps / base_fps[mode] : 0.0 );
+            results.push_back( line );
+        }
+    }
+
+#if CAPTURE_THREAD_DEPTH > 0
+    printf( "NOTE: each stream decodes up to %d frames ahead on its own capture thread\n", CAPTURE_THREAD_DEPTH );
+#else
+    printf( "NOTE: in both modes every stream's Grab() runs serially before any graph is scheduled,\n"
+            "      so the scaling includes serialized decoding (build with CAPTURE_THREAD_DEPTH to overlap it)\n" );
+#endif
+    printf( "Streams Mode          Frames   Time(s)       FPS Scaling\n" );
+    for( size_t i = 0; i < results.size(); i++ )
+    {
+        printf( "%s\n", results[i].c_str() );
+    }
+    printNodePerfReport( report );
+
+    releaseNodePerfReport( &report );
+    ERROR_CHECK_STATUS( vxReleaseContext( &context ) );
+    return 0;
+}
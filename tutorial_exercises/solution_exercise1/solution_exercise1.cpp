@@ -24,7 +24,7 @@
 /*!
  * \file    solution_exercise1.cpp
  * \example solution_exercise1
- * \brief   Feature tracker example with two graphs and a user kernel
+ * \brief   Feature tracker example with a shared front-end graph and two back-end graphs
  *          Look for TODO STEP keyword in comments for the code snippets that you need to write.
  * \author  Radhakrishna Giduthuri <radha.giduthuri@ieee.org>
  *          Kari Pulli             <kari.pulli@gmail.com>
@@ -33,6 +33,15 @@
 ////////
 // Include OpenCV wrapper for image capture and display.
 #include "opencv_camera_display.h"
+#include "channel_swap.h"
+
+////////
+// Include the re-detection component that keeps the keypoints dense while tracking.
+#include "feature_redetector.h"
+
+////////
+// Include the per-node performance report (include/nodePerf.h).
+#include "nodePerf.h"
 
 ////////
 // The most important top-level OpenVX header files are "VX/vx.h" and "VX/vxu.h".
@@ -46,6 +55,19 @@
 //
 // The "VX/vxu.h" defines the immediate mode utility functions (not needed here).
 #include <VX/vx.h>
+#include <chrono>
+#include <vector>
+#include <string.h>
+
+////////
+// With ENABLE_PIPELINE the graphs for frame N run asynchronously (vxScheduleGraph)
+// while the application captures frame N+1 into a second input buffer: the next
+// frame is decoded while the front-end graph computes the pyramid, and copied
+// while the Harris or tracking graph runs. The application waits for each graph
+// (vxWaitGraph) before scheduling the next one.
+#ifndef ENABLE_PIPELINE
+#define ENABLE_PIPELINE 0
+#endif
 
 ////////
 // Useful macros for OpenVX error checking:
@@ -80,12 +102,34 @@ void VX_CALLBACK log_callback( vx_context    context,
     fflush( stdout );
 }
 
+#if ENABLE_PIPELINE
+////////
+// copyFrame() copies a captured frame into a packed input buffer of the
+// pipeline, which may be attached to the input image at the next frame.
+void copyFrame( CGuiModule & gui, vx_uint8 * buffer, vx_uint32 width, vx_uint32 height )
+{
+#if ENABLE_BGR_INGEST
+    const vx_uint8 * frame = gui.GetBufferBGR();
+    vx_size frame_stride   = gui.GetStrideBGR();
+#else
+    const vx_uint8 * frame = gui.GetBuffer();
+    vx_size frame_stride   = gui.GetStride();
+#endif
+    for( vx_uint32 y = 0; y < height; y++ )
+    {
+        memcpy( buffer + y * width * 3, frame + y * frame_stride, width * 3 );
+    }
+}
+#endif
+
 ////////
 // main() has all the OpenVX application code for this exercise.
 // Command-line usage:
-//   % solution_exercise1 [<video-sequence>|<camera-device-number>]
+//   % solution_exercise1 [<video-sequence>|<camera-device-number>] [<node-report.csv|node-report.json>]
 // When neither video sequence nor camera device number is specified,
 // it defaults to the video sequence in "PETS09-S1-L1-View001.avi".
+// When a node report file is specified, the time taken by each node is
+// written to it at the end.
 int main( int argc, char * argv[] )
 {
     // Get default video sequence when nothing is specified on command-line and
@@ -120,6 +164,8 @@ int main( int argc, char * argv[] )
     vx_bool    lk_use_initial_estimate = vx_false_e;            // don't use initial estimate
     vx_uint32  lk_window_dimension     = 6;                     // window size for evaluation
     vx_float32 trackable_kp_ratio_thr  = 0.8f;                  // threshold for the ration of tracked keypoints to all
+    vx_uint32  redetect_grid_x         = 4;                     // columns of cells for Harris re-detection
+    vx_uint32  redetect_grid_y         = 4;                     // rows of cells for Harris re-detection
 
     ////////********
     // Create the OpenVX context and make sure the returned context is valid.
@@ -145,6 +191,10 @@ int main( int argc, char * argv[] )
     vxRegisterLogCallback( context, log_callback, vx_false_e );
     vxAddLogEntry( ( vx_reference ) context, VX_FAILURE, "Hello there!\n" );
 
+    ////////
+    // Collect the time taken by every node of the three graphs below on every frame.
+    struct node_perf_report * nodeReport = createNodePerfReport( context );
+
 
     ////////
     // Create OpenVX image object for input RGB image.
@@ -154,7 +204,37 @@ int main( int argc, char * argv[] )
     //      width & height configuration parameters defined above. For the image
     //      format, use VX_DF_IMAGE_RGB enum.
     //   2. Use ERROR_CHECK_OBJECT to check proper creation of objects.
+#if ENABLE_PIPELINE || ENABLE_BGR_INGEST
+    // With ENABLE_BGR_INGEST the input image wraps the BGR buffer captured by
+    // OpenCV, and each new frame is attached with vxSwapImageHandle (no host
+    // copy or conversion); the graph then swaps the channels of every frame.
+    // With ENABLE_PIPELINE it alternates between two buffers owned here: the
+    // next frame is copied into one while a graph reads the other.
+    vx_imagepatch_addressing_t input_image_layout = VX_IMAGEPATCH_ADDR_INIT;
+    input_image_layout.dim_x    = width;
+    input_image_layout.dim_y    = height;
+    input_image_layout.stride_x = 3;
+    input_image_layout.scale_x  = VX_SCALE_UNITY;
+    input_image_layout.scale_y  = VX_SCALE_UNITY;
+    input_image_layout.step_x   = 1;
+    input_image_layout.step_y   = 1;
+#if ENABLE_PIPELINE
+    std::vector<vx_uint8> input_buffers[2];
+    input_buffers[0].resize( width * height * 3 );
+    input_buffers[1].resize( width * height * 3 );
+    int  input_buffer_index = 0;
+    copyFrame( gui, input_buffers[0].data(), width, height );
+    input_image_layout.stride_y = width * 3;
+    void * input_image_ptrs[]   = { input_buffers[0].data() };
+#else
+    input_image_layout.stride_y = gui.GetStrideBGR();
+    void * input_image_ptrs[]   = { gui.GetBufferBGR() };
+#endif
+    vx_image input_rgb_image = vxCreateImageFromHandle( context, VX_DF_IMAGE_RGB, &input_image_layout,
+                                                        input_image_ptrs, VX_MEMORY_TYPE_HOST );
+#else
     vx_image input_rgb_image = vxCreateImage( context, width, height, VX_DF_IMAGE_RGB );
+#endif
     ERROR_CHECK_OBJECT( input_rgb_image );
 
 
@@ -219,20 +299,28 @@ int main( int argc, char * argv[] )
 
 
     ////////********
-    // Harris and optical flow algorithms require their own graph objects.
-    // The Harris graph needs to extract gray scale image out of input RGB,
-    // compute an initial set of keypoints, and compute an initial pyramid for use
-    // by the optical flow graph.
+    // The color conversion and the pyramid are the same whether a frame is used for
+    // Harris or for tracking, so they are computed once per frame by a front-end graph.
+    // The Harris and optical flow back-end graphs only consume its outputs: the gray
+    // image and the current pyramid from the pyramid delay object.
     //
     // TODO STEP 06:********
-    //   1. Create two graph objects: one for the Harris corner detector and
-    //      the other for feature tracking using optical flow using the
+    //   1. Create three graph objects: one for the front end, one for the Harris corner
+    //      detector and one for feature tracking using optical flow using the
     //      vxCreateGraph API.
-    //      We gave code for one graph; do similar for the other.
+    //      We gave code for one graph; do similar for the others.
+    vx_graph graphFront  = vxCreateGraph( context );
     vx_graph graphHarris = vxCreateGraph( context );
     vx_graph graphTrack  = vxCreateGraph( context );
+    ERROR_CHECK_OBJECT( graphFront );
     ERROR_CHECK_OBJECT( graphHarris );
     ERROR_CHECK_OBJECT( graphTrack );
+#if ENABLE_BGR_INGEST
+    vx_image front_rgb_image = CChannelSwap::AddNodes( graphFront, input_rgb_image, width, height );
+    ERROR_CHECK_OBJECT( front_rgb_image );
+#else
+    vx_image front_rgb_image = input_rgb_image;
+#endif
 
 
     ////////********
@@ -241,26 +329,21 @@ int main( int argc, char * argv[] )
     // from RGB image, which requires two steps:
     //   - perform RGB to IYUV color conversion
     //   - extract Y channel from IYUV image
-    // This requires two intermediate OpenVX image objects. Since you don't
-    // need to access these objects from the application, they can be virtual
-    // objects that can be created using the vxCreateVirtualImage API.
+    // The IYUV image is only used inside the front-end graph, so it can be a virtual
+    // object created using the vxCreateVirtualImage API. The gray image is passed
+    // from the front-end graph to the Harris graph and to the re-detection graphs
+    // created after STEP 10, so it has to be a regular image.
     //
     // TODO STEP 07:********
     //   1. Create an IYUV image and a U8 image (for Y channel) with the same
     //      dimensions as the input RGB image. Note that the image formats for
     //      IYUV and U8 images are VX_DF_IMAGE_IYUV and VX_DF_IMAGE_U8.
-    //      Since virtual objects are specific to a graph, you
-    //      need to create two sets, one for each graph.
     //      We gave one fully in comments and you need to fill in missing
-    //      parameters for the others.
-    vx_image harris_yuv_image       = vxCreateVirtualImage( graphHarris, width, height, VX_DF_IMAGE_IYUV );
-    vx_image harris_gray_image      = vxCreateVirtualImage( graphHarris, width, height, VX_DF_IMAGE_U8 );
-    vx_image opticalflow_yuv_image  = vxCreateVirtualImage( graphTrack,  width, height, VX_DF_IMAGE_IYUV );
-    vx_image opticalflow_gray_image = vxCreateVirtualImage( graphTrack,  width, height, VX_DF_IMAGE_U8 );
-    ERROR_CHECK_OBJECT( harris_yuv_image );
-    ERROR_CHECK_OBJECT( harris_gray_image );
-    ERROR_CHECK_OBJECT( opticalflow_yuv_image );
-    ERROR_CHECK_OBJECT( opticalflow_gray_image );
+    //      parameters for the other.
+    vx_image front_yuv_image = vxCreateVirtualImage( graphFront, width, height, VX_DF_IMAGE_IYUV );
+    vx_image gray_image      = vxCreateImage( context, width, height, VX_DF_IMAGE_U8 );
+    ERROR_CHECK_OBJECT( front_yuv_image );
+    ERROR_CHECK_OBJECT( gray_image );
 
 
     ////////********
@@ -296,76 +379,99 @@ int main( int argc, char * argv[] )
 
     ////////********
     // Now all the objects have been created for building the graphs.
-    // First, build a graph that performs Harris corner detection and initial pyramid computation.
+    // First, build the front-end graph that computes the gray image and the pyramid
+    // of every frame, then a graph that performs Harris corner detection on it.
     // See "VX/vx_nodes.h" for APIs how to add nodes into a graph.
     //
     // TODO STEP 09:********
     //   1. Use vxColorConvertNode and vxChannelExtractNode APIs to get gray
     //      scale image for Harris and Pyramid computation from the input
-    //      RGB image. Add these nodes into the Harris graph.
+    //      RGB image. Add these nodes into the front-end graph.
     //      We gave code in comments with a missing parameter for you to fill in.
     //   2. Use vxGaussianPyramidNode API to add pyramid computation node.
     //      You need to use the current pyramid from the pyramid delay object.
     //      We gave code in comments with a missing parameter for you to fill in.
-    //   3. Use vxHarrisCornersNode API to add a Harris corners node.
+    //   3. Use vxHarrisCornersNode API to add a Harris corners node into the Harris graph.
     //      You need to use the current keypoints from keypoints delay object.
     //      We gave code in comments with few missing parameters for you to fill in.
     //   4. Use ERROR_CHECK_OBJECT to check proper creation of objects.
     //   5. Release node and virtual objects immediately since the graph
     //      retains references to them.
-    //   6. Call vxVerifyGraph to check for any errors in the graph.
+    //   6. Call vxVerifyGraph to check for any errors in the graphs.
     //      Fill in missing parameter in commented code.
+    vx_node nodesFront[] =
+    {
+        addNodeToPerfReport( nodeReport, "Front", vxColorConvertNode( graphFront, front_rgb_image, front_yuv_image ) ),
+        addNodeToPerfReport( nodeReport, "Front", vxChannelExtractNode( graphFront, front_yuv_image, VX_CHANNEL_Y, gray_image ) ),
+        addNodeToPerfReport( nodeReport, "Front", vxGaussianPyramidNode( graphFront, gray_image, currentPyramid ) )
+    };
+    for( vx_size i = 0; i < sizeof( nodesFront ) / sizeof( nodesFront[0] ); i++ )
+    {
+        ERROR_CHECK_OBJECT( nodesFront[i] );
+        ERROR_CHECK_STATUS( vxReleaseNode( &nodesFront[i] ) );
+    }
+    ERROR_CHECK_STATUS( vxReleaseImage( &front_yuv_image ) );
+#if ENABLE_BGR_INGEST
+    ERROR_CHECK_STATUS( vxReleaseImage( &front_rgb_image ) );
+#endif
+    ERROR_CHECK_STATUS( vxVerifyGraph( graphFront ) );
+
     vx_node nodesHarris[] =
     {
-        vxColorConvertNode( graphHarris, input_rgb_image, harris_yuv_image ),
-        vxChannelExtractNode( graphHarris, harris_yuv_image, VX_CHANNEL_Y, harris_gray_image ),
-        vxGaussianPyramidNode( graphHarris, harris_gray_image, currentPyramid ),
-        vxHarrisCornersNode( graphHarris, harris_gray_image, strength_thresh, min_distance, sensitivity, harris_gradient_size, harris_block_size, currentKeypoints, NULL )
+        addNodeToPerfReport( nodeReport, "Harris", vxHarrisCornersNode( graphHarris, gray_image, strength_thresh, min_distance, sensitivity, harris_gradient_size, harris_block_size, currentKeypoints, NULL ) )
     };
     for( vx_size i = 0; i < sizeof( nodesHarris ) / sizeof( nodesHarris[0] ); i++ )
     {
         ERROR_CHECK_OBJECT( nodesHarris[i] );
         ERROR_CHECK_STATUS( vxReleaseNode( &nodesHarris[i] ) );
     }
-    ERROR_CHECK_STATUS( vxReleaseImage( &harris_yuv_image ) );
-    ERROR_CHECK_STATUS( vxReleaseImage( &harris_gray_image ) );
     ERROR_CHECK_STATUS( vxVerifyGraph( graphHarris ) );
 
 
     ////////********
-    // Now, build a graph that computes image pyramid for the next frame,
-    // and tracks features using optical flow.
+    // Now, build a graph that tracks features using optical flow between the
+    // previous pyramid and the one computed by the front-end graph for this frame.
     //
     // TODO STEP 10:********
-    //   1. Color convert, channel extract, and Gaussian pyramid nodes are like above.
-    //      Add them to the tracking graph.
-    //   2. Use vxOpticalFlowPyrLKNode API to add an optical flow node. You need to
+    //   1. Use vxOpticalFlowPyrLKNode API to add an optical flow node. You need to
     //      use the current and previous keypoints from the keypoints delay object.
     //      Fill in the missing parameters in commented code.
-    //   3. As above, check for errors, release nodes and virtual objects,
-    //      and verify the graph.
+    //   2. As above, check for errors, release nodes, and verify the graph.
     vx_node nodesTrack[] =
     {
-        vxColorConvertNode( graphTrack, input_rgb_image, opticalflow_yuv_image ),
-        vxChannelExtractNode( graphTrack, opticalflow_yuv_image, VX_CHANNEL_Y, opticalflow_gray_image ),
-        vxGaussianPyramidNode( graphTrack, opticalflow_gray_image, currentPyramid ),
-        vxOpticalFlowPyrLKNode( graphTrack, previousPyramid, currentPyramid,
+        addNodeToPerfReport( nodeReport, "Track", vxOpticalFlowPyrLKNode( graphTrack, previousPyramid, currentPyramid,
                                             previousKeypoints, previousKeypoints, currentKeypoints,
                                             lk_termination, epsilon, num_iterations,
-                                            use_initial_estimate, lk_window_dimension )
+                                            use_initial_estimate, lk_window_dimension ) )
     };
     for( vx_size i = 0; i < sizeof( nodesTrack ) / sizeof( nodesTrack[0] ); i++ )
     {
         ERROR_CHECK_OBJECT( nodesTrack[i] );
         ERROR_CHECK_STATUS( vxReleaseNode( &nodesTrack[i] ) );
     }
-    ERROR_CHECK_STATUS( vxReleaseImage( &opticalflow_yuv_image ) );
-    ERROR_CHECK_STATUS( vxReleaseImage( &opticalflow_gray_image ) );
     ERROR_CHECK_STATUS( vxVerifyGraph( graphTrack ) );
 
 
+    ////////
+    // Rather than tracking the keypoints of the first frame until they are all lost,
+    // re-detect corners with Harris on the cells of a grid where fewer than
+    // trackable_kp_ratio_thr of the keypoints found there are still tracked.
+    CFeatureRedetector redetector;
+    ERROR_CHECK_STATUS( redetector.Create( context, gray_image, max_keypoint_count,
+                                           redetect_grid_x, redetect_grid_y, trackable_kp_ratio_thr,
+                                           strength_thresh, min_distance, sensitivity,
+                                           harris_gradient_size, harris_block_size ) );
+    ERROR_CHECK_STATUS( vxReleaseImage( &gray_image ) );
+
+
     ////////
     // Process the video sequence frame by frame until the end of sequence or aborted.
+    // The latency of a frame is measured from its capture to the completion of its
+    // graph, and the throughput over the whole loop.
+    std::chrono::steady_clock::time_point loop_start   = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point capture_time = loop_start;
+    double total_latency_ms = 0;
+    int    num_frames       = 0;
     for( int frame_index = 0; !gui.AbortRequested(); frame_index++ )
     {
         ////////********
@@ -381,6 +487,12 @@ int main( int argc, char * argv[] )
         //   3. Write the image data in the OpenCV image to the OpenVX image.
         //      Use vxCopyImagePatch with VX_WRITE_ONLY and VX_MEMORY_TYPE_HOST,
         //      describe the image region and layout, and provide a pointer to the image data.
+#if ENABLE_PIPELINE
+        // Nothing to do here: the frame was copied into the input buffer during the previous graph.
+#elif ENABLE_BGR_INGEST
+        input_image_ptrs[0] = gui.GetBufferBGR();
+        ERROR_CHECK_STATUS( vxSwapImageHandle( input_rgb_image, input_image_ptrs, NULL, 1 ) );
+#else
         vx_rectangle_t cv_rgb_image_region;
         cv_rgb_image_region.start_x    = 0;
         cv_rgb_image_region.start_y    = 0;
@@ -395,19 +507,43 @@ int main( int argc, char * argv[] )
         ERROR_CHECK_STATUS( vxCopyImagePatch( input_rgb_image, &cv_rgb_image_region, 0,
                                               &cv_rgb_image_layout, cv_rgb_image_buffer,
                                               VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST ) );
+#endif
 
 
         ////////********
-        // Now that input RGB image is ready, just run a graph.
+        // Now that input RGB image is ready, run the front-end graph and then a back-end graph.
         // Run Harris at the beginning to initialize the previous keypoints,
         // on other frames run the tracking graph.
         //
         // TODO STEP 12:********
-        //   1. Run a graph using vxProcessGraph API. Select Harris graph
+        //   1. Run the front-end graph using vxProcessGraph API.
+        //   2. Run a back-end graph using vxProcessGraph API. Select Harris graph
         //      if the frame_index == 0 (i.e., the first frame of the video
         //      sequence), otherwise, select the feature tracking graph.
-        //   2. Use ERROR_CHECK_STATUS for error checking.
+        //   3. Use ERROR_CHECK_STATUS for error checking.
+#if ENABLE_PIPELINE
+        // The graphs only read the current input buffer, so the next frame is
+        // grabbed while the front-end graph runs, and copied into the other
+        // input buffer while Harris or tracking runs.
+        vx_graph graphBack = frame_index == 0 ? graphHarris : graphTrack;
+        ERROR_CHECK_STATUS( vxScheduleGraph( graphFront ) );
+        bool have_next_frame = gui.Grab();
+        std::chrono::steady_clock::time_point next_capture_time = std::chrono::steady_clock::now();
+        ERROR_CHECK_STATUS( vxWaitGraph( graphFront ) );
+        ERROR_CHECK_STATUS( vxScheduleGraph( graphBack ) );
+        if( have_next_frame )
+        {
+            copyFrame( gui, input_buffers[1 - input_buffer_index].data(), width, height );
+        }
+        ERROR_CHECK_STATUS( vxWaitGraph( graphBack ) );
+#else
+        ERROR_CHECK_STATUS( vxProcessGraph( graphFront ) );
         ERROR_CHECK_STATUS( vxProcessGraph( frame_index == 0 ? graphHarris : graphTrack ) );
+#endif
+        sampleNodePerfReport( nodeReport );
+        std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - capture_time;
+        total_latency_ms += latency.count();
+        num_frames++;
 
 
         ////////********
@@ -464,6 +600,21 @@ int main( int argc, char * argv[] )
         }
 
 
+        ////////
+        // Replace the current keypoints by the ones still tracked plus the corners
+        // re-detected where too many were lost; after aging the delay these are
+        // the keypoints tracked into the next frame.
+        vx_uint32 num_redetected_cells = 0;
+        if( frame_index == 0 )
+        {
+            ERROR_CHECK_STATUS( redetector.Reset( currentKeypoints ) );
+        }
+        else
+        {
+            ERROR_CHECK_STATUS( redetector.Update( currentKeypoints, &num_redetected_cells ) );
+        }
+
+
         ////////********
         // Increase the age of the delay objects to make the current entry become previous entry.
         //
@@ -475,19 +626,41 @@ int main( int argc, char * argv[] )
 
         ////////
         // Display the results and grab the next input RGB frame for the next iteration.
+        // In pipelined mode the next frame has already been grabbed, so the results
+        // are drawn over it, and its buffer becomes the input image now.
         char text[128];
         sprintf( text, "Keyboard ESC/Q-Quit SPACE-Pause [FRAME %d]", frame_index );
         gui.DrawText( 0, 16, text );
-        sprintf( text, "Number of Corners: %d [tracking %d]", ( int )num_corners, ( int )num_tracking );
+        sprintf( text, "Number of Corners: %d [tracking %d] [re-detected cells %d]",
+                 ( int )num_corners, ( int )num_tracking, ( int )num_redetected_cells );
         gui.DrawText( 0, 36, text );
         gui.Show();
+#if ENABLE_PIPELINE
+        if( !have_next_frame )
+        {
+            // Terminate the processing loop if the end of sequence is detected.
+            gui.WaitForKey();
+            break;
+        }
+        input_buffer_index  = 1 - input_buffer_index;
+        input_image_ptrs[0] = input_buffers[input_buffer_index].data();
+        ERROR_CHECK_STATUS( vxSwapImageHandle( input_rgb_image, input_image_ptrs, NULL, 1 ) );
+        capture_time = next_capture_time;
+#else
         if( !gui.Grab() )
         {
             // Terminate the processing loop if the end of sequence is detected.
             gui.WaitForKey();
             break;
         }
+        capture_time = std::chrono::steady_clock::now();
+#endif
     }
+    std::chrono::duration<double, std::milli> loop_time = std::chrono::steady_clock::now() - loop_start;
+    printf( "Mode      NumFrames Latency(ms) Throughput(fps)\n"
+            "%-9s %9d %11.3f %15.2f\n", ENABLE_PIPELINE ? "Pipelined" : "Serial", num_frames,
+            num_frames > 0 ? total_latency_ms / num_frames : 0.0,
+            loop_time.count() > 0 ? num_frames * 1000.0 / loop_time.count() : 0.0 );
 
     ////////********
     // Query graph performance using VX_GRAPH_PERFORMANCE and print timing
@@ -495,16 +668,24 @@ int main( int argc, char * argv[] )
     //
     // TODO STEP 15:********
     //   1. Use vxQueryGraph API with VX_GRAPH_PERFORMANCE to query graph performance.
-    //      We gave the attribute query for one graph in comments. Do the same for the second graph.
+    //      We gave the attribute query for one graph in comments. Do the same for the other graphs.
     //   2. Print the average and min execution times in milliseconds. Use the printf in comments.
-    vx_perf_t perfHarris = { 0 }, perfTrack = { 0 };
+    vx_perf_t perfFront = { 0 }, perfHarris = { 0 }, perfTrack = { 0 };
+    ERROR_CHECK_STATUS( vxQueryGraph( graphFront, VX_GRAPH_PERFORMANCE, &perfFront, sizeof( perfFront ) ) );
     ERROR_CHECK_STATUS( vxQueryGraph( graphHarris, VX_GRAPH_PERFORMANCE, &perfHarris, sizeof( perfHarris ) ) );
     ERROR_CHECK_STATUS( vxQueryGraph( graphTrack, VX_GRAPH_PERFORMANCE, &perfTrack, sizeof( perfTrack ) ) );
     printf( "GraphName NumFrames Avg(ms) Min(ms)\n"
+            "Front     %9d %7.3f %7.3f\n"
             "Harris    %9d %7.3f %7.3f\n"
             "Track     %9d %7.3f %7.3f\n",
+            ( int )perfFront.num,  ( float )perfFront.avg  * 1e-6f, ( float )perfFront.min  * 1e-6f,
             ( int )perfHarris.num, ( float )perfHarris.avg * 1e-6f, ( float )perfHarris.min * 1e-6f,
             ( int )perfTrack.num,  ( float )perfTrack.avg  * 1e-6f, ( float )perfTrack.min  * 1e-6f );
+    printNodePerfReport( nodeReport );
+    if( argc > 2 && writeNodePerfReport( nodeReport, argv[2] ) != VX_SUCCESS )
+    {
+        printf( "ERROR: unable to write node report to %s\n", argv[2] );
+    }
 
 
     ////////********
@@ -514,10 +695,16 @@ int main( int argc, char * argv[] )
     //
     // TODO STEP 16:********
     //   1. For releasing all other objects use vxRelease<Object> APIs.
-    //      You have to release 2 graph objects, 1 image object, 2 delay objects,
+    //      You have to release 3 graph objects, 1 image object, 2 delay objects,
     //      6 scalar objects, and 1 context object.
+    redetector.Release();
+    releaseNodePerfReport( &nodeReport );
+    ERROR_CHECK_STATUS( vxReleaseGraph( &graphFront ) );
     ERROR_CHECK_STATUS( vxReleaseGraph( &graphHarris ) );
     ERROR_CHECK_STATUS( vxReleaseGraph( &graphTrack ) );
+#if ENABLE_PIPELINE || ENABLE_BGR_INGEST
+    ERROR_CHECK_STATUS( vxSwapImageHandle( input_rgb_image, NULL, NULL, 1 ) );
+#endif
     ERROR_CHECK_STATUS( vxReleaseImage( &input_rgb_image ) );
     ERROR_CHECK_STATUS( vxReleaseDelay( &pyramidDelay ) );
     ERROR_CHECK_STATUS( vxReleaseDelay( &keypointsDelay ) );
@@ -32,6 +32,12 @@
 ////////
 // Include OpenCV wrapper for image capture and display.
 #include "opencv_camera_display.h"
+#include "channel_swap.h"
+#include "median_filter_u8.h"
+
+////////
+// Include the per-node performance report (include/nodePerf.h).
+#include "nodePerf.h"
 
 ////////
 // The most important top-level OpenVX header files are "VX/vx.h" and "VX/vxu.h".
@@ -45,6 +51,20 @@
 // The "VX/vxu.h" defines the immediate mode utility functions (not needed here).
 #include <VX/vx.h>
 
+////////
+// With ENABLE_TILING_KERNEL the median filter is also registered as tiling
+// kernels (see "VX/vx_khr_tiling.h") for the kernel sizes listed below, so that
+// an implementation of the tiling extension can split it across cores and run
+// it tile by tile with the nodes around it. Other kernel sizes, and builds
+// without the option, use the user kernel that calls cv::medianBlur.
+#ifndef ENABLE_TILING_KERNEL
+#define ENABLE_TILING_KERNEL 0
+#endif
+#if ENABLE_TILING_KERNEL
+#include <VX/vx_khr_tiling.h>
+#include <algorithm>
+#endif
+
 
 ////////
 // Useful macros for OpenVX error checking:
@@ -81,6 +101,11 @@ enum user_library_e
 enum user_kernel_e
 {
     USER_KERNEL_MEDIAN_BLUR     = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x001,
+#if ENABLE_TILING_KERNEL
+    USER_KERNEL_MEDIAN_BLUR_3x3 = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x002,
+    USER_KERNEL_MEDIAN_BLUR_5x5 = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x003,
+    USER_KERNEL_MEDIAN_BLUR_7x7 = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x004,
+#endif
 };
 
 ////////
@@ -104,6 +129,23 @@ vx_node userMedianBlurNode( vx_graph graph,
                             vx_int32 ksize )
 {
     vx_context context = vxGetContext( ( vx_reference ) graph );
+#if ENABLE_TILING_KERNEL
+    // The tiling kernels have the kernel size built in, and only the two images as parameters.
+    vx_enum tiling_kernel_enum = ksize == 3 ? USER_KERNEL_MEDIAN_BLUR_3x3 :
+                                 ksize == 5 ? USER_KERNEL_MEDIAN_BLUR_5x5 :
+                                 ksize == 7 ? USER_KERNEL_MEDIAN_BLUR_7x7 : VX_KERNEL_INVALID;
+    if( tiling_kernel_enum != VX_KERNEL_INVALID )
+    {
+        vx_kernel tiling_kernel = vxGetKernelByEnum( context, tiling_kernel_enum );
+        ERROR_CHECK_OBJECT( tiling_kernel );
+        vx_node tiling_node     = vxCreateGenericNode( graph, tiling_kernel );
+        ERROR_CHECK_OBJECT( tiling_node );
+        ERROR_CHECK_STATUS( vxSetParameterByIndex( tiling_node, 0, ( vx_reference ) input ) );
+        ERROR_CHECK_STATUS( vxSetParameterByIndex( tiling_node, 1, ( vx_reference ) output ) );
+        ERROR_CHECK_STATUS( vxReleaseKernel( &tiling_kernel ) );
+        return tiling_node;
+    }
+#endif
     vx_kernel kernel   = vxGetKernelByEnum( context, USER_KERNEL_MEDIAN_BLUR );
     ERROR_CHECK_OBJECT( kernel );
     vx_node node       = vxCreateGenericNode( graph, kernel );
@@ -170,6 +212,9 @@ vx_status VX_CALLBACK median_blur_validator( vx_node node,
 ////////
 // User kernel host side function gets called to execute the user kernel node.
 // You need to wrap the OpenVX objects into OpenCV Mat objects and call cv::medianBlur.
+// The solution filters the mapped buffers with CMedianFilterU8 from
+// median_filter_u8.h instead of cv::medianBlur (see that header for details);
+// the borders are replicated the same way.
 //
 // TODO:********
 //   1. Get ksize value from scalar object in refs[2].
@@ -200,16 +245,144 @@ vx_status VX_CALLBACK median_blur_host_side_function( vx_node node, const vx_ref
     ERROR_CHECK_STATUS( vxMapImagePatch( input,  &rect, 0, &map_input, &addr_input,  &ptr_input,  VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X ) );
     ERROR_CHECK_STATUS( vxMapImagePatch( output, &rect, 0, &map_output, &addr_output, &ptr_output, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X ) );
 
-    cv::Mat mat_input(  height, width, CV_8U, ptr_input,  addr_input .stride_y );
-    cv::Mat mat_output( height, width, CV_8U, ptr_output, addr_output.stride_y );
-    cv::medianBlur( mat_input, mat_output, ksize );
+    vx_status status = CMedianFilterU8::Process( ( const vx_uint8 * ) ptr_input,  addr_input .stride_y,
+                                                 ( vx_uint8 * )       ptr_output, addr_output.stride_y,
+                                                 width, height, ksize );
 
     ERROR_CHECK_STATUS( vxUnmapImagePatch( input,  map_input ) );
     ERROR_CHECK_STATUS( vxUnmapImagePatch( output, map_output ) );
 
+    return status;
+}
+
+#if ENABLE_TILING_KERNEL
+////////
+// The tiling kernels validate their parameters one at a time:
+//   parameter #0  --  input image  of format VX_DF_IMAGE_U8
+//   parameter #1  --  output image of format VX_DF_IMAGE_U8 with the same dimensions as input
+vx_status VX_CALLBACK median_blur_tiling_input_validator( vx_node node, vx_uint32 index )
+{
+    vx_parameter param = vxGetParameterByIndex( node, index );
+    vx_image     image = NULL;
+    vx_df_image format = VX_DF_IMAGE_VIRT;
+    ERROR_CHECK_OBJECT( param );
+    ERROR_CHECK_STATUS( vxQueryParameter( param, VX_PARAMETER_REF, &image, sizeof( image ) ) );
+    ERROR_CHECK_STATUS( vxQueryImage( image, VX_IMAGE_FORMAT, &format, sizeof( format ) ) );
+    ERROR_CHECK_STATUS( vxReleaseImage( &image ) );
+    ERROR_CHECK_STATUS( vxReleaseParameter( &param ) );
+    return format == VX_DF_IMAGE_U8 ? VX_SUCCESS : VX_ERROR_INVALID_FORMAT;
+}
+
+vx_status VX_CALLBACK median_blur_tiling_output_validator( vx_node node, vx_uint32 index, vx_meta_format meta )
+{
+    vx_parameter param = vxGetParameterByIndex( node, 0 );
+    vx_image     input = NULL;
+    vx_uint32 width = 0, height = 0;
+    vx_df_image format = VX_DF_IMAGE_U8;
+    ERROR_CHECK_OBJECT( param );
+    ERROR_CHECK_STATUS( vxQueryParameter( param, VX_PARAMETER_REF, &input, sizeof( input ) ) );
+    ERROR_CHECK_STATUS( vxQueryImage( input, VX_IMAGE_WIDTH,  &width,  sizeof( width ) ) );
+    ERROR_CHECK_STATUS( vxQueryImage( input, VX_IMAGE_HEIGHT, &height, sizeof( height ) ) );
+    ERROR_CHECK_STATUS( vxReleaseImage( &input ) );
+    ERROR_CHECK_STATUS( vxReleaseParameter( &param ) );
+    ERROR_CHECK_STATUS( vxSetMetaFormatAttribute( meta, VX_IMAGE_FORMAT, &format, sizeof( format ) ) );
+    ERROR_CHECK_STATUS( vxSetMetaFormatAttribute( meta, VX_IMAGE_WIDTH,  &width,  sizeof( width ) ) );
+    ERROR_CHECK_STATUS( vxSetMetaFormatAttribute( meta, VX_IMAGE_HEIGHT, &height, sizeof( height ) ) );
     return VX_SUCCESS;
 }
 
+////////
+// The tiling functions compute the output tile from the input tile, whose
+// neighborhood extends KSIZE/2 pixels around it. The fast function is only
+// called on tiles whose neighborhood lies inside the image. The flexible
+// function is also called at the image borders, where it replicates the edge
+// pixels like cv::medianBlur does.
+template<int KSIZE>
+void median_blur_tiling_fast( void * VX_RESTRICT parameters[], void * VX_RESTRICT tile_memory, vx_size tile_memory_size )
+{
+    vx_tile_t * in  = ( vx_tile_t * )parameters[0];
+    vx_tile_t * out = ( vx_tile_t * )parameters[1];
+    vx_uint8 window[KSIZE * KSIZE];
+    for( vx_uint32 y = 0; y < vxTileHeight( out, 0 ); y++ )
+    {
+        for( vx_uint32 x = 0; x < vxTileWidth( out, 0 ); x++ )
+        {
+            int n = 0;
+            for( int j = -KSIZE / 2; j <= KSIZE / 2; j++ )
+            {
+                for( int i = -KSIZE / 2; i <= KSIZE / 2; i++ )
+                {
+                    window[n++] = vxImagePixel( vx_uint8, in, 0, x, y, i, j );
+                }
+            }
+            std::nth_element( window, window + n / 2, window + n );
+            vxImagePixel( vx_uint8, out, 0, x, y, 0, 0 ) = window[n / 2];
+        }
+    }
+}
+
+template<int KSIZE>
+void median_blur_tiling_flexible( void * VX_RESTRICT parameters[], void * VX_RESTRICT tile_memory, vx_size tile_memory_size )
+{
+    vx_tile_t * in  = ( vx_tile_t * )parameters[0];
+    vx_tile_t * out = ( vx_tile_t * )parameters[1];
+    vx_int32 tx = ( vx_int32 )out->tile_x, ty = ( vx_int32 )out->tile_y;
+    vx_int32 w  = ( vx_int32 )in->image.width, h = ( vx_int32 )in->image.height;
+    vx_uint8 window[KSIZE * KSIZE];
+    for( vx_uint32 y = 0; y < vxTileHeight( out, 0 ); y++ )
+    {
+        for( vx_uint32 x = 0; x < vxTileWidth( out, 0 ); x++ )
+        {
+            int n = 0;
+            for( int j = -KSIZE / 2; j <= KSIZE / 2; j++ )
+            {
+                // Offsets relative to the tile, of the nearest pixel inside the image.
+                vx_int32 oy = std::min( std::max( ty + ( vx_int32 )y + j, 0 ), h - 1 ) - ty - ( vx_int32 )y;
+                for( int i = -KSIZE / 2; i <= KSIZE / 2; i++ )
+                {
+                    vx_int32 ox = std::min( std::max( tx + ( vx_int32 )x + i, 0 ), w - 1 ) - tx - ( vx_int32 )x;
+                    window[n++] = vxImagePixel( vx_uint8, in, 0, x, y, ox, oy );
+                }
+            }
+            std::nth_element( window, window + n / 2, window + n );
+            vxImagePixel( vx_uint8, out, 0, x, y, 0, 0 ) = window[n / 2];
+        }
+    }
+}
+
+////////
+// registerTilingKernel() registers the median filter of one kernel size as a
+// tiling kernel. Its input neighborhood is derived from the kernel size, and
+// it handles the image borders itself (VX_BORDER_MODE_SELF).
+template<int KSIZE>
+vx_status registerTilingKernel( vx_context context, vx_enum kernel_enum )
+{
+    char name[VX_MAX_KERNEL_NAME];
+    sprintf( name, "app.userkernels.median_blur_%dx%d", KSIZE, KSIZE );
+    vx_kernel kernel = vxAddTilingKernel( context, name, kernel_enum,
+                                          median_blur_tiling_flexible<KSIZE>,
+                                          median_blur_tiling_fast<KSIZE>,
+                                          2,   // numParams
+                                          median_blur_tiling_input_validator,
+                                          median_blur_tiling_output_validator );
+    ERROR_CHECK_OBJECT( kernel );
+
+    vx_neighborhood_size_t neighborhood = { -KSIZE / 2, KSIZE / 2, -KSIZE / 2, KSIZE / 2 };
+    vx_tile_block_size_t   tile_block   = { 1, 1 };
+    vx_border_t            border       = { VX_BORDER_MODE_SELF };
+    ERROR_CHECK_STATUS( vxAddParameterToKernel( kernel, 0, VX_INPUT,  VX_TYPE_IMAGE, VX_PARAMETER_STATE_REQUIRED ) ); // input
+    ERROR_CHECK_STATUS( vxAddParameterToKernel( kernel, 1, VX_OUTPUT, VX_TYPE_IMAGE, VX_PARAMETER_STATE_REQUIRED ) ); // output
+    ERROR_CHECK_STATUS( vxSetKernelAttribute( kernel, VX_KERNEL_INPUT_NEIGHBORHOOD,     &neighborhood, sizeof( neighborhood ) ) );
+    ERROR_CHECK_STATUS( vxSetKernelAttribute( kernel, VX_KERNEL_OUTPUT_TILE_BLOCK_SIZE, &tile_block,   sizeof( tile_block ) ) );
+    ERROR_CHECK_STATUS( vxSetKernelAttribute( kernel, VX_KERNEL_BORDER,                 &border,       sizeof( border ) ) );
+    ERROR_CHECK_STATUS( vxFinalizeKernel( kernel ) );
+    ERROR_CHECK_STATUS( vxReleaseKernel( &kernel ) );
+
+    vxAddLogEntry( ( vx_reference ) context, VX_SUCCESS, "OK: registered tiling kernel %s\n", name );
+    return VX_SUCCESS;
+}
+#endif
+
 ////////
 // User kernels needs to be registered with every OpenVX context before use in a graph.
 //
@@ -243,6 +416,11 @@ vx_status registerUserKernel( vx_context context )
     ERROR_CHECK_STATUS( vxReleaseKernel( &kernel ) );
 
     vxAddLogEntry( ( vx_reference ) context, VX_SUCCESS, "OK: registered user kernel app.userkernels.median_blur\n" );
+#if ENABLE_TILING_KERNEL
+    ERROR_CHECK_STATUS( registerTilingKernel<3>( context, USER_KERNEL_MEDIAN_BLUR_3x3 ) );
+    ERROR_CHECK_STATUS( registerTilingKernel<5>( context, USER_KERNEL_MEDIAN_BLUR_5x5 ) );
+    ERROR_CHECK_STATUS( registerTilingKernel<7>( context, USER_KERNEL_MEDIAN_BLUR_7x7 ) );
+#endif
     return VX_SUCCESS;
 }
 
@@ -296,6 +474,10 @@ int main( int argc, char * argv[] )
     ERROR_CHECK_OBJECT( context );
     vxRegisterLogCallback( context, log_callback, vx_false_e );
 
+    ////////
+    // Collect the time taken by every node of the graph below on every frame.
+    struct node_perf_report * nodeReport = createNodePerfReport( context );
+
     ////////
     // Register user kernels with the context.
     //
@@ -305,7 +487,25 @@ int main( int argc, char * argv[] )
 
     ////////
     // Create OpenVX image object for input RGB image and median filter output image.
+#if ENABLE_BGR_INGEST
+    // With ENABLE_BGR_INGEST the input image wraps the BGR buffer captured by
+    // OpenCV, and each new frame is attached with vxSwapImageHandle (no host
+    // copy or conversion); the graph then swaps the channels of every frame.
+    vx_imagepatch_addressing_t cv_bgr_image_layout = VX_IMAGEPATCH_ADDR_INIT;
+    cv_bgr_image_layout.dim_x    = width;
+    cv_bgr_image_layout.dim_y    = height;
+    cv_bgr_image_layout.stride_x = 3;
+    cv_bgr_image_layout.stride_y = gui.GetStrideBGR();
+    cv_bgr_image_layout.scale_x  = VX_SCALE_UNITY;
+    cv_bgr_image_layout.scale_y  = VX_SCALE_UNITY;
+    cv_bgr_image_layout.step_x   = 1;
+    cv_bgr_image_layout.step_y   = 1;
+    void * cv_bgr_image_ptrs[]   = { gui.GetBufferBGR() };
+    vx_image input_rgb_image       = vxCreateImageFromHandle( context, VX_DF_IMAGE_RGB, &cv_bgr_image_layout,
+                                                              cv_bgr_image_ptrs, VX_MEMORY_TYPE_HOST );
+#else
     vx_image input_rgb_image       = vxCreateImage( context, width, height, VX_DF_IMAGE_RGB );
+#endif
     vx_image output_filtered_image = vxCreateImage( context, width, height, VX_DF_IMAGE_U8 );
     ERROR_CHECK_OBJECT( input_rgb_image );
     ERROR_CHECK_OBJECT( output_filtered_image );
@@ -325,6 +525,12 @@ int main( int argc, char * argv[] )
     vx_image luma_image = vxCreateVirtualImage( graph, width, height, VX_DF_IMAGE_U8 );
     ERROR_CHECK_OBJECT( yuv_image );
     ERROR_CHECK_OBJECT( luma_image );
+#if ENABLE_BGR_INGEST
+    vx_image rgb_image  = CChannelSwap::AddNodes( graph, input_rgb_image, width, height );
+    ERROR_CHECK_OBJECT( rgb_image );
+#else
+    vx_image rgb_image  = input_rgb_image;
+#endif
 
     ////////********
     // Now all the objects have been created for building the graph
@@ -336,9 +542,9 @@ int main( int argc, char * argv[] )
     //   1. Use userMedianBlurNode function to add "median_blur" node.
     vx_node nodes[] =
     {
-        vxColorConvertNode(   graph, input_rgb_image, yuv_image ),
-        vxChannelExtractNode( graph, yuv_image, VX_CHANNEL_Y, luma_image ),
-        userMedianBlurNode(   graph, luma_image, output_filtered_image, ksize )
+        addNodeToPerfReport( nodeReport, "Median", vxColorConvertNode(   graph, rgb_image, yuv_image ) ),
+        addNodeToPerfReport( nodeReport, "Median", vxChannelExtractNode( graph, yuv_image, VX_CHANNEL_Y, luma_image ) ),
+        addNodeToPerfReport( nodeReport, "Median", userMedianBlurNode(   graph, luma_image, output_filtered_image, ksize ) )
     };
     for( vx_size i = 0; i < sizeof( nodes ) / sizeof( nodes[0] ); i++ )
     {
@@ -347,6 +553,9 @@ int main( int argc, char * argv[] )
     }
     ERROR_CHECK_STATUS( vxReleaseImage( &yuv_image ) );
     ERROR_CHECK_STATUS( vxReleaseImage( &luma_image ) );
+#if ENABLE_BGR_INGEST
+    ERROR_CHECK_STATUS( vxReleaseImage( &rgb_image ) );
+#endif
     ERROR_CHECK_STATUS( vxVerifyGraph( graph ) );
 
     ////////
@@ -357,6 +566,11 @@ int main( int argc, char * argv[] )
         // Copy input RGB frame from OpenCV to OpenVX. In order to do this,
         // you need to use vxCopyImagePatch API.
         // See "VX/vx_api.h" for the description of these APIs.
+        // With ENABLE_BGR_INGEST, attach the captured BGR buffer instead.
+#if ENABLE_BGR_INGEST
+        cv_bgr_image_ptrs[0] = gui.GetBufferBGR();
+        ERROR_CHECK_STATUS( vxSwapImageHandle( input_rgb_image, cv_bgr_image_ptrs, NULL, 1 ) );
+#else
         vx_rectangle_t cv_rgb_image_region;
         cv_rgb_image_region.start_x    = 0;
         cv_rgb_image_region.start_y    = 0;
@@ -369,10 +583,12 @@ int main( int argc, char * argv[] )
         ERROR_CHECK_STATUS( vxCopyImagePatch( input_rgb_image, &cv_rgb_image_region, 0,
                                               &cv_rgb_image_layout, cv_rgb_image_buffer,
                                               VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST ) );
+#endif
 
         ////////
         // Now that input RGB image is ready, just run the graph.
         ERROR_CHECK_STATUS( vxProcessGraph( graph ) );
+        sampleNodePerfReport( nodeReport );
 
         ////////
         // Display the output filtered image.
@@ -410,11 +626,16 @@ int main( int argc, char * argv[] )
     printf( "GraphName NumFrames Avg(ms) Min(ms)\n"
             "Median    %9d %7.3f %7.3f\n",
             ( int )perf.num, ( float )perf.avg * 1e-6f, ( float )perf.min * 1e-6f );
+    printNodePerfReport( nodeReport );
 
     ////////********
     // To release an OpenVX object, you need to call vxRelease<Object> API which takes a pointer to the object.
     // If the release operation is successful, the OpenVX framework will reset the object to NULL.
+    releaseNodePerfReport( &nodeReport );
     ERROR_CHECK_STATUS( vxReleaseGraph( &graph ) );
+#if ENABLE_BGR_INGEST
+    ERROR_CHECK_STATUS( vxSwapImageHandle( input_rgb_image, NULL, NULL, 1 ) );
+#endif
     ERROR_CHECK_STATUS( vxReleaseImage( &input_rgb_image ) );
     ERROR_CHECK_STATUS( vxReleaseImage( &output_filtered_image ) );
     ERROR_CHECK_STATUS( vxReleaseContext( &context ) );
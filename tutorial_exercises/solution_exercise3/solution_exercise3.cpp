@@ -32,6 +32,12 @@
 ////////
 // Include OpenCV wrapper for image capture and display.
 #include "opencv_camera_display.h"
+#include "tensor_lut_int16.h"
+#include "tensor_image_convert.h"
+
+////////
+// Include the per-node performance report (include/nodePerf.h).
+#include "nodePerf.h"
 
 ////////
 // The top-level OpenVX header file is "VX/vx.h".
@@ -76,6 +82,8 @@ enum user_library_e
 enum user_kernel_e
 {
     USER_KERNEL_TENSOR_COS     = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x001,
+    USER_KERNEL_IMAGE_TO_TENSOR = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x002,
+    USER_KERNEL_TENSOR_TO_IMAGE = VX_KERNEL_BASE( VX_ID_DEFAULT, USER_LIBRARY_EXAMPLE ) + 0x003,
 };
 
 ////////
@@ -132,11 +140,11 @@ vx_status VX_CALLBACK tensor_cos_validator( vx_node node,
     // parameter #0 -- query dimensions and format
     vx_size num_of_dims;
     ERROR_CHECK_STATUS( vxQueryTensor( ( vx_tensor )parameters[0], VX_TENSOR_NUMBER_OF_DIMS, &num_of_dims, sizeof( num_of_dims ) ) );
-    if( num_of_dims > 4 ) // sanity check to avoid stack corruption with querying VX_TENSOR_DIMS below
+    if( num_of_dims > 6 ) // sanity check to avoid stack corruption with querying VX_TENSOR_DIMS below
     {
         return VX_ERROR_INVALID_DIMENSION;
     }
-    vx_size dims[4];
+    vx_size dims[6];
     ERROR_CHECK_STATUS( vxQueryTensor( ( vx_tensor )parameters[0], VX_TENSOR_DIMS, &dims, num_of_dims * sizeof(vx_size) ) );
     vx_enum data_type;
     ERROR_CHECK_STATUS( vxQueryTensor( ( vx_tensor )parameters[0], VX_TENSOR_DATA_TYPE, &data_type, sizeof( data_type ) ) );
@@ -153,13 +161,59 @@ vx_status VX_CALLBACK tensor_cos_validator( vx_node node,
 
     // parameter #1 -- set required output tensor meta data
     ERROR_CHECK_STATUS( vxSetMetaFormatAttribute( metas[1], VX_TENSOR_NUMBER_OF_DIMS,  &num_of_dims,  sizeof( num_of_dims ) ) );
-    ERROR_CHECK_STATUS( vxSetMetaFormatAttribute( metas[1], VX_TENSOR_DIMS, &dims, sizeof( dims ) ) );
+    ERROR_CHECK_STATUS( vxSetMetaFormatAttribute( metas[1], VX_TENSOR_DIMS, &dims, num_of_dims * sizeof( vx_size ) ) );
     ERROR_CHECK_STATUS( vxSetMetaFormatAttribute( metas[1], VX_TENSOR_DATA_TYPE, &data_type, sizeof( data_type ) ) );
     ERROR_CHECK_STATUS( vxSetMetaFormatAttribute( metas[1], VX_TENSOR_FIXED_POINT_POSITION, &fixed_point_pos, sizeof( fixed_point_pos ) ) );
 
     return VX_SUCCESS;
 }
 
+////////
+// The user kernel initialize callback gets called once when the graph is verified.
+// The input tensor is VX_TYPE_INT16, so cosine only ever sees 65536 different
+// values: tabulate all of them for the fixed-point positions of this node, and
+// keep the table in the node local data for tensor_cos_host_side_function.
+// The deinitialize callback frees the table.
+vx_float32 tensor_cos_function( vx_float32 value )
+{
+    return cosf( value );
+}
+
+vx_status VX_CALLBACK tensor_cos_initialize( vx_node node, const vx_reference * refs, vx_uint32 num )
+{
+    vx_uint8 input_fixed_point_pos;
+    vx_uint8 output_fixed_point_pos;
+    ERROR_CHECK_STATUS( vxQueryTensor( ( vx_tensor )refs[0], VX_TENSOR_FIXED_POINT_POSITION, &input_fixed_point_pos, sizeof( input_fixed_point_pos ) ) );
+    ERROR_CHECK_STATUS( vxQueryTensor( ( vx_tensor )refs[1], VX_TENSOR_FIXED_POINT_POSITION, &output_fixed_point_pos, sizeof( output_fixed_point_pos ) ) );
+
+    CTensorLutInt16 * lut = NULL;
+    ERROR_CHECK_STATUS( vxQueryNode( node, VX_NODE_LOCAL_DATA_PTR, &lut, sizeof( lut ) ) );
+    if( !lut )
+    {
+        lut = new CTensorLutInt16;
+        vx_size size = 0; // the table is allocated and freed by the kernel
+        ERROR_CHECK_STATUS( vxSetNodeAttribute( node, VX_NODE_LOCAL_DATA_SIZE, &size, sizeof( size ) ) );
+        ERROR_CHECK_STATUS( vxSetNodeAttribute( node, VX_NODE_LOCAL_DATA_PTR, &lut, sizeof( lut ) ) );
+    }
+    if( !lut->Matches( input_fixed_point_pos, output_fixed_point_pos ) )
+    {
+        lut->Build( input_fixed_point_pos, output_fixed_point_pos, tensor_cos_function );
+    }
+
+    return VX_SUCCESS;
+}
+
+vx_status VX_CALLBACK tensor_cos_deinitialize( vx_node node, const vx_reference * refs, vx_uint32 num )
+{
+    CTensorLutInt16 * lut = NULL;
+    ERROR_CHECK_STATUS( vxQueryNode( node, VX_NODE_LOCAL_DATA_PTR, &lut, sizeof( lut ) ) );
+    delete lut;
+    lut = NULL;
+    ERROR_CHECK_STATUS( vxSetNodeAttribute( node, VX_NODE_LOCAL_DATA_PTR, &lut, sizeof( lut ) ) );
+
+    return VX_SUCCESS;
+}
+
 ////////
 // User kernel host side function gets called to execute the user kernel node.
 // Perform element-wise consine function on input tensor to produce output tensor.
@@ -177,7 +231,7 @@ vx_status VX_CALLBACK tensor_cos_host_side_function( vx_node node, const vx_refe
     vx_tensor input   = ( vx_tensor ) refs[0];
     vx_tensor output  = ( vx_tensor ) refs[1];
     vx_size num_of_dims;
-    vx_size dims[4] = { 1, 1, 1, 1 };
+    vx_size dims[6] = { 1, 1, 1, 1, 1, 1 };
     vx_uint8 input_fixed_point_pos;
     vx_uint8 output_fixed_point_pos;
     ERROR_CHECK_STATUS( vxQueryTensor( input,  VX_TENSOR_NUMBER_OF_DIMS, &num_of_dims, sizeof( num_of_dims ) ) );
@@ -186,11 +240,11 @@ vx_status VX_CALLBACK tensor_cos_host_side_function( vx_node node, const vx_refe
     ERROR_CHECK_STATUS( vxQueryTensor( output, VX_TENSOR_FIXED_POINT_POSITION, &output_fixed_point_pos, sizeof( output_fixed_point_pos ) ) );
 
     // Access input and output tensor object data using vxMapTensorPatch API.
-    vx_size zeros[4] = { 0 };
+    vx_size zeros[6] = { 0 };
     vx_map_id map_input, map_output;
     vx_uint8 * buf_input, * buf_output;
-    vx_size stride_input[4] = { 0 };
-    vx_size stride_output[4] = { 0 };
+    vx_size stride_input[6] = { 0 };
+    vx_size stride_output[6] = { 0 };
     ERROR_CHECK_STATUS( vxMapTensorPatch( input,
                                           num_of_dims, zeros, dims,
                                           &map_input, stride_input,
@@ -198,41 +252,34 @@ vx_status VX_CALLBACK tensor_cos_host_side_function( vx_node node, const vx_refe
     ERROR_CHECK_STATUS( vxMapTensorPatch( output,
                                           num_of_dims, zeros, dims,
                                           &map_output, stride_output,
-                                          (void **)&buf_output, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0 ) );
-
-    // Perform element-wise cosine function using fixed-point position.
-    vx_float32 input_to_float_multiplier = 1.0f / (vx_float32)(1 << input_fixed_point_pos);
-    vx_float32 output_to_int16_multiplier = (vx_float32)(1 << output_fixed_point_pos);
-    for( vx_size dim3 = 0; dim3 < dims[3]; dim3++)
+                                          (void **)&buf_output, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, 0 ) );
+
+    // Perform element-wise cosine function using fixed-point position:
+    // look the elements up in the table built by tensor_cos_initialize,
+    // one 4-dimensional slice at a time for tensors with more dimensions
+    // (e.g., a batch of 4-dimensional tensors).
+    CTensorLutInt16 * lut = NULL;
+    ERROR_CHECK_STATUS( vxQueryNode( node, VX_NODE_LOCAL_DATA_PTR, &lut, sizeof( lut ) ) );
+    vx_status status = VX_FAILURE;
+    if( lut && lut->Matches( input_fixed_point_pos, output_fixed_point_pos ) )
     {
-        for( vx_size dim2 = 0; dim2 < dims[2]; dim2++)
+        for( vx_size dim5 = 0; dim5 < dims[5]; dim5++ )
         {
-            for( vx_size dim1 = 0; dim1 < dims[1]; dim1++)
+            for( vx_size dim4 = 0; dim4 < dims[4]; dim4++ )
             {
-                const vx_int16 * ibuf = (const vx_int16 *) (buf_input +
-                                                            dim3 * stride_input[3] +
-                                                            dim2 * stride_input[2] +
-                                                            dim1 * stride_input[1] );
-                vx_int16 * obuf = (vx_int16 *) (buf_output +
-                                                dim3 * stride_output[3] +
-                                                dim2 * stride_output[2] +
-                                                dim1 * stride_output[1] );
-                for( vx_size dim0 = 0; dim0 < dims[0]; dim0++)
-                {
-                    // no saturation done here
-                    vx_int16 ivalue = ibuf[dim0];
-                    vx_int16 ovalue = (vx_int16)(cosf((vx_float32)ivalue * input_to_float_multiplier) * output_to_int16_multiplier + 0.5f);
-                    obuf[dim0] = ovalue;
-                }
+                lut->Apply( buf_input  + dim5 * stride_input[5]  + dim4 * stride_input[4],  stride_input,
+                            buf_output + dim5 * stride_output[5] + dim4 * stride_output[4], stride_output,
+                            dims );
             }
         }
+        status = VX_SUCCESS;
     }
 
     // Use vxUnmapTensorPatch API to give the data buffers control back to OpenVX framework.
     ERROR_CHECK_STATUS( vxUnmapTensorPatch( input,  map_input ) );
     ERROR_CHECK_STATUS( vxUnmapTensorPatch( output, map_output ) );
 
-    return VX_SUCCESS;
+    return status;
 }
 
 ////////
@@ -257,8 +304,8 @@ vx_status registerUserKernel( vx_context context )
                                     tensor_cos_host_side_function,
                                     2,   // numParams
                                     tensor_cos_validator,
-                                    NULL,
-                                    NULL );
+                                    tensor_cos_initialize,
+                                    tensor_cos_deinitialize );
     ERROR_CHECK_OBJECT( kernel );
 
     ERROR_CHECK_STATUS( vxAddParameterToKernel( kernel, 0, VX_INPUT,  VX_TYPE_TENSOR,  VX_PARAMETER_STATE_REQUIRED ) ); // input
@@ -324,114 +371,122 @@ int main( int argc, char * argv[] )
     ERROR_CHECK_OBJECT( context );
     vxRegisterLogCallback( context, log_callback, vx_false_e );
 
+    ////////
+    // Collect the time taken by every node of the graph below on every frame.
+    struct node_perf_report * nodeReport = createNodePerfReport( context );
+
     ////////
     // Register user kernels with the context.
     //
     // TODO:********
     //   1. Register user kernel with context by calling your implementation of "registerUserKernel()".
     ERROR_CHECK_STATUS( registerUserKernel( context ) );
+    ERROR_CHECK_STATUS( CTensorImageConvert::Register( context, USER_KERNEL_IMAGE_TO_TENSOR, USER_KERNEL_TENSOR_TO_IMAGE, false ) );
 
     ////////
-    // Create OpenVX tensor objects for input and output
+    // Create OpenVX image objects for the input and output RGB frames, and
+    // virtual tensor objects for input and output of the tensor_cos node.
+    // The tensors are only accessed inside the graph: the conversions between
+    // the RGB frames and the Q-format tensors are nodes of the graph too.
     //
     // TODO:********
-    //   1. Create tensor objects using tensor_dims, tensor_input_fixed_point_pos, and
-    //      tensor_output_fixed_point_pos
-    vx_tensor input_tensor   = vxCreateTensor( context, 3, tensor_dims, VX_TYPE_INT16, tensor_input_fixed_point_pos );
-    vx_tensor output_tensor  = vxCreateTensor( context, 3, tensor_dims, VX_TYPE_INT16, tensor_output_fixed_point_pos );
+    //   1. Create RGB image objects with the frame dimensions, and virtual tensor objects
+    //      using tensor_dims, tensor_input_fixed_point_pos, and tensor_output_fixed_point_pos
+    vx_graph graph = vxCreateGraph( context );
+    ERROR_CHECK_OBJECT( graph );
+    vx_image  input_image    = vxCreateImage( context, width, height, VX_DF_IMAGE_RGB );
+    vx_image  output_image   = vxCreateImage( context, width, height, VX_DF_IMAGE_RGB );
+    vx_tensor input_tensor   = vxCreateVirtualTensor( graph, 3, tensor_dims, VX_TYPE_INT16, tensor_input_fixed_point_pos );
+    vx_tensor output_tensor  = vxCreateVirtualTensor( graph, 3, tensor_dims, VX_TYPE_INT16, tensor_output_fixed_point_pos );
+    ERROR_CHECK_OBJECT( input_image );
+    ERROR_CHECK_OBJECT( output_image );
     ERROR_CHECK_OBJECT( input_tensor );
     ERROR_CHECK_OBJECT( output_tensor );
 
     ////////
-    // Create, build, and verify the graph with user kernel node.
+    // Create, build, and verify the graph with user kernel nodes:
+    //   input_image -> image_to_tensor -> tensor_cos -> tensor_to_image -> output_image
+    // image_to_tensor converts 0..255 to Q10.5 [-4..3.96875 range] with
+    // pixel / 32 - 4, and tensor_to_image converts Q8.7 [-1..1 range] back
+    // to 0..255 with value * 128 + 128 and saturation. The output image is
+    // written in BGR order for display by OpenCV.
     //
     // TODO:********
-    //   1. Build a graph with just one node created using userTensorCosNode()
-    vx_graph graph = vxCreateGraph( context );
-    ERROR_CHECK_OBJECT( graph );
-    vx_node cos_node = userTensorCosNode( graph, input_tensor, output_tensor );
-    ERROR_CHECK_OBJECT( cos_node );
-    ERROR_CHECK_STATUS( vxReleaseNode( &cos_node ) );
+    //   1. Build a graph with image_to_tensor, userTensorCosNode(), and tensor_to_image nodes
+#if ENABLE_BGR_INGEST
+    // Read the BGR frame directly, picking the channels in reverse order.
+    vx_uint32 input_channel_order = TENSOR_IMAGE_CHANNEL_ORDER_BGR;
+#else
+    vx_uint32 input_channel_order = TENSOR_IMAGE_CHANNEL_ORDER_RGB;
+#endif
+    vx_node nodes[] =
+    {
+        addNodeToPerfReport( nodeReport, "Cosine", CTensorImageConvert::ImageToTensorNode( graph, input_image, input_tensor, 1.0f / 32, -4.0f, input_channel_order ) ),
+        addNodeToPerfReport( nodeReport, "Cosine", userTensorCosNode( graph, input_tensor, output_tensor ) ),
+        addNodeToPerfReport( nodeReport, "Cosine", CTensorImageConvert::TensorToImageNode( graph, output_tensor, output_image, 128.0f, 128.0f, TENSOR_IMAGE_CHANNEL_ORDER_BGR ) ),
+    };
+    for( vx_size i = 0; i < sizeof( nodes ) / sizeof( nodes[0] ); i++ )
+    {
+        ERROR_CHECK_OBJECT( nodes[i] );
+        ERROR_CHECK_STATUS( vxReleaseNode( &nodes[i] ) );
+    }
+    ERROR_CHECK_STATUS( vxReleaseTensor( &input_tensor ) );
+    ERROR_CHECK_STATUS( vxReleaseTensor( &output_tensor ) );
     ERROR_CHECK_STATUS( vxVerifyGraph( graph ) );
 
     ////////
     // Process the video sequence frame by frame until the end of sequence or aborted.
-    cv::Mat bgrMatForOutputDisplay( height, width, CV_8UC3 );
+    vx_rectangle_t rect = { 0, 0, width, height };
     for( int frame_index = 0; !gui.AbortRequested(); frame_index++ )
     {
         ////////
-        // Copy input RGB frame from OpenCV into input_tensor with UINT8 to Q10.5 (INT16) conversion.
-        // In order to do this, vxMapTensorPatch API (see "vx_ext_amd.h").
+        // Copy input RGB frame from OpenCV into input_image. The conversion
+        // to Q10.5 (INT16) is done in the graph.
         //
-         // TODO:********
-         //   1. Use vxMapTensorPatch API for access to input tensor object for writing
-         //   2. Copy UINT8 data from OpenCV RGB image to tensor object
-         //   3. Use vxUnmapTensorPatch API to return control of buffer back to framework
-        vx_uint8 * cv_rgb_image_buffer = gui.GetBuffer();
-        vx_size rgb_stride             = gui.GetStride();
-        vx_size zeros[3]               = { 0 };
-        vx_size tensor_stride[3];
-        vx_map_id map_id;
-        vx_uint8 * buf;
-        ERROR_CHECK_STATUS( vxMapTensorPatch( input_tensor,
-                                              3, zeros, tensor_dims,
-                                              &map_id, tensor_stride,
-                                              (void **)&buf, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, 0 ) );
-        for( vx_size c = 0; c < 3; c++ )
-        {
-            for( vx_size y = 0; y < height; y++ )
-            {
-                const vx_uint8 * img = cv_rgb_image_buffer + y * rgb_stride + c;
-                vx_int16 * inp = (vx_int16 *)(buf + y * tensor_stride[1] + c * tensor_stride[2]);
-                for( vx_size x = 0; x < width; x++ )
-                {
-                    // convert 0..255 to Q10.5 [-4..3.96875 range] fixed-point format
-                    inp[x] = (vx_int16)img[x * 3] - 128;
-                }
-            }
-        }
-        ERROR_CHECK_STATUS( vxUnmapTensorPatch( input_tensor, map_id ) );
-
+        // TODO:********
+        //   1. Use vxCopyImagePatch API to copy the OpenCV frame into the input image
+        vx_imagepatch_addressing_t addr = VX_IMAGEPATCH_ADDR_INIT;
+        addr.dim_x    = width;
+        addr.dim_y    = height;
+        addr.stride_x = 3;
+        addr.scale_x  = VX_SCALE_UNITY;
+        addr.scale_y  = VX_SCALE_UNITY;
+        addr.step_x   = 1;
+        addr.step_y   = 1;
+#if ENABLE_BGR_INGEST
+        addr.stride_y = gui.GetStrideBGR();
+        void * ptr    = gui.GetBufferBGR();
+#else
+        addr.stride_y = gui.GetStride();
+        void * ptr    = gui.GetBuffer();
+#endif
+        ERROR_CHECK_STATUS( vxCopyImagePatch( input_image, &rect, 0, &addr, ptr, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST ) );
 
         ////////
-        // Now that input tensor is ready, just run the graph.
+        // Now that input image is ready, just run the graph.
         //
         // TODO:********
-        //   1. Call vxProcessGraph to execute the tensor_cos kernel in graph
+        //   1. Call vxProcessGraph to execute the nodes in graph
         ERROR_CHECK_STATUS( vxProcessGraph( graph ) );
+        sampleNodePerfReport( nodeReport );
 
         ////////
-        // Display the output tensor object as RGB image
+        // Display the output image, which is already in BGR order
         //
         // TODO:********
-        //   1. Use vxMapTensorPatch API for access to output tensor object for reading
-        //   2. Copy tensor object data into OpenCV RGB image
-        //   3. Use vxUnmapTensorPatch API to return control of buffer back to framework
-        ERROR_CHECK_STATUS( vxMapTensorPatch( output_tensor,
-                                              3, zeros, tensor_dims,
-                                              &map_id, tensor_stride,
-                                              (void **)&buf, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST, 0 ) );
-        vx_uint8 * cv_bgr_image_buffer = bgrMatForOutputDisplay.data;
-        vx_size bgr_stride             = bgrMatForOutputDisplay.step;
-        for( vx_size c = 0; c < 3; c++ )
-        {
-            for( vx_size y = 0; y < height; y++ )
-            {
-                const vx_int16 * out = (const vx_int16 *)(buf + y * tensor_stride[1] + c * tensor_stride[2]);
-                vx_uint8 * img = cv_bgr_image_buffer + y * bgr_stride + (2 - c); // (2 - c) for RGB to BGR conversion
-                for( vx_size x = 0; x < width; x++ )
-                {
-                    // scale convert Q8.7 [-1..1 range] fixed-point format to 0..255 with saturation
-                    vx_int16 value = out[x] + 128;
-                    value = value > 255 ? 255 : value; // saturation needed
-                    img[x * 3] = (vx_uint8)value;
-                }
-            }
-        }
+        //   1. Use vxMapImagePatch API for access to output image object for reading
+        //   2. Wrap the buffer as an OpenCV image for display
+        //   3. Use vxUnmapImagePatch API to return control of buffer back to framework
+        vx_map_id map_id;
+        vx_imagepatch_addressing_t output_addr;
+        void * output_ptr;
+        ERROR_CHECK_STATUS( vxMapImagePatch( output_image, &rect, 0, &map_id, &output_addr, &output_ptr,
+                                             VX_READ_ONLY, VX_MEMORY_TYPE_HOST, VX_NOGAP_X ) );
 #if ENABLE_DISPLAY
+        cv::Mat bgrMatForOutputDisplay( height, width, CV_8UC3, output_ptr, output_addr.stride_y );
         cv::imshow( "Cosine", bgrMatForOutputDisplay );
 #endif
-        ERROR_CHECK_STATUS( vxUnmapTensorPatch( output_tensor, map_id ) );
+        ERROR_CHECK_STATUS( vxUnmapImagePatch( output_image, map_id ) );
 
         ////////
         // Display the results and grab the next input RGB frame for the next iteration.
@@ -447,15 +502,20 @@ int main( int argc, char * argv[] )
         }
     }
 
+    ////////
+    // Print the time taken by each node.
+    printNodePerfReport( nodeReport );
+
     ////////
     // To release an OpenVX object, you need to call vxRelease<Object> API which takes a pointer to the object.
     // If the release operation is successful, the OpenVX framework will reset the object to NULL.
     //
     // TODO:****
-    //   1. Release graph and tensor objects
+    //   1. Release graph and image objects
     ERROR_CHECK_STATUS( vxReleaseGraph( &graph ) );
-    ERROR_CHECK_STATUS( vxReleaseTensor( &input_tensor ) );
-    ERROR_CHECK_STATUS( vxReleaseTensor( &output_tensor ) );
+    ERROR_CHECK_STATUS( vxReleaseImage( &input_image ) );
+    ERROR_CHECK_STATUS( vxReleaseImage( &output_image ) );
+    releaseNodePerfReport( &nodeReport );
     ERROR_CHECK_STATUS( vxReleaseContext( &context ) );
 
     return 0;